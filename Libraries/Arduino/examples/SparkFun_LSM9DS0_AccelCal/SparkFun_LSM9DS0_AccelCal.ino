@@ -0,0 +1,101 @@
+/*****************************************************************
+LSM9DS0_AccelCal.ino
+SFE_LSM9DS0 Library Example Code: Multi-Pose Accelerometer Calibration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch demos the LSM9DS0AccelCal class. Instead of assuming
+the board is lying flat, like calLSM9DS0() does, it asks you to
+hold the board still in several different orientations, then
+solves for the offset and scale of each axis.
+
+The result is saved to EEPROM. On the next boot it's loaded with
+setAccelCal() and the calibration phase is skipped entirely. Send
+'c' over serial at any time to recalibrate.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_Simple
+example (I2C, default addresses).
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <EEPROM.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AccelCal.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+#define CAL_EEPROM_ADDR 0 // Where the calibration blob lives in EEPROM
+#define CAL_POSES 6       // Each axis up and down is a good minimum
+
+void calibrate()
+{
+  LSM9DS0AccelCal fit;
+  LSM9DS0_accel_cal cal;
+  float a[3];
+
+  for (int pose = 0; pose < CAL_POSES; pose++)
+  {
+    Serial.print("Hold the board still in a new orientation (");
+    Serial.print(pose + 1);
+    Serial.println("), then send any character.");
+    while (!Serial.available())
+      ;
+    while (Serial.available())
+      Serial.read();
+    dof.readAccelAverage(a);
+    fit.addSample(a[0], a[1], a[2]);
+  }
+
+  if (fit.solve(cal))
+  {
+    dof.setAccelCal(cal);
+    EEPROM.put(CAL_EEPROM_ADDR, cal);
+    Serial.println("Calibration saved.");
+  }
+  else
+  {
+    Serial.println("Poses were too similar, try again.");
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  uint16_t status = dof.begin();
+  Serial.print("LSM9DS0 WHO_AM_I's returned: 0x");
+  Serial.println(status, HEX);
+
+  // Load the saved calibration. setAccelCal() checks the blob's
+  // checksum, so an empty or corrupt EEPROM just means calibrating.
+  LSM9DS0_accel_cal cal;
+  EEPROM.get(CAL_EEPROM_ADDR, cal);
+  if (dof.setAccelCal(cal))
+    Serial.println("Loaded calibration from EEPROM.");
+  else
+    calibrate();
+}
+
+void loop()
+{
+  float a[3];
+
+  if (Serial.available() && Serial.read() == 'c')
+    calibrate();
+
+  dof.readAccel();
+  dof.calcAccelCal(a); // Offset, scale, and cross-axis corrected g's
+  Serial.print("A: ");
+  Serial.print(a[0], 3);
+  Serial.print(", ");
+  Serial.print(a[1], 3);
+  Serial.print(", ");
+  Serial.print(a[2], 3);
+  Serial.print("  |a| = ");
+  Serial.println(sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]), 3);
+  delay(500);
+}
@@ -0,0 +1,123 @@
+/*****************************************************************
+LSM9DS0_Heading.ino
+SFE_LSM9DS0 Library Example Code: Fast Tilt-Compensated Heading
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The AHRS example's printHeading() only works with the board
+flat, and it and printOrientation() spend thousands of cycles
+in atan2(), sqrt(), and friends. LSM9DS0Heading works out a
+tilt-compensated heading, pitch, and roll from one accel and
+one mag reading, with table or polynomial approximations.
+
+At startup, this sketch times each way of doing it on the
+current readings, and prints the cycles per call:
+
+  libm   atan2() and sqrt() from the C library, on floats
+  float  LSM9DS0Heading::attitude(), on floats
+  fixed  LSM9DS0Heading::attitude(), on raw readings, with no
+         floats at all (in hundredths of a degree)
+
+Then it prints the fixed-point heading, pitch, and roll twice a
+second. Tilt the board: the heading should hold still.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_Simple
+example (I2C, default addresses).
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_Heading.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+#define BENCH_CALLS 100
+#define PRINT_MS    500
+
+// Keeps the timed calls from being optimized away.
+volatile float sinkF;
+volatile uint16_t sinkI;
+
+// libmAttitude() -- The same result as LSM9DS0Heading::attitude(),
+// the straightforward way.
+void libmAttitude(float ax, float ay, float az,
+                  float mx, float my, float mz, LSM9DS0_attitude & out)
+{
+  float roll = atan2(ay, az);
+  float pitch = atan2(ax, sqrt(ay * ay + az * az));
+  float heading = atan2(my * cos(roll) - mz * sin(roll),
+                        mx * cos(pitch) - (my * sin(roll) + mz * cos(roll)) * sin(pitch));
+  out.heading = heading * 180 / PI;
+  if (out.heading < 0)
+    out.heading += 360;
+  out.pitch = pitch * 180 / PI;
+  out.roll = roll * 180 / PI;
+}
+
+void printCycles(const char * name, unsigned long us)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float) us * (F_CPU / 1000000L) / BENCH_CALLS, 0);
+  Serial.println(" cycles/call");
+}
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  dof.begin();
+  delay(100); // Let a first accel and mag sample arrive
+  dof.readAccel();
+  dof.readMag();
+
+  float ax = dof.calcAccel(dof.ax), ay = dof.calcAccel(dof.ay), az = dof.calcAccel(dof.az);
+  float mx = dof.calcMag(dof.mx), my = dof.calcMag(dof.my), mz = dof.calcMag(dof.mz);
+  LSM9DS0_attitude att;
+  LSM9DS0_attitude_cd attCd;
+
+  unsigned long start = micros();
+  for (int i = 0; i < BENCH_CALLS; i++)
+  {
+    libmAttitude(ax, ay, az, mx, my, mz, att);
+    sinkF = att.heading;
+  }
+  printCycles("libm ", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < BENCH_CALLS; i++)
+  {
+    LSM9DS0Heading::attitude(ax, ay, az, mx, my, mz, att);
+    sinkF = att.heading;
+  }
+  printCycles("float", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < BENCH_CALLS; i++)
+  {
+    LSM9DS0Heading::attitude(dof.ax, dof.ay, dof.az, dof.mx, dof.my, dof.mz, attCd);
+    sinkI = attCd.heading;
+  }
+  printCycles("fixed", micros() - start);
+}
+
+void loop()
+{
+  dof.readAccel();
+  dof.readMag();
+  LSM9DS0_attitude_cd att;
+  if (LSM9DS0Heading::attitude(dof.ax, dof.ay, dof.az, dof.mx, dof.my, dof.mz, att))
+  {
+    Serial.print("Heading, Pitch, Roll: ");
+    Serial.print(att.heading / 100.0, 2);
+    Serial.print(", ");
+    Serial.print(att.pitch / 100.0, 2);
+    Serial.print(", ");
+    Serial.println(att.roll / 100.0, 2);
+  }
+  delay(PRINT_MS);
+}
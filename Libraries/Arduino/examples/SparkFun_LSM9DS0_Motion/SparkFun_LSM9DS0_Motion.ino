@@ -0,0 +1,119 @@
+/*****************************************************************
+LSM9DS0_Motion.ino
+SFE_LSM9DS0 Library Example Code: Motion Classification
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch samples the accelerometer at 100 Hz through its FIFO
+and runs LSM9DS0Motion on every batch. It prints a line only when
+the board's state changes -- idle, walking, vibrating, or impact
+-- which is all a node would need to send.
+
+While the board is idle, the sketch stops reading the FIFO and
+waits for INT1XM: the accel's interrupt generator raises it when
+any axis jolts by more than 100 mg. The high-pass filter is
+routed to the generator, so gravity doesn't count, whichever way
+up the board is. Put the processor to sleep in that wait (e.g.
+with LowPower.powerDown() and attachInterrupt()) and it's only
+awake while something is happening.
+
+On waking, the sketch empties the FIFO and starts the classifier
+over, then stays awake for at least a reference window and
+LSM9DS0_MOTION_CONFIRM windows more (about 2 s at 100 Hz), so
+the motion that woke it has time to be confirmed.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_AHRS example
+(I2C, default addresses), with INT1XM on pin 3.
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_Motion.h>
+#include <SFE_LSM9DS0_Registers.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+const byte INT1XM = 3; // INT1XM: accel interrupt generator 1
+
+#define WAKE_MG 100 // Jolt that ends an idle spell
+
+// Samples a wake-up must see before the board can sleep again: one
+// window for the gravity reference, then enough to confirm a state.
+#define AWAKE_SAMPLES ((1 + LSM9DS0_MOTION_CONFIRM) * LSM9DS0_MOTION_WINDOW)
+
+LSM9DS0Motion motion;
+int16_t batch[32 * 3]; // One full FIFO of x, y, z samples
+bool sleeping = false;
+uint16_t awakeSamples = 0; // Since the last wake-up, up to AWAKE_SAMPLES
+
+const char * const stateNames[] = {"idle", "walking", "vibrating", "impact"};
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  pinMode(INT1XM, INPUT);
+
+  dof.begin(dof.G_SCALE_245DPS, dof.A_SCALE_2G, dof.M_SCALE_2GS,
+            dof.G_ODR_95_BW_125, dof.A_ODR_100, dof.M_ODR_3125);
+  dof.setAccelFIFO(dof.FIFO_STREAM);
+  motion.begin(100, dof.calcAccel(1));
+
+  // Any axis above the threshold (OR), for at least one sample.
+  using namespace LSM9DS0Reg;
+  uint8_t cfg = (IntGen1Reg::XHIE::set(1) | IntGen1Reg::YHIE::set(1) |
+                 IntGen1Reg::ZHIE::set(1)).bits;
+  dof.setAccelHPF(dof.A_HPF_NORMAL, dof.A_HPF_INT1);
+  dof.configAccelInt(cfg, motion.wakeThreshold(WAKE_MG), 1, true);
+}
+
+void loop()
+{
+  if (sleeping)
+  {
+    if (!digitalRead(INT1XM))
+      return; // Sleep here
+    dof.readAccelIntSource(); // Clear the latch
+    // The FIFO only holds what came before the sleep: empty it, and
+    // start the windows over on fresh samples.
+    dof.setAccelFIFO(dof.FIFO_STREAM);
+    motion.begin(100, dof.calcAccel(1));
+    awakeSamples = 0;
+    sleeping = false;
+    Serial.println("(awake)");
+  }
+
+  uint8_t n = dof.readAccelFIFO(batch, 32);
+  awakeSamples += n;
+  if (awakeSamples > AWAKE_SAMPLES)
+    awakeSamples = AWAKE_SAMPLES;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    if (motion.addSample(batch[3 * i], batch[3 * i + 1], batch[3 * i + 2]))
+    {
+      const LSM9DS0_motion_features & f = motion.features();
+      Serial.print(millis());
+      Serial.print(" ms: ");
+      Serial.print(stateNames[motion.state()]);
+      Serial.print(" (rms ");
+      Serial.print(f.rms);
+      Serial.print(" mg, peak ");
+      Serial.print(f.peak);
+      Serial.print(" mg, ");
+      Serial.print(f.frequency / 10.0, 1);
+      Serial.println(" Hz)");
+    }
+  }
+
+  if (motion.state() == LSM9DS0_MOTION_IDLE && awakeSamples >= AWAKE_SAMPLES)
+  {
+    // Anything latched happened before the board settled.
+    dof.readAccelIntSource();
+    sleeping = true;
+  }
+  delay(100); // The FIFO holds 320 ms at 100 Hz
+}
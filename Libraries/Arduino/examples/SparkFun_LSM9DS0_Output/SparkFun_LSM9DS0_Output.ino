@@ -0,0 +1,111 @@
+/*****************************************************************
+LSM9DS0_Output.ino
+SFE_LSM9DS0 Library Example Code: Change-Driven Output
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch runs the Madgwick filter at about 100 Hz, but only
+sends the orientation when it has turned more than half a degree
+(or once a second, as a heartbeat), as a 5-byte message. The raw
+accel goes out the same way, through a 3-channel
+LSM9DS0SampleOutput with a 20 mg deadband, usually as 4 bytes of
+changes since the last message.
+
+Each message is printed in hex, as it would go to a radio. Every
+10 seconds the sketch prints how many bytes it sent against the
+17 bytes per reading (the quaternion as floats and the accel as
+int16's, with a header) of sending everything every time.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_AHRS example
+(I2C, default addresses).
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AHRS.h>
+#include <SFE_LSM9DS0_Output.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+#define REPORT_MS 10000 // How often to print the totals
+// The accel's noise, 150 ug/sqrt(Hz) over the 773 Hz anti-alias band
+// begin() sets, is about 5 mg RMS, with peaks near 15 mg. A deadband
+// inside that sends noise, i.e. nearly every reading; 20 mg is above it.
+#define ACCEL_DEADBAND_MG 20
+#define RAW_BYTES 17    // Per reading, sending everything
+
+LSM9DS0Madgwick ahrs;
+LSM9DS0QuatOutput quatOut(0.5, 1000); // 0.5 degrees, 1 s
+LSM9DS0SampleOutput accelOut;
+uint8_t msg[LSM9DS0_OUTPUT_MAX_BYTES];
+
+uint32_t lastMicros = 0, reportMs = 0;
+uint32_t readings = 0, sentBytes = 0;
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  dof.begin(dof.G_SCALE_245DPS, dof.A_SCALE_2G, dof.M_SCALE_2GS,
+            dof.G_ODR_95_BW_125, dof.A_ODR_100, dof.M_ODR_100);
+  // x, y, z; the deadband in raw ticks; a key frame at least every 1 s
+  accelOut.begin(3, ACCEL_DEADBAND_MG / 1000.0 / dof.calcAccel(1) + 0.5, 1000);
+  lastMicros = micros();
+  reportMs = millis();
+}
+
+void send(char tag, const uint8_t * m, uint8_t n)
+{
+  Serial.print(tag);
+  for (uint8_t i = 0; i < n; i++)
+  {
+    Serial.print(' ');
+    if (m[i] < 0x10)
+      Serial.print('0');
+    Serial.print(m[i], HEX);
+  }
+  Serial.println();
+  sentBytes += n;
+}
+
+void loop()
+{
+  dof.readGyro();
+  dof.readAccel();
+  dof.readMag();
+  uint32_t now = micros();
+  float dt = (now - lastMicros) / 1000000.0f;
+  lastMicros = now;
+  ahrs.update(dof.calcAccel(dof.ax), dof.calcAccel(dof.ay), dof.calcAccel(dof.az),
+              dof.calcGyro(dof.gx) * PI / 180, dof.calcGyro(dof.gy) * PI / 180,
+              dof.calcGyro(dof.gz) * PI / 180,
+              dof.calcMag(dof.mx), dof.calcMag(dof.my), dof.calcMag(dof.mz), dt);
+  readings++;
+
+  uint32_t ms = millis();
+  uint8_t n = quatOut.update(ahrs.q, ms, msg);
+  if (n)
+    send('Q', msg, n);
+  int16_t a[3] = {dof.ax, dof.ay, dof.az};
+  n = accelOut.update(a, ms, msg);
+  if (n)
+    send('A', msg, n);
+
+  if (ms - reportMs >= REPORT_MS)
+  {
+    Serial.print("Sent ");
+    Serial.print(sentBytes);
+    Serial.print(" bytes for ");
+    Serial.print(readings);
+    Serial.print(" readings; every reading would be ");
+    Serial.print(readings * RAW_BYTES);
+    Serial.println(" bytes");
+    readings = sentBytes = 0;
+    reportMs = ms;
+  }
+  delay(10);
+}
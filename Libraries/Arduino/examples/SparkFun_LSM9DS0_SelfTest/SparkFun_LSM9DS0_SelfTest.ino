@@ -0,0 +1,62 @@
+/*****************************************************************
+LSM9DS0_SelfTest.ino
+SFE_LSM9DS0 Library Example Code: Production Self-Test
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch runs the gyro and accelerometer self-tests once per
+second and prints PASS or FAIL, along with the measured output
+change of each axis and the datasheet limits it was checked
+against. It's meant for screening boards at bring-up.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_Simple
+example (I2C, default addresses). Keep the board still while
+the test runs.
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+void printDeltas(const char * name, const float * d, float lo, float hi, uint8_t pass)
+{
+  Serial.print(name);
+  for (int i = 0; i < 3; i++)
+  {
+    Serial.print(d[i], 3);
+    Serial.print((pass & (1 << i)) ? " ok  " : " BAD ");
+  }
+  Serial.print(" limits ");
+  Serial.print(lo, 3);
+  Serial.print("..");
+  Serial.println(hi, 3);
+}
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  uint16_t status = dof.begin();
+  Serial.print("LSM9DS0 WHO_AM_I's returned: 0x");
+  Serial.println(status, HEX);
+  Serial.println("Should be 0x49D4");
+}
+
+void loop()
+{
+  LSM9DS0_self_test st;
+  bool pass = dof.selfTest(st);
+
+  Serial.print(pass ? "PASS" : "FAIL");
+  Serial.print(" (");
+  Serial.print(st.ms);
+  Serial.println(" ms)");
+  printDeltas("  G (DPS): ", st.gDelta, st.gMin, st.gMax, st.gPass);
+  printDeltas("  A (g):   ", st.aDelta, st.aMin, st.aMax, st.aPass);
+  delay(1000);
+}
@@ -0,0 +1,98 @@
+/*****************************************************************
+LSM9DS0_Strapdown.ino
+SFE_LSM9DS0 Library Example Code: Strapdown Pre-Integration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The AHRS example runs its filter once per loop(), on the latest
+gyro reading and a jittery deltat, so every gyro sample in
+between is lost. This sketch runs the gyro at 760 Hz and the
+accelerometer at 800 Hz, both in stream-mode FIFOs, and uses
+every sample:
+
+  - readFrame() drains both FIFOs in bursts.
+  - LSM9DS0Align puts the accel (and mag) samples on the gyro's
+    timeline.
+  - LSM9DS0Strapdown adds the samples up into a rotation and a
+    velocity change, with coning and sculling corrections.
+  - Every 20 ms, the Madgwick filter runs once on that increment:
+    its mean rate over exactly the time it covers, and its mean
+    acceleration, which also averages out vibration.
+
+So the filter runs at 50 Hz, whatever the sensor rates are.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_AHRS example
+(I2C, default addresses); no interrupt pins are needed. It wants
+a board with more RAM than an Uno (e.g. a Teensy 3.x): the frame,
+the aligner, and its output take a few KB on 32-bit boards.
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AHRS.h>
+#include <SFE_LSM9DS0_Align.h>
+#include <SFE_LSM9DS0_Strapdown.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+#define FUSION_INTERVAL 0.02f // Seconds between filter updates
+#define PRINT_MS        250
+
+LSM9DS0_frame frame;
+LSM9DS0Align align(20000);
+LSM9DS0_aligned aligned[LSM9DS0_FRAME_SAMPLES];
+LSM9DS0Strapdown strap;
+LSM9DS0Madgwick ahrs;
+float mx, my, mz; // Latest mag reading, in Gs
+unsigned long lastPrint = 0;
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  dof.begin(dof.G_SCALE_500DPS, dof.A_SCALE_4G, dof.M_SCALE_2GS,
+            dof.G_ODR_760_BW_100, dof.A_ODR_800, dof.M_ODR_100);
+  dof.setI2CClock(LSM9DS0_I2C_FAST);
+  dof.setGyroFIFO(dof.FIFO_STREAM);
+  dof.setAccelFIFO(dof.FIFO_STREAM);
+  dof.initFrame(frame);
+}
+
+void loop()
+{
+  dof.readFrame(frame);
+  uint8_t n = align.addFrame(frame, aligned, LSM9DS0_FRAME_SAMPLES);
+  strap.addAligned(aligned, n, frame.header);
+  if (n)
+  {
+    mx = aligned[n - 1].m[0] * frame.header.mRes;
+    my = aligned[n - 1].m[1] * frame.header.mRes;
+    mz = aligned[n - 1].m[2] * frame.header.mRes;
+  }
+
+  LSM9DS0_increment inc;
+  if (strap.elapsed() >= FUSION_INTERVAL && strap.take(inc))
+  {
+    float k = 1.0f / (inc.dt * LSM9DS0_GRAVITY);
+    ahrs.update(inc.dV[0] * k, inc.dV[1] * k, inc.dV[2] * k,
+                inc.dTheta[0] / inc.dt, inc.dTheta[1] / inc.dt,
+                inc.dTheta[2] / inc.dt, mx, my, mz, inc.dt);
+  }
+
+  if (millis() - lastPrint >= PRINT_MS)
+  {
+    lastPrint = millis();
+    float yaw, pitch, roll;
+    ahrs.getEuler(yaw, pitch, roll);
+    Serial.print("Yaw, Pitch, Roll: ");
+    Serial.print(yaw, 2);
+    Serial.print(", ");
+    Serial.print(pitch, 2);
+    Serial.print(", ");
+    Serial.println(roll, 2);
+  }
+}
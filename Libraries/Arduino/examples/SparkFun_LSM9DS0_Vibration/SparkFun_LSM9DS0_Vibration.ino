@@ -0,0 +1,87 @@
+/*****************************************************************
+LSM9DS0_Vibration.ino
+SFE_LSM9DS0 Library Example Code: Vibration Spectrum Features
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch samples the accelerometer at 1600 Hz through its FIFO
+and runs the LSM9DS0Spectrum stage on every batch. Instead of
+streaming raw samples, it prints one compact feature vector per
+window: band energies, the dominant vibration frequency and its
+amplitude, and RMS/kurtosis for each axis.
+
+The accelerometer's on-chip high-pass filter is routed to the
+FIFO, so gravity is removed before the samples are even read.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_Simple
+example (I2C, default addresses). At 1600 Hz, use a fast I2C
+clock (400 kHz) or SPI to keep up with the FIFO.
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_Spectrum.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+// Global, so its sample history is statically allocated.
+LSM9DS0Spectrum spectrum;
+int16_t batch[32 * 3]; // One full FIFO of x, y, z samples
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  dof.begin(dof.G_SCALE_245DPS, dof.A_SCALE_4G, dof.M_SCALE_2GS,
+            dof.G_ODR_95_BW_125, dof.A_ODR_1600, dof.M_ODR_3125);
+  dof.setAccelABW(dof.A_ABW_773);
+  dof.setAccelHPF(dof.A_HPF_NORMAL, dof.A_HPF_DATA); // Gravity removed on-chip
+  dof.setAccelFIFO(dof.FIFO_STREAM);
+
+  spectrum.begin(1600, dof.calcAccel(1));
+  // Example bands for a machine running at ~30 Hz: 1x, 2x, bearings, and
+  // everything above.
+  spectrum.setBand(0, 20, 40);
+  spectrum.setBand(1, 50, 70);
+  spectrum.setBand(2, 100, 400);
+  spectrum.setBand(3, 400, 800);
+}
+
+void loop()
+{
+  uint8_t n = dof.readAccelFIFO(batch, 32);
+  for (uint8_t i = 0; i < n; i++)
+  {
+    if (spectrum.addSample(batch[3 * i], batch[3 * i + 1], batch[3 * i + 2]))
+      printFeatures(spectrum.features());
+  }
+}
+
+void printFeatures(const LSM9DS0_spectrum & f)
+{
+  Serial.print("#");
+  Serial.println(f.window);
+  for (int axis = 0; axis < 3; axis++)
+  {
+    Serial.print((char) ('x' + axis));
+    Serial.print(": rms ");
+    Serial.print(f.rms[axis], 4);
+    Serial.print(" kurt ");
+    Serial.print(f.kurtosis[axis], 2);
+    Serial.print(" peak ");
+    Serial.print(f.peakHz[axis], 1);
+    Serial.print(" Hz ");
+    Serial.print(f.peakAmp[axis], 4);
+    Serial.print(" g bands");
+    for (int b = 0; b < LSM9DS0_SPECTRUM_BANDS; b++)
+    {
+      Serial.print(" ");
+      Serial.print(f.band[axis][b], 6);
+    }
+    Serial.println();
+  }
+}
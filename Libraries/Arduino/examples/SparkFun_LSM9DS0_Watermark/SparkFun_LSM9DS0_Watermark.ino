@@ -0,0 +1,97 @@
+/*****************************************************************
+LSM9DS0_Watermark.ino
+SFE_LSM9DS0 Library Example Code: Watermark-Triggered FIFO Reads
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+This sketch runs both FIFOs in stream mode and only touches the
+bus when one of them reaches its watermark: the gyro's raises
+DRDYG, the accelerometer's INT2XM. Each wakeup drains both FIFOs
+in bursts with readFrame(), which also picks up the latest mag
+sample -- so the mag runs at 12.5 Hz, slower than the wakeups.
+
+An LSM9DS0Watermark per FIFO keeps adjusting its watermark: as
+high as a 50 ms latency budget allows, so there are few wakeups,
+but low enough that the FIFO can't overrun while the sketch is
+busy elsewhere. Type a number of milliseconds into the Serial
+Monitor to make the loop that busy, and watch the watermarks
+come down; type 0 to watch them climb back.
+
+Hardware setup is the same as the SparkFun_LSM9DS0_AHRS example
+(I2C, default addresses), with DRDYG on pin 4 and INT2XM on 2.
+
+Distributed as-is; no warranty is given.
+*****************************************************************/
+
+// The SFE_LSM9DS0 requires both the SPI and Wire libraries.
+#include <SPI.h> // Included for SFE_LSM9DS0 library
+#include <Wire.h>
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_Watermark.h>
+
+#define LSM9DS0_XM  0x1D // Would be 0x1E if SDO_XM is LOW
+#define LSM9DS0_G   0x6B // Would be 0x6A if SDO_G is LOW
+LSM9DS0 dof(MODE_I2C, LSM9DS0_G, LSM9DS0_XM);
+
+const byte INT2XM = 2; // INT2XM: accel FIFO watermark
+const byte DRDYG  = 4; // DRDYG: gyro FIFO watermark
+
+#define LATENCY_BUDGET_US 50000
+LSM9DS0Watermark gWtm(190, LATENCY_BUDGET_US);
+LSM9DS0Watermark aWtm(200, LATENCY_BUDGET_US);
+
+LSM9DS0_frame frame;
+unsigned long busyMs = 0;   // Simulated work per loop
+unsigned long wakeups = 0;
+unsigned long lastPrint = 0;
+
+void setup()
+{
+  Serial.begin(115200); // Start serial at 115200 bps
+  pinMode(INT2XM, INPUT);
+  pinMode(DRDYG, INPUT);
+
+  dof.begin(dof.G_SCALE_245DPS, dof.A_SCALE_2G, dof.M_SCALE_2GS,
+            dof.G_ODR_190_BW_50, dof.A_ODR_200, dof.M_ODR_125);
+  dof.setI2CClock(LSM9DS0_I2C_FAST);
+  dof.setGyroFIFO(dof.FIFO_STREAM, gWtm.watermark());
+  dof.setAccelFIFO(dof.FIFO_STREAM, aWtm.watermark());
+  dof.setWatermarkInt(true, true);
+  dof.initFrame(frame);
+}
+
+void loop()
+{
+  if (digitalRead(DRDYG) || digitalRead(INT2XM))
+  {
+    dof.readFrame(frame);
+    wakeups++;
+    uint8_t g = gWtm.watermark(), a = aWtm.watermark();
+    // The FIFO level is what this frame took plus what it left behind.
+    if (gWtm.update(frame.header.gCount + frame.header.gLater,
+                    frame.header.flags & LSM9DS0_FRAME_G_OVERRUN) != g)
+      dof.setGyroWatermark(gWtm.watermark());
+    if (aWtm.update(frame.header.aCount + frame.header.aLater,
+                    frame.header.flags & LSM9DS0_FRAME_A_OVERRUN) != a)
+      dof.setAccelWatermark(aWtm.watermark());
+  }
+
+  if (Serial.available())
+    busyMs = Serial.parseInt();
+  delay(busyMs); // Stand-in for the rest of the application
+
+  if (millis() - lastPrint >= 1000)
+  {
+    lastPrint = millis();
+    Serial.print("wakeups/s ");
+    Serial.print(wakeups);
+    Serial.print("  gyro wtm ");
+    Serial.print(gWtm.watermark());
+    Serial.print(" late ");
+    Serial.print(gWtm.lateness(), 1);
+    Serial.print("  accel wtm ");
+    Serial.print(aWtm.watermark());
+    Serial.print(" late ");
+    Serial.println(aWtm.lateness(), 1);
+    wakeups = 0;
+  }
+}
@@ -22,8 +22,17 @@ Distributed as-is; no warranty is given.
 ******************************************************************************/
 
 #include "SFE_LSM9DS0.h"
+#include "SFE_LSM9DS0_Registers.h"
+#if LSM9DS0_USE_I2C
 #include <Wire.h> // Wire library is used for I2C
+#endif
+#if LSM9DS0_USE_SPI
 #include <SPI.h>  // SPI library is used for...SPI.
+#endif
+#include <stddef.h> // offsetof(), for checksumming profiles
+
+// Register fields by name: CtrlReg1G::ODR, CtrlReg2XM::AFS, ...
+using namespace LSM9DS0Reg;
 
 #if defined(ARDUINO) && ARDUINO >= 100
   #include "Arduino.h"
@@ -31,6 +40,27 @@ Distributed as-is; no warranty is given.
   #include "WProgram.h"
 #endif
 
+// LSM9DS0_WIRE_BUFFER is how many bytes one Wire transaction can carry:
+// the platform's buffer size, where Wire.h says, and at most 255.
+#if !LSM9DS0_USE_I2C
+  #define LSM9DS0_WIRE_BUFFER	255
+#elif defined(I2C_BUFFER_LENGTH)
+  #define LSM9DS0_WIRE_BUFFER	(I2C_BUFFER_LENGTH < 255 ? I2C_BUFFER_LENGTH : 255)
+#elif defined(BUFFER_LENGTH)
+  #define LSM9DS0_WIRE_BUFFER	(BUFFER_LENGTH < 255 ? BUFFER_LENGTH : 255)
+#else
+  #define LSM9DS0_WIRE_BUFFER	32
+#endif
+
+// The register init tables live in flash on AVR.
+#ifdef __AVR__
+  #include <avr/pgmspace.h>
+  #define LSM9DS0_TABLE(x)	pgm_read_byte(&(x))
+#else
+  #define PROGMEM
+  #define LSM9DS0_TABLE(x)	(x)
+#endif
+
 LSM9DS0::LSM9DS0(interface_mode interface, uint8_t gAddr, uint8_t xmAddr)
 {
 	// interfaceMode will keep track of whether we're using SPI or I2C:
@@ -40,6 +70,33 @@ LSM9DS0::LSM9DS0(interface_mode interface, uint8_t gAddr, uint8_t xmAddr)
 	// If we're using SPI, these variables store the chip-select pins.
 	xmAddress = xmAddr;
 	gAddress = gAddr;
+	
+#if LSM9DS0_USE_CAL
+	// No multi-pose accelerometer calibration until setAccelCal() is called.
+	aCalValid = false;
+#endif
+	resetStats();
+	
+	// Nothing is configured yet, so nothing is waiting in the FIFOs.
+#if LSM9DS0_USE_FRAME
+	memset(epoch, 0, sizeof(epoch));
+	memset(odr, 0, sizeof(odr));
+	memset(fifoEpochs, 0, sizeof(fifoEpochs));
+#endif
+	stale = 0;
+	
+	// Retry failed accesses twice, and time out I2C transactions after 5 ms.
+	busRetries = 2;
+	busTimeoutUs = 5000;
+	valid = 0;
+	
+	// Run SPI as fast as the LSM9DS0 allows. Leave I2C at Wire's default.
+#if LSM9DS0_USE_SPI
+	setSPIClock(LSM9DS0_SPI_MAX_HZ);
+#endif
+#if LSM9DS0_USE_I2C
+	i2cClock = 0;
+#endif
 }
 
 uint16_t LSM9DS0::begin(gyro_scale gScl, accel_scale aScl, mag_scale mScl, 
@@ -51,22 +108,19 @@ uint16_t LSM9DS0::begin(gyro_scale gScl, accel_scale aScl, mag_scale mScl,
 	aScale = aScl;
 	mScale = mScl;
 	
+#if LSM9DS0_USE_FLOAT
 	// Once we have the scale values, we can calculate the resolution
 	// of each sensor. That's what these functions are for. One for each sensor
 	calcgRes(); // Calculate DPS / ADC tick, stored in gRes variable
 	calcmRes(); // Calculate Gs / ADC tick, stored in mRes variable
 	calcaRes(); // Calculate g / ADC tick, stored in aRes variable
+#endif
 	
-	// Now, initialize our hardware interface.
-	if (interfaceMode == MODE_I2C)	// If we're using I2C
-		initI2C();					// Initialize I2C
-	else if (interfaceMode == MODE_SPI) 	// else, if we're using SPI
-		initSPI();							// Initialize SPI
-	
-	// To verify communication, we can read from the WHO_AM_I register of
-	// each device. Store those in a variable so we can return them.
-	uint8_t gTest = gReadByte(WHO_AM_I_G);		// Read the gyro WHO_AM_I
-	uint8_t xmTest = xmReadByte(WHO_AM_I_XM);	// Read the accel/mag WHO_AM_I
+	// Now, initialize our hardware interface. This also reads the WHO_AM_I
+	// registers, so we can return them to verify communication.
+	uint16_t whoAmI = initInterface();
+	if (whoAmI != LSM9DS0_WHO_AM_I)
+		return whoAmI; // Don't configure whatever else is at these addresses
 	
 	// Gyro initialization stuff:
 	initGyro();	// This will "turn on" the gyro. Setting up interrupts, etc.
@@ -82,169 +136,203 @@ uint16_t LSM9DS0::begin(gyro_scale gScl, accel_scale aScl, mag_scale mScl,
 	initMag(); // "Turn on" all axes of the mag. Set up interrupts, etc.
 	setMagODR(mODR); // Set the magnetometer output data rate.
 	setMagScale(mScale); // Set the magnetometer's range.
+	restartEpochs();
 	
 	// Once everything is initialized, return the WHO_AM_I registers we read:
+	return whoAmI;
+}
+
+uint16_t LSM9DS0::begin(const LSM9DS0_profile & profile)
+{
+	// Don't trust a profile from another library version, or one that was
+	// corrupted (or never written) in non-volatile memory.
+	if (profile.version != LSM9DS0_PROFILE_VERSION ||
+		profile.check != checksum(&profile, offsetof(LSM9DS0_profile, check)))
+		return 0;
+	
+	// Make sure an LSM9DS0 is answering at all. WHO_AM_I is the same on
+	// every part, so this can't tell one board from another: the biases
+	// and calibration are only as good as the profile's source.
+	uint16_t whoAmI = initInterface();
+	if (whoAmI != profile.whoAmI)
+		return 0;
+	
+	// Each register block is contiguous, so the whole configuration goes out
+	// in a handful of burst writes (plus a few single registers). The
+	// interrupt blocks are split around their read-only source registers.
+	gWriteBytes(CTRL_REG1_G, profile.gCtrl, sizeof(profile.gCtrl));
+	gWriteByte(INT1_CFG_G, profile.gIntCfg);
+	gWriteBytes(INT1_THS_XH_G, profile.gInt, sizeof(profile.gInt));
+	gWriteByte(FIFO_CTRL_REG_G, profile.gFifoCtrl);
+	xmWriteBytes(OFFSET_X_L_M, profile.xmCtrl, sizeof(profile.xmCtrl));
+	xmWriteByte(INT_CTRL_REG_M, profile.intCtrlM);
+	xmWriteBytes(INT_THS_L_M, profile.intThsM, sizeof(profile.intThsM));
+	xmWriteByte(INT_GEN_1_REG, profile.intGen1Cfg);
+	xmWriteBytes(INT_GEN_1_THS, profile.intGen1, sizeof(profile.intGen1));
+	xmWriteBytes(INT_GEN_2_THS, profile.intGen2, sizeof(profile.intGen2));
+	xmWriteBytes(CLICK_THS, profile.click, sizeof(profile.click));
+	xmWriteByte(FIFO_CTRL_REG, profile.xmFifoCtrl);
+	
+	// Recover the scales from the register images, rather than storing them
+	// twice. FS = 11 on the gyro is also 2000 DPS.
+	uint8_t fs = CtrlReg4G::FS::get(profile.gCtrl[CTRL_REG4_G - CTRL_REG1_G]);
+	gScale = (fs > G_SCALE_2000DPS) ? G_SCALE_2000DPS : (gyro_scale) fs;
+	aScale = (accel_scale) CtrlReg2XM::AFS::get(profile.xmCtrl[CTRL_REG2_XM - OFFSET_X_L_M]);
+	mScale = (mag_scale) CtrlReg6XM::MFS::get(profile.xmCtrl[CTRL_REG6_XM - OFFSET_X_L_M]);
+#if LSM9DS0_USE_FLOAT
+	calcgRes();
+	calcmRes();
+	calcaRes();
+#endif
+	restartEpochs();
+	
+#if LSM9DS0_USE_CAL
+	for (int i = 0; i < 3; i++)
+	{
+		gbias[i] = profile.gbias[i];
+		abias[i] = profile.abias[i];
+	}
+	aCalValid = false;
+	if (profile.flags & LSM9DS0_PROFILE_ACCEL_CAL)
+		setAccelCal(profile.aCal); // This also sets abias
+#endif
+	
+	return whoAmI;
+}
+
+void LSM9DS0::getProfile(LSM9DS0_profile & profile)
+{
+	memset(&profile, 0, sizeof(profile));
+	
+	gReadBytes(CTRL_REG1_G, profile.gCtrl, sizeof(profile.gCtrl));
+	profile.gIntCfg = gReadByte(INT1_CFG_G);
+	gReadBytes(INT1_THS_XH_G, profile.gInt, sizeof(profile.gInt));
+	profile.gFifoCtrl = gReadByte(FIFO_CTRL_REG_G);
+	xmReadBytes(OFFSET_X_L_M, profile.xmCtrl, sizeof(profile.xmCtrl));
+	profile.intCtrlM = xmReadByte(INT_CTRL_REG_M);
+	xmReadBytes(INT_THS_L_M, profile.intThsM, sizeof(profile.intThsM));
+	profile.intGen1Cfg = xmReadByte(INT_GEN_1_REG);
+	xmReadBytes(INT_GEN_1_THS, profile.intGen1, sizeof(profile.intGen1));
+	xmReadBytes(INT_GEN_2_THS, profile.intGen2, sizeof(profile.intGen2));
+	xmReadBytes(CLICK_THS, profile.click, sizeof(profile.click));
+	profile.xmFifoCtrl = xmReadByte(FIFO_CTRL_REG);
+	// Never restore with the reboot bits set:
+	profile.gCtrl[CTRL_REG5_G - CTRL_REG1_G] &= ~0x80;
+	profile.xmCtrl[CTRL_REG0_XM - OFFSET_X_L_M] &= ~0x80;
+	
+#if LSM9DS0_USE_CAL
+	for (int i = 0; i < 3; i++)
+	{
+		profile.gbias[i] = gbias[i];
+		profile.abias[i] = abias[i];
+	}
+	if (aCalValid)
+	{
+		profile.aCal = aCal;
+		profile.flags |= LSM9DS0_PROFILE_ACCEL_CAL;
+	}
+#endif
+	
+	profile.whoAmI = (xmReadByte(WHO_AM_I_XM) << 8) | gReadByte(WHO_AM_I_G);
+	profile.version = LSM9DS0_PROFILE_VERSION;
+	profile.check = checksum(&profile, offsetof(LSM9DS0_profile, check));
+}
+
+void LSM9DS0::setMagOffset(int16_t x, int16_t y, int16_t z)
+{
+	// OFFSET_X_L_M through OFFSET_Z_H_M are contiguous, LSB first:
+	uint8_t temp[6] = {(uint8_t) (x & 0xFF), (uint8_t) ((x >> 8) & 0xFF),
+					   (uint8_t) (y & 0xFF), (uint8_t) ((y >> 8) & 0xFF),
+					   (uint8_t) (z & 0xFF), (uint8_t) ((z >> 8) & 0xFF)};
+	xmWriteBytes(OFFSET_X_L_M, temp, 6);
+}
+
+uint16_t LSM9DS0::initInterface()
+{
+#if LSM9DS0_USE_I2C
+	if (interfaceMode == MODE_I2C)	// If we're using I2C
+		initI2C();					// Initialize I2C
+#endif
+#if LSM9DS0_USE_SPI
+	if (interfaceMode == MODE_SPI) 	// If we're using SPI
+		initSPI();					// Initialize SPI
+#endif
+	
+	// To verify communication, we can read from the WHO_AM_I register of
+	// each device.
+	uint8_t gTest = gReadByte(WHO_AM_I_G);		// Read the gyro WHO_AM_I
+	uint8_t xmTest = xmReadByte(WHO_AM_I_XM);	// Read the accel/mag WHO_AM_I
 	return (xmTest << 8) | gTest;
 }
 
+// Register images written by initGyro(), initAccel(), and initMag(), in
+// that order. They're built at compile time from the typed fields in
+// SFE_LSM9DS0_Registers.h, so a value that doesn't fit its field fails to
+// compile; begin() then sets the ODRs and scales.
+
+// Normal mode, all axes on; interrupt generator on INT_G (push-pull, active
+// high) but with every event off until configGyroInt(); data ready on
+// DRDY_G. HPF, FIFO, and self-test off.
+static constexpr LSM9DS0_reg_write gyroInit[] PROGMEM = {
+	(CtrlReg1G::PD::set(1) | CtrlReg1G::ZEN::set(1) | CtrlReg1G::XEN::set(1) |
+	 CtrlReg1G::YEN::set(1)).write(),
+	CtrlReg2G::Image().write(),
+	(CtrlReg3G::I1_INT1::set(1) | CtrlReg3G::I2_DRDY::set(1)).write(),
+	CtrlReg4G::Image().write(),
+	CtrlReg5G::Image().write(),
+	Int1CfgG::Image().write(),
+};
+
+// 50 Hz, all axes on, continuous update; 773 Hz anti-alias filter; data
+// ready on INT1_XM. FIFO and HPF off.
+static constexpr LSM9DS0_reg_write accelInit[] PROGMEM = {
+	CtrlReg0XM::Image().write(),
+	(CtrlReg1XM::AODR::set(5) | CtrlReg1XM::AZEN::set(1) |
+	 CtrlReg1XM::AYEN::set(1) | CtrlReg1XM::AXEN::set(1)).write(),
+	CtrlReg2XM::Image().write(),
+	CtrlReg3XM::P1_DRDYA::set(1).write(),
+};
+
+// Temperature sensor on (unless LSM9DS0_USE_TEMP is 0), 100 Hz, low
+// resolution, continuous conversion; mag data ready on INT2_XM; mag
+// interrupts on, active high, push-pull.
+static constexpr LSM9DS0_reg_write magInit[] PROGMEM = {
+	(CtrlReg5XM::TEMP_EN::set(LSM9DS0_USE_TEMP) | CtrlReg5XM::M_ODR::set(5)).write(),
+	CtrlReg6XM::Image().write(),
+	CtrlReg7XM::Image().write(),
+	CtrlReg4XM::P2_DRDYM::set(1).write(),
+	(IntCtrlRegM::IEA::set(1) | IntCtrlRegM::MIEN::set(1)).write(),
+};
+
+void LSM9DS0::writeRegs(const LSM9DS0_reg_write * regs, uint8_t count)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t address = LSM9DS0_TABLE(regs[i].address);
+		uint8_t value = LSM9DS0_TABLE(regs[i].value);
+		if (LSM9DS0_TABLE(regs[i].device) == LSM9DS0_DEVICE_G)
+			gWriteByte(address, value);
+		else
+			xmWriteByte(address, value);
+	}
+}
+
 void LSM9DS0::initGyro()
 {
-	/* CTRL_REG1_G sets output data rate, bandwidth, power-down and enables
-	Bits[7:0]: DR1 DR0 BW1 BW0 PD Zen Xen Yen
-	DR[1:0] - Output data rate selection
-		00=95Hz, 01=190Hz, 10=380Hz, 11=760Hz
-	BW[1:0] - Bandwidth selection (sets cutoff frequency)
-		 Value depends on ODR. See datasheet table 21.
-	PD - Power down enable (0=power down mode, 1=normal or sleep mode)
-	Zen, Xen, Yen - Axis enable (o=disabled, 1=enabled)	*/
-	gWriteByte(CTRL_REG1_G, 0x0F); // Normal mode, enable all axes
-	
-	/* CTRL_REG2_G sets up the HPF
-	Bits[7:0]: 0 0 HPM1 HPM0 HPCF3 HPCF2 HPCF1 HPCF0
-	HPM[1:0] - High pass filter mode selection
-		00=normal (reset reading HP_RESET_FILTER, 01=ref signal for filtering,
-		10=normal, 11=autoreset on interrupt
-	HPCF[3:0] - High pass filter cutoff frequency
-		Value depends on data rate. See datasheet table 26.
-	*/
-	gWriteByte(CTRL_REG2_G, 0x00); // Normal mode, high cutoff frequency
-	
-	/* CTRL_REG3_G sets up interrupt and DRDY_G pins
-	Bits[7:0]: I1_IINT1 I1_BOOT H_LACTIVE PP_OD I2_DRDY I2_WTM I2_ORUN I2_EMPTY
-	I1_INT1 - Interrupt enable on INT_G pin (0=disable, 1=enable)
-	I1_BOOT - Boot status available on INT_G (0=disable, 1=enable)
-	H_LACTIVE - Interrupt active configuration on INT_G (0:high, 1:low)
-	PP_OD - Push-pull/open-drain (0=push-pull, 1=open-drain)
-	I2_DRDY - Data ready on DRDY_G (0=disable, 1=enable)
-	I2_WTM - FIFO watermark interrupt on DRDY_G (0=disable 1=enable)
-	I2_ORUN - FIFO overrun interrupt on DRDY_G (0=disable 1=enable)
-	I2_EMPTY - FIFO empty interrupt on DRDY_G (0=disable 1=enable) */
-	// Int1 enabled (pp, active low), data read on DRDY_G:
-	gWriteByte(CTRL_REG3_G, 0x88); 
-	
-	/* CTRL_REG4_G sets the scale, update mode
-	Bits[7:0] - BDU BLE FS1 FS0 - ST1 ST0 SIM
-	BDU - Block data update (0=continuous, 1=output not updated until read
-	BLE - Big/little endian (0=data LSB @ lower address, 1=LSB @ higher add)
-	FS[1:0] - Full-scale selection
-		00=245dps, 01=500dps, 10=2000dps, 11=2000dps
-	ST[1:0] - Self-test enable
-		00=disabled, 01=st 0 (x+, y-, z-), 10=undefined, 11=st 1 (x-, y+, z+)
-	SIM - SPI serial interface mode select
-		0=4 wire, 1=3 wire */
-	gWriteByte(CTRL_REG4_G, 0x00); // Set scale to 245 dps
-	
-	/* CTRL_REG5_G sets up the FIFO, HPF, and INT1
-	Bits[7:0] - BOOT FIFO_EN - HPen INT1_Sel1 INT1_Sel0 Out_Sel1 Out_Sel0
-	BOOT - Reboot memory content (0=normal, 1=reboot)
-	FIFO_EN - FIFO enable (0=disable, 1=enable)
-	HPen - HPF enable (0=disable, 1=enable)
-	INT1_Sel[1:0] - Int 1 selection configuration
-	Out_Sel[1:0] - Out selection configuration */
-	gWriteByte(CTRL_REG5_G, 0x00);
-	
-	// Temporary !!! For testing !!! Remove !!! Or make useful !!!
-	configGyroInt(0x2A, 0, 0, 0, 0); // Trigger interrupt when above 0 DPS...
+	writeRegs(gyroInit, sizeof(gyroInit) / sizeof(gyroInit[0]));
 }
 
 void LSM9DS0::initAccel()
 {
-	/* CTRL_REG0_XM (0x1F) (Default value: 0x00)
-	Bits (7-0): BOOT FIFO_EN WTM_EN 0 0 HP_CLICK HPIS1 HPIS2
-	BOOT - Reboot memory content (0: normal, 1: reboot)
-	FIFO_EN - Fifo enable (0: disable, 1: enable)
-	WTM_EN - FIFO watermark enable (0: disable, 1: enable)
-	HP_CLICK - HPF enabled for click (0: filter bypassed, 1: enabled)
-	HPIS1 - HPF enabled for interrupt generator 1 (0: bypassed, 1: enabled)
-	HPIS2 - HPF enabled for interrupt generator 2 (0: bypassed, 1 enabled)   */
-	xmWriteByte(CTRL_REG0_XM, 0x00);
-	
-	/* CTRL_REG1_XM (0x20) (Default value: 0x07)
-	Bits (7-0): AODR3 AODR2 AODR1 AODR0 BDU AZEN AYEN AXEN
-	AODR[3:0] - select the acceleration data rate:
-		0000=power down, 0001=3.125Hz, 0010=6.25Hz, 0011=12.5Hz, 
-		0100=25Hz, 0101=50Hz, 0110=100Hz, 0111=200Hz, 1000=400Hz,
-		1001=800Hz, 1010=1600Hz, (remaining combinations undefined).
-	BDU - block data update for accel AND mag
-		0: Continuous update
-		1: Output registers aren't updated until MSB and LSB have been read.
-	AZEN, AYEN, and AXEN - Acceleration x/y/z-axis enabled.
-		0: Axis disabled, 1: Axis enabled									 */	
-	xmWriteByte(CTRL_REG1_XM, 0x57); // 100Hz data rate, x/y/z all enabled
-	
-	//Serial.println(xmReadByte(CTRL_REG1_XM));
-	/* CTRL_REG2_XM (0x21) (Default value: 0x00)
-	Bits (7-0): ABW1 ABW0 AFS2 AFS1 AFS0 AST1 AST0 SIM
-	ABW[1:0] - Accelerometer anti-alias filter bandwidth
-		00=773Hz, 01=194Hz, 10=362Hz, 11=50Hz
-	AFS[2:0] - Accel full-scale selection
-		000=+/-2g, 001=+/-4g, 010=+/-6g, 011=+/-8g, 100=+/-16g
-	AST[1:0] - Accel self-test enable
-		00=normal (no self-test), 01=positive st, 10=negative st, 11=not allowed
-	SIM - SPI mode selection
-		0=4-wire, 1=3-wire													 */
-	xmWriteByte(CTRL_REG2_XM, 0x00); // Set scale to 2g
-	
-	/* CTRL_REG3_XM is used to set interrupt generators on INT1_XM
-	Bits (7-0): P1_BOOT P1_TAP P1_INT1 P1_INT2 P1_INTM P1_DRDYA P1_DRDYM P1_EMPTY
-	*/
-	// Accelerometer data ready on INT1_XM (0x04)
-	xmWriteByte(CTRL_REG3_XM, 0x04); 
+	writeRegs(accelInit, sizeof(accelInit) / sizeof(accelInit[0]));
 }
 
 void LSM9DS0::initMag()
-{	
-	/* CTRL_REG5_XM enables temp sensor, sets mag resolution and data rate
-	Bits (7-0): TEMP_EN M_RES1 M_RES0 M_ODR2 M_ODR1 M_ODR0 LIR2 LIR1
-	TEMP_EN - Enable temperature sensor (0=disabled, 1=enabled)
-	M_RES[1:0] - Magnetometer resolution select (0=low, 3=high)
-	M_ODR[2:0] - Magnetometer data rate select
-		000=3.125Hz, 001=6.25Hz, 010=12.5Hz, 011=25Hz, 100=50Hz, 101=100Hz
-	LIR2 - Latch interrupt request on INT2_SRC (cleared by reading INT2_SRC)
-		0=interrupt request not latched, 1=interrupt request latched
-	LIR1 - Latch interrupt request on INT1_SRC (cleared by readging INT1_SRC)
-		0=irq not latched, 1=irq latched 									 */
-	xmWriteByte(CTRL_REG5_XM, 0x94); // Mag data rate - 100 Hz, enable temperature sensor
-	
-	/* CTRL_REG6_XM sets the magnetometer full-scale
-	Bits (7-0): 0 MFS1 MFS0 0 0 0 0 0
-	MFS[1:0] - Magnetic full-scale selection
-	00:+/-2Gauss, 01:+/-4Gs, 10:+/-8Gs, 11:+/-12Gs							 */
-	xmWriteByte(CTRL_REG6_XM, 0x00); // Mag scale to +/- 2GS
-	
-	/* CTRL_REG7_XM sets magnetic sensor mode, low power mode, and filters
-	AHPM1 AHPM0 AFDS 0 0 MLP MD1 MD0
-	AHPM[1:0] - HPF mode selection
-		00=normal (resets reference registers), 01=reference signal for filtering, 
-		10=normal, 11=autoreset on interrupt event
-	AFDS - Filtered acceleration data selection
-		0=internal filter bypassed, 1=data from internal filter sent to FIFO
-	MLP - Magnetic data low-power mode
-		0=data rate is set by M_ODR bits in CTRL_REG5
-		1=data rate is set to 3.125Hz
-	MD[1:0] - Magnetic sensor mode selection (default 10)
-		00=continuous-conversion, 01=single-conversion, 10 and 11=power-down */
-	xmWriteByte(CTRL_REG7_XM, 0x00); // Continuous conversion mode
-	
-	/* CTRL_REG4_XM is used to set interrupt generators on INT2_XM
-	Bits (7-0): P2_TAP P2_INT1 P2_INT2 P2_INTM P2_DRDYA P2_DRDYM P2_Overrun P2_WTM
-	*/
-	xmWriteByte(CTRL_REG4_XM, 0x04); // Magnetometer data ready on INT2_XM (0x08)
-	
-	/* INT_CTRL_REG_M to set push-pull/open drain, and active-low/high
-	Bits[7:0] - XMIEN YMIEN ZMIEN PP_OD IEA IEL 4D MIEN
-	XMIEN, YMIEN, ZMIEN - Enable interrupt recognition on axis for mag data
-	PP_OD - Push-pull/open-drain interrupt configuration (0=push-pull, 1=od)
-	IEA - Interrupt polarity for accel and magneto
-		0=active-low, 1=active-high
-	IEL - Latch interrupt request for accel and magneto
-		0=irq not latched, 1=irq latched
-	4D - 4D enable. 4D detection is enabled when 6D bit in INT_GEN1_REG is set
-	MIEN - Enable interrupt generation for magnetic data
-		0=disable, 1=enable) */
-	xmWriteByte(INT_CTRL_REG_M, 0x09); // Enable interrupts for mag, active-low, push-pull
+{
+	writeRegs(magInit, sizeof(magInit) / sizeof(magInit[0]));
 }
 
+#if LSM9DS0_USE_CAL
 // This is a function that uses the FIFO to accumulate sample of accelerometer and gyro data, average
 // them, scales them to  gs and deg/s, respectively, and then passes the biases to the main sketch
 // for subtraction from all subsequent data. There are no gyro and accelerometer bias registers to store
@@ -268,15 +356,20 @@ void LSM9DS0::calLSM9DS0(float * gbias, float * abias)
   samples = (gReadByte(FIFO_SRC_REG_G) & 0x1F); // Read number of stored samples
 
   for(ii = 0; ii < samples ; ii++) {            // Read the gyro data stored in the FIFO
-    gReadBytes(OUT_X_L_G,  &data[0], 6);
+    if (gReadBytes(OUT_X_L_G,  &data[0], 6) != BUS_OK) {
+      samples = ii;                             // Average what arrived intact
+      break;
+    }
     gyro_bias[0] += (((int16_t)data[1] << 8) | data[0]);
     gyro_bias[1] += (((int16_t)data[3] << 8) | data[2]);
     gyro_bias[2] += (((int16_t)data[5] << 8) | data[4]);
   }  
 
-  gyro_bias[0] /= samples; // average the data
-  gyro_bias[1] /= samples; 
-  gyro_bias[2] /= samples; 
+  if (samples) {
+    gyro_bias[0] /= samples; // average the data
+    gyro_bias[1] /= samples; 
+    gyro_bias[2] /= samples; 
+  }
   
   gbias[0] = (float)gyro_bias[0]*gRes;  // Properly scale the data to get deg/s
   gbias[1] = (float)gyro_bias[1]*gRes;
@@ -298,15 +391,20 @@ void LSM9DS0::calLSM9DS0(float * gbias, float * abias)
   samples = (xmReadByte(FIFO_SRC_REG) & 0x1F); // Read number of stored accelerometer samples
 
    for(ii = 0; ii < samples ; ii++) {          // Read the accelerometer data stored in the FIFO
-    xmReadBytes(OUT_X_L_A, &data[0], 6);
+    if (xmReadBytes(OUT_X_L_A, &data[0], 6) != BUS_OK) {
+      samples = ii;                             // Average what arrived intact
+      break;
+    }
     accel_bias[0] += (((int16_t)data[1] << 8) | data[0]);
     accel_bias[1] += (((int16_t)data[3] << 8) | data[2]);
     accel_bias[2] += (((int16_t)data[5] << 8) | data[4]) - (int16_t)(1./aRes); // Assumes sensor facing up!
   }  
 
-  accel_bias[0] /= samples; // average the data
-  accel_bias[1] /= samples; 
-  accel_bias[2] /= samples; 
+  if (samples) {
+    accel_bias[0] /= samples; // average the data
+    accel_bias[1] /= samples; 
+    accel_bias[2] /= samples; 
+  }
   
   abias[0] = (float)accel_bias[0]*aRes; // Properly scale data to get gs
   abias[1] = (float)accel_bias[1]*aRes;
@@ -316,42 +414,830 @@ void LSM9DS0::calLSM9DS0(float * gbias, float * abias)
   xmWriteByte(CTRL_REG0_XM, c & ~0x40);    // Disable accelerometer FIFO  
   delay(20);
   xmWriteByte(FIFO_CTRL_REG, 0x00);       // Enable accelerometer bypass mode
+  restartEpochs();                        // Both FIFOs were emptied
+}
+
+uint8_t LSM9DS0::readAccelAverage(float * a)
+{
+	uint8_t data[6]; // We'll read each FIFO sample into data
+	int32_t sum[3] = {0, 0, 0}; // 32 samples won't overflow a 32-bit sum
+	uint8_t src = 0, samples, ii;
+	
+	uint8_t c = xmReadByte(CTRL_REG0_XM);
+	xmWriteByte(CTRL_REG0_XM, c | 0x40); // Enable accelerometer FIFO
+	xmWriteByte(FIFO_CTRL_REG, 0x00);    // Bypass mode empties the FIFO
+	xmWriteByte(FIFO_CTRL_REG, 0x20 | 0x1F); // FIFO mode, stops when full
+	
+	// Poll until the FIFO fills (OVRN bit), rather than sleeping for a fixed
+	// time. Give up after a second, so slow ODRs still return something.
+	unsigned long start = millis();
+	while (millis() - start < 1000)
+	{
+		src = xmReadByte(FIFO_SRC_REG);
+		if (src & 0x40) // FIFO is full
+			break;
+		delay(5);
+	}
+	samples = src & 0x1F; // Read number of stored samples
+	
+	for (ii = 0; ii < samples; ii++) // Read the samples stored in the FIFO
+	{
+		if (xmReadBytes(OUT_X_L_A, data, 6) != BUS_OK)
+		{
+			samples = ii; // Average what arrived intact
+			break;
+		}
+		sum[0] += (int16_t) (((int16_t)data[1] << 8) | data[0]);
+		sum[1] += (int16_t) (((int16_t)data[3] << 8) | data[2]);
+		sum[2] += (int16_t) (((int16_t)data[5] << 8) | data[4]);
+	}
+	
+	xmWriteByte(CTRL_REG0_XM, c);     // Restore the FIFO enable bit
+	xmWriteByte(FIFO_CTRL_REG, 0x00); // Back to bypass mode
+	
+	if (samples == 0)
+		return 0;
+	for (ii = 0; ii < 3; ii++) // average the data and scale it to g's
+		a[ii] = ((float) sum[ii] / samples) * aRes;
+	return samples;
 }
 
-void LSM9DS0::readAccel()
+bool LSM9DS0::setAccelCal(const LSM9DS0_accel_cal & cal)
+{
+	// Reject blobs from another library version, or ones that were
+	// corrupted (or never written) in non-volatile memory.
+	if (cal.version != LSM9DS0_ACCEL_CAL_VERSION ||
+		cal.check != checksum(&cal, sizeof(cal) - sizeof(cal.check)))
+		return false;
+	
+	aCal = cal;
+	aCalValid = true;
+	for (int i = 0; i < 3; i++) // Keep abias consistent with the offsets
+		abias[i] = cal.offset[i];
+	return true;
+}
+
+void LSM9DS0::calcAccelCal(float * a)
+{
+	float dx = calcAccel(ax) - abias[0];
+	float dy = calcAccel(ay) - abias[1];
+	float dz = calcAccel(az) - abias[2];
+	
+	if (!aCalValid)
+	{
+		a[0] = dx;
+		a[1] = dy;
+		a[2] = dz;
+		return;
+	}
+	// M is upper-triangular, so this is six multiplies instead of nine:
+	a[0] = aCal.scale[0] * dx + aCal.cross[0] * dy + aCal.cross[1] * dz;
+	a[1] = aCal.scale[1] * dy + aCal.cross[2] * dz;
+	a[2] = aCal.scale[2] * dz;
+}
+
+#endif
+
+// FIFO reads are split into bursts of this many samples, each read into a
+// buffer on the stack; I2CreadBytes() splits them further to fit Wire. Only
+// the AVRs are short enough of RAM to need small bursts.
+#ifdef __AVR__
+#define FIFO_BURST_SAMPLES	5
+#else
+#define FIFO_BURST_SAMPLES	32
+#endif
+
+#if LSM9DS0_USE_CAL
+// Samples averaged for each half of the self-test, and samples thrown away
+// first after the ODR or actuation changes: the datasheet procedure waits
+// for new data and discards the first, and the output filters take a few
+// more to settle (8 is ~10 ms at 760 Hz, ~5 ms at 1600 Hz).
+#define SELF_TEST_SAMPLES	16
+#define SELF_TEST_DISCARD	8
+
+uint8_t LSM9DS0::readFIFOSum(bool gyro, uint8_t samples, int32_t * sum)
+{
+	int16_t data[3 * FIFO_BURST_SAMPLES];
+	uint8_t read = 0;
+	while (read < samples)
+	{
+		uint8_t n = samples - read;
+		if (n > FIFO_BURST_SAMPLES)
+			n = FIFO_BURST_SAMPLES;
+		uint8_t got = readFIFO(gyro, data, n);
+		for (uint8_t i = 0; i < 3 * got; i += 3)
+		{
+			sum[0] += data[i];
+			sum[1] += data[i + 1];
+			sum[2] += data[i + 2];
+		}
+		read += got;
+		if (got < n)
+			break;
+	}
+	return read;
+}
+
+bool LSM9DS0::discardSamples(bool gyro, uint8_t samples)
+{
+	uint8_t data[6];
+	for (uint8_t i = 0; i < samples; i++)
+	{
+		// STATUS_REG_G/A: ZYXOR ZOR YOR XOR ZYXDA ZDA YDA XDA
+		unsigned long start = millis();
+		while (!((gyro ? gReadByte(STATUS_REG_G) : xmReadByte(STATUS_REG_A)) & 0x08))
+			if (millis() - start > 100)
+				return false;
+		// Reading the output clears ZYXDA until the next sample.
+		if (gyro)
+			gReadBytes(OUT_X_L_G, data, 6);
+		else
+			xmReadBytes(OUT_X_L_A, data, 6);
+	}
+	return true;
+}
+
+bool LSM9DS0::averageFIFO(bool gyro, uint8_t samples, float * avg)
+{
+	uint8_t fifoCtrl = gyro ? FIFO_CTRL_REG_G : FIFO_CTRL_REG;
+	uint8_t fifoSrc = gyro ? FIFO_SRC_REG_G : FIFO_SRC_REG;
+	int32_t sum[3] = {0, 0, 0};
+	
+	// Going through bypass mode empties the FIFO, then FIFO mode collects
+	// samples until it's full.
+	if (gyro)
+	{
+		gWriteByte(fifoCtrl, 0x00);
+		gWriteByte(fifoCtrl, 0x20 | 0x1F);
+	}
+	else
+	{
+		xmWriteByte(fifoCtrl, 0x00);
+		xmWriteByte(fifoCtrl, 0x20 | 0x1F);
+	}
+	
+	// At the slowest rate selfTest() uses, 31 samples take ~40 ms.
+	unsigned long start = millis();
+	uint8_t src;
+	do
+	{
+		if (millis() - start > 100)
+			return false;
+		src = gyro ? gReadByte(fifoSrc) : xmReadByte(fifoSrc);
+	} while ((src & 0x1F) < samples && !(src & 0x40));
+	
+	if (readFIFOSum(gyro, samples, sum) < samples)
+		return false;
+	for (int i = 0; i < 3; i++)
+		avg[i] = (float) sum[i] / samples;
+	return true;
+}
+
+bool LSM9DS0::selfTest(LSM9DS0_self_test & result)
+{
+	// Datasheet self-test limits. The gyro's depend on full-scale; the
+	// accel's are only specified at +/-2g, so that's what it's tested at.
+	static const float gLimits[3][2] = {{20, 250}, {70, 400}, {150, 1000}};
+	uint8_t gCtrl[5], xmCtrl[3], gFifo, xmFifo;
+	float off[3], on[3];
+	bool ok = true;
+	unsigned long start = millis();
+	
+	memset(&result, 0, sizeof(result));
+	result.gMin = gLimits[gScale][0];
+	result.gMax = gLimits[gScale][1];
+	result.aMin = 0.060;
+	result.aMax = 1.700;
+	
+	// Save everything we're about to change.
+	gReadBytes(CTRL_REG1_G, gCtrl, 5);
+	xmReadBytes(CTRL_REG0_XM, xmCtrl, 3);
+	gFifo = gReadByte(FIFO_CTRL_REG_G);
+	xmFifo = xmReadByte(FIFO_CTRL_REG);
+	
+	// Gyro: 760 Hz ODR, all axes on, current scale, FIFO enabled.
+	gWriteByte(CTRL_REG1_G, 0xFF);
+	gWriteByte(CTRL_REG4_G, gCtrl[3] & 0x30);
+	gWriteByte(CTRL_REG5_G, 0x40);
+	ok &= discardSamples(true, SELF_TEST_DISCARD);
+	ok &= averageFIFO(true, SELF_TEST_SAMPLES, off);
+	gWriteByte(CTRL_REG4_G, (gCtrl[3] & 0x30) | 0x02); // ST = 01
+	ok &= discardSamples(true, SELF_TEST_DISCARD);
+	ok &= averageFIFO(true, SELF_TEST_SAMPLES, on);
+	for (int i = 0; i < 3; i++)
+	{
+		result.gDelta[i] = (on[i] - off[i]) * gRes;
+		float d = fabs(result.gDelta[i]);
+		if (d >= result.gMin && d <= result.gMax)
+			result.gPass |= 1 << i;
+	}
+	
+	// Accel: 1600 Hz ODR, all axes on, +/-2g, FIFO enabled.
+	xmWriteByte(CTRL_REG1_XM, 0xA7);
+	xmWriteByte(CTRL_REG2_XM, 0x00);
+	xmWriteByte(CTRL_REG0_XM, 0x40);
+	ok &= discardSamples(false, SELF_TEST_DISCARD);
+	ok &= averageFIFO(false, SELF_TEST_SAMPLES, off);
+	xmWriteByte(CTRL_REG2_XM, 0x02); // AST = 01, positive self-test
+	ok &= discardSamples(false, SELF_TEST_DISCARD);
+	ok &= averageFIFO(false, SELF_TEST_SAMPLES, on);
+	for (int i = 0; i < 3; i++)
+	{
+		result.aDelta[i] = (on[i] - off[i]) * (2.0 / 32768.0);
+		float d = fabs(result.aDelta[i]);
+		if (d >= result.aMin && d <= result.aMax)
+			result.aPass |= 1 << i;
+	}
+	
+	// Put everything back the way we found it.
+	gWriteBytes(CTRL_REG1_G, gCtrl, 5);
+	gWriteByte(FIFO_CTRL_REG_G, gFifo);
+	xmWriteBytes(CTRL_REG0_XM, xmCtrl, 3);
+	xmWriteByte(FIFO_CTRL_REG, xmFifo);
+	restartEpochs(); // The FIFOs only hold self-test samples
+	
+	result.ms = millis() - start;
+	return ok && result.gPass == LSM9DS0_ST_ALL_AXES &&
+		   result.aPass == LSM9DS0_ST_ALL_AXES;
+}
+
+#endif
+
+bool LSM9DS0::setGyroFIFO(fifo_mode mode, uint8_t watermark)
+{
+	uint8_t temp;
+	if (gReadBytes(CTRL_REG5_G, &temp, 1) != BUS_OK)
+		return false;
+	bool ok = gWriteByte(CTRL_REG5_G,
+						 CtrlReg5G::FIFO_EN::replace(temp, mode != FIFO_BYPASS)) == BUS_OK;
+	ok &= gWriteByte(FIFO_CTRL_REG_G, 0x00) == BUS_OK; // Bypass empties the FIFO
+#if LSM9DS0_USE_FRAME
+	fifoEpochs[0].runs = 0;
+#endif
+	if (mode != FIFO_BYPASS)
+		ok &= gWriteByte(FIFO_CTRL_REG_G, FifoCtrlRegG::FM::bits(mode) |
+						 FifoCtrlRegG::WTM::bits(watermark)) == BUS_OK;
+	return ok;
+}
+
+bool LSM9DS0::setAccelFIFO(fifo_mode mode, uint8_t watermark)
+{
+	uint8_t temp;
+	if (xmReadBytes(CTRL_REG0_XM, &temp, 1) != BUS_OK)
+		return false;
+	bool ok = xmWriteByte(CTRL_REG0_XM,
+						  CtrlReg0XM::FIFO_EN::replace(temp, mode != FIFO_BYPASS)) == BUS_OK;
+	ok &= xmWriteByte(FIFO_CTRL_REG, 0x00) == BUS_OK; // Bypass empties the FIFO
+#if LSM9DS0_USE_FRAME
+	fifoEpochs[1].runs = 0;
+#endif
+	if (mode != FIFO_BYPASS)
+		ok &= xmWriteByte(FIFO_CTRL_REG, FifoCtrlReg::FM::bits(mode) |
+						  FifoCtrlReg::FTH::bits(watermark)) == BUS_OK;
+	return ok;
+}
+
+bool LSM9DS0::setGyroWatermark(uint8_t watermark)
+{
+	uint8_t temp;
+	if (gReadBytes(FIFO_CTRL_REG_G, &temp, 1) != BUS_OK)
+		return false;
+	return gWriteByte(FIFO_CTRL_REG_G, FifoCtrlRegG::WTM::replace(temp, watermark)) == BUS_OK;
+}
+
+bool LSM9DS0::setAccelWatermark(uint8_t watermark)
+{
+	uint8_t temp;
+	if (xmReadBytes(FIFO_CTRL_REG, &temp, 1) != BUS_OK)
+		return false;
+	return xmWriteByte(FIFO_CTRL_REG, FifoCtrlReg::FTH::replace(temp, watermark)) == BUS_OK;
+}
+
+bool LSM9DS0::setWatermarkInt(bool gyro, bool accel)
+{
+	bool ok = true;
+	uint8_t temp;
+	if (gyro)
+	{
+		// DRDY_G signals the watermark instead of data ready.
+		if (gReadBytes(CTRL_REG3_G, &temp, 1) == BUS_OK)
+		{
+			temp = CtrlReg3G::I2_DRDY::replace(temp, 0);
+			ok &= gWriteByte(CTRL_REG3_G, CtrlReg3G::I2_WTM::replace(temp, 1)) == BUS_OK;
+		}
+		else
+			ok = false;
+	}
+	if (accel)
+	{
+		// INT2_XM signals the watermark instead of accel or mag data ready.
+		if (xmReadBytes(CTRL_REG4_XM, &temp, 1) == BUS_OK)
+		{
+			temp = CtrlReg4XM::P2_DRDYA::replace(temp, 0);
+			temp = CtrlReg4XM::P2_DRDYM::replace(temp, 0);
+			ok &= xmWriteByte(CTRL_REG4_XM, CtrlReg4XM::P2_WTM::replace(temp, 1)) == BUS_OK;
+		}
+		else
+			ok = false;
+	}
+	return ok;
+}
+
+uint8_t LSM9DS0::readGyroFIFO(int16_t * dest, uint8_t maxSamples)
+{
+	uint8_t src; // A failed read mustn't look like 31 stored samples
+	if (gReadBytes(FIFO_SRC_REG_G, &src, 1) != BUS_OK)
+		return 0;
+	recordStatus(true, FIFO_SRC_REG_G, src);
+	uint8_t samples = src & 0x1F; // Stored samples
+	if (samples > maxSamples)
+		samples = maxSamples;
+	return readFIFO(true, dest, samples);
+}
+
+uint8_t LSM9DS0::readAccelFIFO(int16_t * dest, uint8_t maxSamples)
+{
+	uint8_t src;
+	if (xmReadBytes(FIFO_SRC_REG, &src, 1) != BUS_OK)
+		return 0;
+	recordStatus(false, FIFO_SRC_REG, src);
+	uint8_t samples = src & 0x1F; // Stored samples
+	if (samples > maxSamples)
+		samples = maxSamples;
+	return readFIFO(false, dest, samples);
+}
+
+uint8_t LSM9DS0::readFIFO(bool gyro, int16_t * dest, uint8_t samples)
+{
+	uint8_t data[6 * FIFO_BURST_SAMPLES];
+	uint8_t read = 0;
+	while (read < samples)
+	{
+		uint8_t n = samples - read;
+		if (n > FIFO_BURST_SAMPLES)
+			n = FIFO_BURST_SAMPLES;
+		if (readBytes(gyro ? gAddress : xmAddress, gyro ? OUT_X_L_G : OUT_X_L_A,
+					  data, 6 * n, true) != BUS_OK)
+			break; // What was read of this burst can't be trusted
+		for (uint8_t i = 0; i < 6 * n; i += 2)
+			*dest++ = (int16_t) (((int16_t)data[i + 1] << 8) | data[i]);
+		read += n;
+	}
+	return read;
+}
+
+#if LSM9DS0_USE_FRAME
+// Output data rates, in eighths of a Hz (so 3.125 Hz fits an integer),
+// indexed by the ODR bits of each sensor's control register.
+static const uint16_t gOdrEighths[4] = {760, 1520, 3040, 6080};
+static const uint16_t aOdrEighths[11] = {0, 25, 50, 100, 200, 400, 800, 1600,
+										 3200, 6400, 12800};
+static const uint16_t mOdrEighths[6] = {25, 50, 100, 200, 400, 800};
+
+// gyroOdr(), accelOdr(), magOdr() -- A sensor's output data rate, in eighths
+// of a Hz, from its control registers. 0 if it's off.
+static uint16_t gyroOdr(uint8_t ctrl1)
+{
+	// CTRL_REG1_G: DR1 DR0 BW1 BW0 PD Zen Xen Yen (PD = 0 is power-down)
+	return (ctrl1 & 0x08) ? gOdrEighths[ctrl1 >> 6] : 0;
+}
+
+static uint16_t accelOdr(uint8_t ctrl1)
+{
+	// CTRL_REG1_XM: AODR3 AODR2 AODR1 AODR0 BDU AZEN AYEN AXEN
+	uint8_t aodr = CtrlReg1XM::AODR::get(ctrl1);
+	return (aodr < 11) ? aOdrEighths[aodr] : 0;
+}
+
+static uint16_t magOdr(uint8_t ctrl5, uint8_t ctrl7)
+{
+	// CTRL_REG7_XM: ... MLP MD1 MD0 (MD = 00 is continuous conversion), and
+	// CTRL_REG5_XM: TEMP_EN M_RES1 M_RES0 M_ODR2 M_ODR1 M_ODR0 LIR2 LIR1
+	if (ctrl7 & 0x03)
+		return 0;
+	if (ctrl7 & 0x04)
+		return 25; // Low-power mode: 3.125 Hz
+	uint8_t modr = CtrlReg5XM::M_ODR::get(ctrl5);
+	return (modr < 6) ? mOdrEighths[modr] : 0;
+}
+#endif
+
+// fullScale() -- A sensor's full scale, in DPS, g's, or Gs, from its scale
+// setting (as in calcgRes(), calcaRes(), and calcmRes()), without floats.
+// Input:
+//	- sensor = 0 (gyro), 1 (accel), or 2 (mag).
+static uint16_t fullScale(uint8_t sensor, uint8_t scale)
+{
+	if (sensor == 0)
+		return (scale == 0) ? 245 : (scale == 1) ? 500 : 2000;
+	if (sensor == 1)
+		return (scale >= 4) ? 16 : (scale + 1) * 2;
+	return scale ? scale << 2 : 2;
+}
+
+// rescale() -- Convert a raw reading taken at one full scale to another,
+// rounding and saturating.
+static void rescale(int16_t & x, int16_t & y, int16_t & z, uint16_t from,
+					uint16_t to)
+{
+	int16_t * v[3] = {&x, &y, &z};
+	for (int i = 0; i < 3; i++)
+	{
+		int32_t r = (int32_t) *v[i] * from;
+		r = (r < 0 ? r - to / 2 : r + to / 2) / to;
+		*v[i] = (r > 32767) ? 32767 : (r < -32768) ? -32768 : (int16_t) r;
+	}
+}
+
+#if LSM9DS0_USE_FRAME
+void LSM9DS0::updateODRs()
+{
+	odr[0] = gyroOdr(gReadByte(CTRL_REG1_G));
+	odr[1] = accelOdr(xmReadByte(CTRL_REG1_XM));
+	odr[2] = magOdr(xmReadByte(CTRL_REG5_XM), xmReadByte(CTRL_REG7_XM));
+}
+#endif
+
+void LSM9DS0::restartEpochs()
+{
+#if LSM9DS0_USE_FRAME
+	for (int i = 0; i < 3; i++)
+		epoch[i]++;
+	fifoEpochs[0].runs = fifoEpochs[1].runs = 0;
+	updateODRs();
+#endif
+	stale = 0;
+}
+
+bool LSM9DS0::beginEpoch(uint8_t sensor)
+{
+#if LSM9DS0_USE_FRAME
+	uint8_t i = (sensor == VALID_G) ? 0 : (sensor == VALID_A) ? 1 : 2;
+#endif
+	// A failed read would look like 0xFF: FIFO on, in stream-to-FIFO mode.
+	uint8_t fifoCtrl = 0, ctrl = 0;
+	bool fifoOn = false;
+	if (sensor == VALID_G)
+	{
+		if (gReadBytes(FIFO_CTRL_REG_G, &fifoCtrl, 1) != BUS_OK ||
+			gReadBytes(CTRL_REG5_G, &ctrl, 1) != BUS_OK)
+			return false;
+		fifoOn = CtrlReg5G::FIFO_EN::get(ctrl) &&
+				 FifoCtrlRegG::FM::get(fifoCtrl) != FIFO_BYPASS;
+	}
+	else if (sensor == VALID_A)
+	{
+		if (xmReadBytes(FIFO_CTRL_REG, &fifoCtrl, 1) != BUS_OK ||
+			xmReadBytes(CTRL_REG0_XM, &ctrl, 1) != BUS_OK)
+			return false;
+		fifoOn = CtrlReg0XM::FIFO_EN::get(ctrl) &&
+				 FifoCtrlReg::FM::get(fifoCtrl) != FIFO_BYPASS;
+	}
+	
+	if (!fifoOn)
+	{
+		// The output registers hold the last sample until the next one
+		// arrives. Take it now, under the old configuration, and keep it
+		// until there's a new one.
+		if (sensor == VALID_G)
+			readGyro();
+		else if (sensor == VALID_A)
+			readAccel();
+		else
+			readMag();
+		stale |= sensor;
+#if LSM9DS0_USE_FRAME
+		if (i < 2)
+			fifoEpochs[i].runs = 0;
+		epoch[i]++;
+#endif
+		return true;
+	}
+	
+#if LSM9DS0_USE_FRAME
+	// Everything in the FIFO now was taken under the old configuration.
+	fifo_epochs & e = fifoEpochs[i];
+	uint8_t src;
+	if (readBytes(i ? xmAddress : gAddress, i ? FIFO_SRC_REG : FIFO_SRC_REG_G,
+				  &src, 1) != BUS_OK)
+		src = 0x20; // Can't tell; assume it was empty
+	recordStatus(!i, i ? FIFO_SRC_REG : FIFO_SRC_REG_G, src);
+	uint8_t stored = (src & 0x40) ? 32 : (src & 0x1F);
+	trimEpochs(i, stored, src & 0x40);
+	uint8_t queued = 0;
+	for (uint8_t k = 0; k < e.runs; k++)
+		queued += e.run[k].count;
+	if (stored > queued)
+	{
+		if (e.runs == LSM9DS0_EPOCH_DEPTH)
+			e.run[e.runs - 1].count += stored - queued;
+		else
+		{
+			fifo_run & r = e.run[e.runs++];
+			r.odr = odr[i];
+			r.scale = i ? (uint8_t) aScale : (uint8_t) gScale;
+			r.epoch = epoch[i];
+			r.count = stored - queued;
+		}
+	}
+	e.stream = FifoCtrlReg::FM::get(fifoCtrl) != FIFO_MODE;
+	e.changed = micros();
+	epoch[i]++;
+#endif
+	return true;
+}
+
+#if LSM9DS0_USE_FRAME
+void LSM9DS0::trimEpochs(uint8_t fifo, uint8_t stored, bool overrun)
+{
+	fifo_epochs & e = fifoEpochs[fifo];
+	if (!e.runs)
+		return;
+	uint8_t queued = 0;
+	for (uint8_t k = 0; k < e.runs; k++)
+		queued += e.run[k].count;
+	// Samples read some other way (readGyroFIFO(), ...) were the oldest.
+	uint8_t keep = (queued < stored) ? queued : stored;
+	if (overrun && e.stream)
+	{
+		// A full stream-mode FIFO drops its oldest sample for every new
+		// one, and new ones have been arriving since the change.
+		float arrived = (micros() - e.changed) * (odr[fifo] / 8e6f);
+		if (arrived >= 32)
+			keep = 0;
+		else if (keep > 32 - (uint8_t) arrived)
+			keep = 32 - (uint8_t) arrived;
+	}
+	uint8_t drop = queued - keep;
+	while (drop)
+	{
+		fifo_run & r = e.run[0];
+		if (r.count > drop)
+		{
+			r.count -= drop;
+			break;
+		}
+		drop -= r.count;
+		for (uint8_t k = 1; k < e.runs; k++)
+			e.run[k - 1] = e.run[k];
+		e.runs--;
+	}
+}
+#endif
+
+bool LSM9DS0::staleOutput(uint8_t sensor)
+{
+	if (!(stale & sensor))
+		return false;
+	// STATUS_REG_G/A/M: ZYXOR ZOR YOR XOR ZYXDA ZDA YDA XDA
+	uint8_t subAddress = (sensor == VALID_G) ? STATUS_REG_G :
+						 (sensor == VALID_A) ? STATUS_REG_A : STATUS_REG_M;
+	uint8_t status;
+	if (readBytes(sensor == VALID_G ? gAddress : xmAddress, subAddress,
+				  &status, 1) != BUS_OK)
+	{
+		valid &= ~sensor;
+		return true;
+	}
+	recordStatus(sensor == VALID_G, subAddress, status);
+	if (!(status & 0x08))
+		return true;
+	stale &= ~sensor;
+	return false;
+}
+
+#if LSM9DS0_USE_FRAME
+void LSM9DS0::initFrame(LSM9DS0_frame & frame)
+{
+	LSM9DS0_frame_header & h = frame.header;
+	startLSM9DS0FrameWrite(frame);
+	uint32_t gen = h.generation;
+	memset(&frame, 0, sizeof(frame));
+	h.generation = gen;
+	h.magic = LSM9DS0_FRAME_MAGIC;
+	h.version = LSM9DS0_FRAME_VERSION;
+	h.size = sizeof(frame);
+	
+	updateODRs();
+	h.gOdr = odr[0] / 8.0;
+	h.aOdr = odr[1] / 8.0;
+	h.mOdr = odr[2] / 8.0;
+	finishLSM9DS0FrameWrite(frame);
+}
+
+uint8_t LSM9DS0::readFrame(LSM9DS0_frame & frame)
+{
+	LSM9DS0_frame_header & h = frame.header;
+	startLSM9DS0FrameWrite(frame);
+	h.timestamp = micros();
+	h.sequence++;
+	h.mRes = fullScale(2, mScale) / 32768.0;
+	h.mScale = mScale;
+	h.mOdr = odr[2] / 8.0;
+	h.mEpoch = epoch[2];
+#if LSM9DS0_USE_CAL
+	h.flags = aCalValid ? LSM9DS0_FRAME_A_CAL : 0;
+	for (int i = 0; i < 3; i++)
+	{
+		h.gbias[i] = gbias[i];
+		h.abias[i] = abias[i];
+	}
+#else
+	h.flags = 0; // initFrame() zeroed the biases
+#endif
+	
+	h.gCount = readFIFOFrame(true, frame.g, h);
+	h.aCount = readFIFOFrame(false, frame.a, h);
+	h.mCount = 0;
+	// setMagScale() and setMagODR() read the mag, so new data is always
+	// under the current configuration.
+	if (LSM9DS0_FRAME_MAG_SAMPLES && (xmReadByte(STATUS_REG_M) & 0x08)) // ZYXMDA
+	{
+		if (readMag())
+		{
+			frame.m[0][0] = mx;
+			frame.m[1][0] = my;
+			frame.m[2][0] = mz;
+			h.mCount = 1;
+		}
+		else
+			h.flags |= LSM9DS0_FRAME_BUS_ERROR;
+	}
+#if LSM9DS0_USE_TEMP
+	if (!readTemp())
+		h.flags |= LSM9DS0_FRAME_BUS_ERROR;
+	h.temperature = temperature;
+#endif
+	finishLSM9DS0FrameWrite(frame);
+	return h.gCount + h.aCount + h.mCount;
+}
+
+uint8_t LSM9DS0::readFIFOFrame(bool gyro, int16_t (* dest)[LSM9DS0_FRAME_SAMPLES],
+							   LSM9DS0_frame_header & h)
+{
+	uint8_t f = gyro ? 0 : 1;
+	fifo_epochs & e = fifoEpochs[f];
+	float & res = gyro ? h.gRes : h.aRes;
+	float & rate = gyro ? h.gOdr : h.aOdr;
+	uint8_t & scale = gyro ? h.gScale : h.aScale;
+	uint8_t & ep = gyro ? h.gEpoch : h.aEpoch;
+	uint8_t & later = gyro ? h.gLater : h.aLater;
+	scale = gyro ? (uint8_t) gScale : (uint8_t) aScale;
+	res = fullScale(f, scale) / 32768.0;
+	rate = odr[f] / 8.0;
+	ep = epoch[f];
+	later = 0;
+	
+	// FIFO_SRC_REG(_G): WTM OVRN EMPTY FSS4 FSS3 FSS2 FSS1 FSS0
+	uint8_t src;
+	if (readBytes(gyro ? gAddress : xmAddress, gyro ? FIFO_SRC_REG_G : FIFO_SRC_REG,
+				  &src, 1) != BUS_OK)
+	{
+		h.flags |= LSM9DS0_FRAME_BUS_ERROR;
+		return 0;
+	}
+	recordStatus(gyro, gyro ? FIFO_SRC_REG_G : FIFO_SRC_REG, src);
+	if (src & 0x40)
+		h.flags |= gyro ? LSM9DS0_FRAME_G_OVERRUN : LSM9DS0_FRAME_A_OVERRUN;
+	// FSS stops at 31; with OVRN set, all 32 levels are full.
+	uint8_t stored = (src & 0x40) ? 32 : (src & 0x1F);
+	uint8_t samples = (stored > LSM9DS0_FRAME_SAMPLES) ? LSM9DS0_FRAME_SAMPLES
+													   : stored;
+	
+	// Samples from before a scale or ODR change go out first, in a frame
+	// of their own, labelled with the configuration they were taken under.
+	trimEpochs(f, stored, src & 0x40);
+	if (e.runs)
+	{
+		const fifo_run & r = e.run[0];
+		res = fullScale(f, r.scale) / 32768.0;
+		rate = r.odr / 8.0;
+		scale = r.scale;
+		ep = r.epoch;
+		if (samples > r.count)
+			samples = r.count;
+	}
+	
+	// Read in bursts, then spread each burst across the per-axis arrays.
+	int16_t data[3 * FIFO_BURST_SAMPLES];
+	uint8_t i = 0;
+	while (i < samples)
+	{
+		uint8_t n = samples - i;
+		if (n > FIFO_BURST_SAMPLES)
+			n = FIFO_BURST_SAMPLES;
+		if (readFIFO(gyro, data, n) < n)
+		{
+			h.flags |= LSM9DS0_FRAME_BUS_ERROR;
+			break;
+		}
+		for (uint8_t j = 0; j < n; j++, i++)
+		{
+			dest[0][i] = data[3 * j];
+			dest[1][i] = data[3 * j + 1];
+			dest[2][i] = data[3 * j + 2];
+		}
+	}
+	
+	if (e.runs && !(e.run[0].count -= i))
+	{
+		for (uint8_t k = 1; k < e.runs; k++)
+			e.run[k - 1] = e.run[k];
+		e.runs--;
+	}
+	later = stored - i;
+	if (later)
+		h.flags |= LSM9DS0_FRAME_MORE;
+	return i;
+}
+#endif
+
+uint16_t LSM9DS0::checksum(const void * data, uint16_t count)
+{
+	const uint8_t * bytes = (const uint8_t *) data;
+	uint16_t sum1 = 0, sum2 = 0;
+	while (count--)
+	{
+		sum1 = (sum1 + *bytes++) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+bool LSM9DS0::readAccel()
 {
 	uint8_t temp[6]; // We'll read six bytes from the accelerometer into temp	
-	xmReadBytes(OUT_X_L_A, temp, 6); // Read 6 bytes, beginning at OUT_X_L_A
+	// Right after a scale or ODR change, the latest sample is already here.
+	if (staleOutput(VALID_A))
+		return valid & VALID_A;
+	// Read 6 bytes, beginning at OUT_X_L_A. Keep the old values if it fails.
+	if (xmReadBytes(OUT_X_L_A, temp, 6) != BUS_OK)
+	{
+		valid &= ~VALID_A;
+		return false;
+	}
 	ax = (temp[1] << 8) | temp[0]; // Store x-axis values into ax
 	ay = (temp[3] << 8) | temp[2]; // Store y-axis values into ay
 	az = (temp[5] << 8) | temp[4]; // Store z-axis values into az
+	valid |= VALID_A;
+	return true;
 }
 
-void LSM9DS0::readMag()
+bool LSM9DS0::readMag()
 {
 	uint8_t temp[6]; // We'll read six bytes from the mag into temp	
-	xmReadBytes(OUT_X_L_M, temp, 6); // Read 6 bytes, beginning at OUT_X_L_M
+	// Right after a scale or ODR change, the latest sample is already here.
+	if (staleOutput(VALID_M))
+		return valid & VALID_M;
+	// Read 6 bytes, beginning at OUT_X_L_M. Keep the old values if it fails.
+	if (xmReadBytes(OUT_X_L_M, temp, 6) != BUS_OK)
+	{
+		valid &= ~VALID_M;
+		return false;
+	}
 	mx = (temp[1] << 8) | temp[0]; // Store x-axis values into mx
 	my = (temp[3] << 8) | temp[2]; // Store y-axis values into my
 	mz = (temp[5] << 8) | temp[4]; // Store z-axis values into mz
+	valid |= VALID_M;
+	return true;
 }
 
-void LSM9DS0::readTemp()
+#if LSM9DS0_USE_TEMP
+bool LSM9DS0::readTemp()
 {
 	uint8_t temp[2]; // We'll read two bytes from the temperature sensor into temp	
-	xmReadBytes(OUT_TEMP_L_XM, temp, 2); // Read 2 bytes, beginning at OUT_TEMP_L_M
+	// Read 2 bytes, beginning at OUT_TEMP_L_M. Keep the old value if it fails.
+	if (xmReadBytes(OUT_TEMP_L_XM, temp, 2) != BUS_OK)
+	{
+		valid &= ~VALID_TEMP;
+		return false;
+	}
 	temperature = (((int16_t) temp[1] << 12) | temp[0] << 4 ) >> 4; // Temperature is a 12-bit signed integer
+	valid |= VALID_TEMP;
+	return true;
 }
+#endif
 
-void LSM9DS0::readGyro()
+bool LSM9DS0::readGyro()
 {
 	uint8_t temp[6]; // We'll read six bytes from the gyro into temp
-	gReadBytes(OUT_X_L_G, temp, 6); // Read 6 bytes, beginning at OUT_X_L_G
+	// Right after a scale or ODR change, the latest sample is already here.
+	if (staleOutput(VALID_G))
+		return valid & VALID_G;
+	// Read 6 bytes, beginning at OUT_X_L_G. Keep the old values if it fails.
+	if (gReadBytes(OUT_X_L_G, temp, 6) != BUS_OK)
+	{
+		valid &= ~VALID_G;
+		return false;
+	}
 	gx = (temp[1] << 8) | temp[0]; // Store x-axis values into gx
 	gy = (temp[3] << 8) | temp[2]; // Store y-axis values into gy
 	gz = (temp[5] << 8) | temp[4]; // Store z-axis values into gz
+	valid |= VALID_G;
+	return true;
 }
 
+#if LSM9DS0_USE_FLOAT
 float LSM9DS0::calcGyro(int16_t gyro)
 {
 	// Return the gyro raw reading times our pre-calculated DPS / (ADC tick):
@@ -369,121 +1255,274 @@ float LSM9DS0::calcMag(int16_t mag)
 	// Return the mag raw reading times our pre-calculated Gs / (ADC tick):
 	return mRes * mag;
 }
+#endif
 
-void LSM9DS0::setGyroScale(gyro_scale gScl)
+bool LSM9DS0::setGyroScale(gyro_scale gScl)
 {
-	// We need to preserve the other bytes in CTRL_REG4_G. So, first read it:
-	uint8_t temp = gReadByte(CTRL_REG4_G);
-	// Then mask out the gyro scale bits:
-	temp &= 0xFF^(0x3 << 4);
-	// Then shift in our new scale bits:
-	temp |= gScl << 4;
-	// And write the new register value back into CTRL_REG4_G:
-	gWriteByte(CTRL_REG4_G, temp);
+	// Change FS in CTRL_REG4_G, preserving its other bits:
+	uint8_t temp;
+	if (gReadBytes(CTRL_REG4_G, &temp, 1) != BUS_OK || !beginEpoch(VALID_G) ||
+		gWriteByte(CTRL_REG4_G, CtrlReg4G::FS::replace(temp, gScl)) != BUS_OK)
+		return false;
+	
+	// gx, gy, and gz were taken at the old scale:
+	rescale(gx, gy, gz, fullScale(0, gScale), fullScale(0, gScl));
 	
 	// We've updated the sensor, but we also need to update our class variables
 	// First update gScale:
 	gScale = gScl;
+#if LSM9DS0_USE_FLOAT
 	// Then calculate a new gRes, which relies on gScale being set correctly:
 	calcgRes();
+#endif
+	return true;
 }
 
-void LSM9DS0::setAccelScale(accel_scale aScl)
+bool LSM9DS0::setAccelScale(accel_scale aScl)
 {
-	// We need to preserve the other bytes in CTRL_REG2_XM. So, first read it:
-	uint8_t temp = xmReadByte(CTRL_REG2_XM);
-	// Then mask out the accel scale bits:
-	temp &= 0xFF^(0x3 << 3);
-	// Then shift in our new scale bits:
-	temp |= aScl << 3;
-	// And write the new register value back into CTRL_REG2_XM:
-	xmWriteByte(CTRL_REG2_XM, temp);
+	// Change AFS (all three bits) in CTRL_REG2_XM, preserving its other bits:
+	uint8_t temp;
+	if (xmReadBytes(CTRL_REG2_XM, &temp, 1) != BUS_OK || !beginEpoch(VALID_A) ||
+		xmWriteByte(CTRL_REG2_XM, CtrlReg2XM::AFS::replace(temp, aScl)) != BUS_OK)
+		return false;
+	
+	// ax, ay, and az were taken at the old scale:
+	rescale(ax, ay, az, fullScale(1, aScale), fullScale(1, aScl));
 	
 	// We've updated the sensor, but we also need to update our class variables
 	// First update aScale:
 	aScale = aScl;
+#if LSM9DS0_USE_FLOAT
 	// Then calculate a new aRes, which relies on aScale being set correctly:
 	calcaRes();
+#endif
+	return true;
 }
 
-void LSM9DS0::setMagScale(mag_scale mScl)
+bool LSM9DS0::setMagScale(mag_scale mScl)
 {
-	// We need to preserve the other bytes in CTRL_REG6_XM. So, first read it:
-	uint8_t temp = xmReadByte(CTRL_REG6_XM);
-	// Then mask out the mag scale bits:
-	temp &= 0xFF^(0x3 << 5);
-	// Then shift in our new scale bits:
-	temp |= mScl << 5;
-	// And write the new register value back into CTRL_REG6_XM:
-	xmWriteByte(CTRL_REG6_XM, temp);
+	// Change MFS in CTRL_REG6_XM, preserving its other bits:
+	uint8_t temp;
+	if (xmReadBytes(CTRL_REG6_XM, &temp, 1) != BUS_OK || !beginEpoch(VALID_M) ||
+		xmWriteByte(CTRL_REG6_XM, CtrlReg6XM::MFS::replace(temp, mScl)) != BUS_OK)
+		return false;
+	
+	// mx, my, and mz were taken at the old scale:
+	rescale(mx, my, mz, fullScale(2, mScale), fullScale(2, mScl));
 	
 	// We've updated the sensor, but we also need to update our class variables
 	// First update mScale:
 	mScale = mScl;
+#if LSM9DS0_USE_FLOAT
 	// Then calculate a new mRes, which relies on mScale being set correctly:
 	calcmRes();
+#endif
+	return true;
 }
 
-void LSM9DS0::setGyroODR(gyro_odr gRate)
+bool LSM9DS0::setGyroODR(gyro_odr gRate)
 {
-	// We need to preserve the other bytes in CTRL_REG1_G. So, first read it:
-	uint8_t temp = gReadByte(CTRL_REG1_G);
-	// Then mask out the gyro ODR bits:
-	temp &= 0xFF^(0xF << 4);
-	// Then shift in our new ODR bits:
-	temp |= (gRate << 4);
-	// And write the new register value back into CTRL_REG1_G:
-	gWriteByte(CTRL_REG1_G, temp);
+	// Change DR and BW in CTRL_REG1_G, preserving PD and the axis enables:
+	uint8_t temp;
+	if (gReadBytes(CTRL_REG1_G, &temp, 1) != BUS_OK)
+		return false;
+	temp = CtrlReg1G::ODR::replace(temp, gRate);
+	if (!beginEpoch(VALID_G) || gWriteByte(CTRL_REG1_G, temp) != BUS_OK)
+		return false;
+#if LSM9DS0_USE_FRAME
+	odr[0] = gyroOdr(temp);
+#endif
+	return true;
 }
-void LSM9DS0::setAccelODR(accel_odr aRate)
+bool LSM9DS0::setAccelODR(accel_odr aRate)
 {
-	// We need to preserve the other bytes in CTRL_REG1_XM. So, first read it:
-	uint8_t temp = xmReadByte(CTRL_REG1_XM);
-	// Then mask out the accel ODR bits:
-	temp &= 0xFF^(0xF << 4);
-	// Then shift in our new ODR bits:
-	temp |= (aRate << 4);
-	// And write the new register value back into CTRL_REG1_XM:
-	xmWriteByte(CTRL_REG1_XM, temp);
+	// Change AODR in CTRL_REG1_XM, preserving its other bits:
+	uint8_t temp;
+	if (xmReadBytes(CTRL_REG1_XM, &temp, 1) != BUS_OK)
+		return false;
+	temp = CtrlReg1XM::AODR::replace(temp, aRate);
+	if (!beginEpoch(VALID_A) || xmWriteByte(CTRL_REG1_XM, temp) != BUS_OK)
+		return false;
+#if LSM9DS0_USE_FRAME
+	odr[1] = accelOdr(temp);
+#endif
+	return true;
 }
-void LSM9DS0::setAccelABW(accel_abw abwRate)
+bool LSM9DS0::setAccelABW(accel_abw abwRate)
 {
-	// We need to preserve the other bytes in CTRL_REG2_XM. So, first read it:
-	uint8_t temp = xmReadByte(CTRL_REG2_XM);
-	// Then mask out the accel ABW bits:
-	temp &= 0xFF^(0x3 << 7);
-	// Then shift in our new ODR bits:
-	temp |= (abwRate << 7);
-	// And write the new register value back into CTRL_REG2_XM:
-	xmWriteByte(CTRL_REG2_XM, temp);
+	// Change ABW (bits 7:6) in CTRL_REG2_XM, preserving its other bits:
+	uint8_t temp;
+	if (xmReadBytes(CTRL_REG2_XM, &temp, 1) != BUS_OK)
+		return false;
+	return xmWriteByte(CTRL_REG2_XM, CtrlReg2XM::ABW::replace(temp, abwRate)) == BUS_OK;
 }
-void LSM9DS0::setMagODR(mag_odr mRate)
+bool LSM9DS0::setMagODR(mag_odr mRate)
 {
-	// We need to preserve the other bytes in CTRL_REG5_XM. So, first read it:
-	uint8_t temp = xmReadByte(CTRL_REG5_XM);
-	// Then mask out the mag ODR bits:
-	temp &= 0xFF^(0x7 << 2);
-	// Then shift in our new ODR bits:
-	temp |= (mRate << 2);
-	// And write the new register value back into CTRL_REG5_XM:
-	xmWriteByte(CTRL_REG5_XM, temp);
+	// Change M_ODR in CTRL_REG5_XM, preserving its other bits. The ODR
+	// also depends on MD, in CTRL_REG7_XM.
+	uint8_t temp[3]; // CTRL_REG5_XM through CTRL_REG7_XM
+	if (xmReadBytes(CTRL_REG5_XM, temp, 3) != BUS_OK)
+		return false;
+	temp[0] = CtrlReg5XM::M_ODR::replace(temp[0], mRate);
+	if (!beginEpoch(VALID_M) || xmWriteByte(CTRL_REG5_XM, temp[0]) != BUS_OK)
+		return false;
+#if LSM9DS0_USE_FRAME
+	odr[2] = magOdr(temp[0], temp[2]);
+#endif
+	return true;
+}
+
+#if LSM9DS0_USE_FLOAT
+// Gyro HPF cutoffs, in mHz, from datasheet table 26. Each ODR step doubles
+// every cutoff, which shifts the table by one: the cutoff for HPCF at ODR
+// index DR[1:0] is gHpfCutoff[HPCF + 3 - DR].
+static const uint16_t gHpfCutoff[13] = {51400, 27000, 13500, 7200, 3500, 1800,
+										900, 450, 180, 90, 45, 18, 9};
+
+float LSM9DS0::setGyroHPF(gyro_hpf_mode mode, float cutoff, gyro_path out, gyro_path int1)
+{
+	// The cutoff options depend on the current ODR, in DR[1:0]. Read
+	// CTRL_REG5_G now too, so a bus failure changes nothing.
+	uint8_t dr, temp;
+	if (gReadBytes(CTRL_REG1_G, &dr, 1) != BUS_OK ||
+		gReadBytes(CTRL_REG5_G, &temp, 1) != BUS_OK)
+		return 0;
+	dr >>= 6;
+	float target = cutoff * 1000.0; // The table is in mHz
+	
+	// Reject cutoffs well outside what this ODR can do:
+	if (target > 1.5 * gHpfCutoff[3 - dr] || target < 0.5 * gHpfCutoff[12 - dr])
+		return 0;
+	
+	// Pick the HPCF whose cutoff is closest, by ratio:
+	uint8_t hpcf = 0;
+	float best = 0;
+	for (uint8_t i = 0; i <= 9; i++)
+	{
+		float f = gHpfCutoff[i + 3 - dr];
+		float ratio = f > target ? f / target : target / f;
+		if (i == 0 || ratio < best)
+		{
+			best = ratio;
+			hpcf = i;
+		}
+	}
+	
+	if (gWriteByte(CTRL_REG2_G, CtrlReg2G::HPM::bits(mode) |
+				   CtrlReg2G::HPCF::bits(hpcf)) != BUS_OK)
+		return 0;
+	
+	// Enable the HPF if either path uses it, leaving BOOT and FIFO_EN be.
+	temp = CtrlReg5G::HPEN::replace(temp, out != G_PATH_LPF1 || int1 != G_PATH_LPF1);
+	temp = CtrlReg5G::INT1_SEL::replace(temp, int1);
+	if (gWriteByte(CTRL_REG5_G, CtrlReg5G::OUT_SEL::replace(temp, out)) != BUS_OK)
+		return 0;
+	
+	return gHpfCutoff[hpcf + 3 - dr] / 1000.0;
+}
+#endif
+
+bool LSM9DS0::disableGyroHPF()
+{
+	// Clear HPen, INT1_Sel, and Out_Sel, preserving BOOT and FIFO_EN:
+	uint8_t temp;
+	if (gReadBytes(CTRL_REG5_G, &temp, 1) != BUS_OK)
+		return false;
+	temp = CtrlReg5G::HPEN::replace(temp, 0);
+	temp = CtrlReg5G::INT1_SEL::replace(temp, G_PATH_LPF1);
+	return gWriteByte(CTRL_REG5_G, CtrlReg5G::OUT_SEL::replace(temp, G_PATH_LPF1)) == BUS_OK;
+}
+
+void LSM9DS0::setGyroHPFReference(int8_t ref)
+{
+	gWriteByte(REFERENCE_G, (uint8_t) ref);
+}
+
+void LSM9DS0::resetGyroHPF()
+{
+	// In HPM = 00, reading REFERENCE_G resets the filter. Ignore the value.
+	gReadByte(REFERENCE_G);
+}
+
+bool LSM9DS0::setAccelHPF(accel_hpf_mode mode, uint8_t routes)
+{
+	// Read both registers first, so a bus failure changes nothing.
+	uint8_t temp, ctrl0;
+	if (xmReadBytes(CTRL_REG7_XM, &temp, 1) != BUS_OK ||
+		xmReadBytes(CTRL_REG0_XM, &ctrl0, 1) != BUS_OK)
+		return false;
+	
+	// The rest of CTRL_REG7_XM belongs to the magnetometer, so preserve it.
+	temp = CtrlReg7XM::AHPM::replace(temp, mode);
+	temp = CtrlReg7XM::AFDS::replace(temp, (routes & A_HPF_DATA) != 0);
+	if (xmWriteByte(CTRL_REG7_XM, temp) != BUS_OK)
+		return false;
+	
+	// Preserve the FIFO bits, but never write BOOT back.
+	temp = CtrlReg0XM::BOOT::replace(ctrl0, 0);
+	temp = CtrlReg0XM::HP_CLICK::replace(temp, (routes & A_HPF_CLICK) != 0);
+	temp = CtrlReg0XM::HPIS1::replace(temp, (routes & A_HPF_INT1) != 0);
+	temp = CtrlReg0XM::HPIS2::replace(temp, (routes & A_HPF_INT2) != 0);
+	return xmWriteByte(CTRL_REG0_XM, temp) == BUS_OK;
+}
+
+void LSM9DS0::setAccelHPFReference(int8_t x, int8_t y, int8_t z)
+{
+	// REFERENCE_X, REFERENCE_Y, and REFERENCE_Z are contiguous:
+	uint8_t temp[3] = {(uint8_t) x, (uint8_t) y, (uint8_t) z};
+	xmWriteBytes(REFERENCE_X, temp, 3);
+}
+
+void LSM9DS0::resetAccelHPF()
+{
+	// In AHPM = 00, reading the reference registers resets the filter.
+	uint8_t temp[3];
+	xmReadBytes(REFERENCE_X, temp, 3);
 }
 
 void LSM9DS0::configGyroInt(uint8_t int1Cfg, uint16_t int1ThsX, uint16_t int1ThsY, uint16_t int1ThsZ, uint8_t duration)
 {
+	// The thresholds are 15 bits, high byte first, from INT1_THS_XH_G
+	// through INT1_THS_ZL_G, then the duration.
+	uint16_t ths[3] = {int1ThsX, int1ThsY, int1ThsZ};
+	uint8_t temp[7];
+	for (int i = 0; i < 3; i++)
+	{
+		temp[2 * i] = Int1ThsHG::THS::bits(ths[i] >> 8);
+		temp[2 * i + 1] = ths[i] & 0xFF;
+	}
+	temp[6] = Int1DurationG::WAIT::bits(duration != 0) | Int1DurationG::D::bits(duration);
 	gWriteByte(INT1_CFG_G, int1Cfg);
-	gWriteByte(INT1_THS_XH_G, (int1ThsX & 0xFF00) >> 8);
-	gWriteByte(INT1_THS_XL_G, (int1ThsX & 0xFF));
-	gWriteByte(INT1_THS_YH_G, (int1ThsY & 0xFF00) >> 8);
-	gWriteByte(INT1_THS_YL_G, (int1ThsY & 0xFF));
-	gWriteByte(INT1_THS_ZH_G, (int1ThsZ & 0xFF00) >> 8);
-	gWriteByte(INT1_THS_ZL_G, (int1ThsZ & 0xFF));
-	if (duration)
-		gWriteByte(INT1_DURATION_G, 0x80 | duration);
-	else
-		gWriteByte(INT1_DURATION_G, 0x00);
+	gWriteBytes(INT1_THS_XH_G, temp, 7);
+}
+
+bool LSM9DS0::configAccelInt(uint8_t cfg, uint8_t threshold, uint8_t duration, bool latch)
+{
+	// Read the shared registers first, so a bus failure changes nothing.
+	uint8_t ctrl3, ctrl5;
+	if (xmReadBytes(CTRL_REG3_XM, &ctrl3, 1) != BUS_OK ||
+		xmReadBytes(CTRL_REG5_XM, &ctrl5, 1) != BUS_OK)
+		return false;
+	
+	bool ok = xmWriteByte(INT_GEN_1_THS, threshold & 0x7F) == BUS_OK;
+	ok &= xmWriteByte(INT_GEN_1_DURATION, duration & 0x7F) == BUS_OK;
+	ok &= xmWriteByte(CTRL_REG5_XM, CtrlReg5XM::LIR1::replace(ctrl5, latch)) == BUS_OK;
+	ok &= xmWriteByte(INT_GEN_1_REG, cfg) == BUS_OK;
+	
+	// INT1_XM signals the generator instead of accel data ready, or goes
+	// back to data ready with the generator off.
+	ctrl3 = CtrlReg3XM::P1_DRDYA::replace(ctrl3, !cfg);
+	ok &= xmWriteByte(CTRL_REG3_XM, CtrlReg3XM::P1_INT1::replace(ctrl3, cfg != 0)) == BUS_OK;
+	readAccelIntSource(); // Clear anything latched under the old settings
+	return ok;
+}
+
+uint8_t LSM9DS0::readAccelIntSource()
+{
+	return xmReadByte(INT_GEN_1_SRC);
 }
 
+#if LSM9DS0_USE_FLOAT
 void LSM9DS0::calcgRes()
 {
 	// Possible gyro scales (and their register bit settings) are:
@@ -520,65 +1559,272 @@ void LSM9DS0::calcmRes()
 	mRes = mScale == M_SCALE_2GS ? 2.0 / 32768.0 : 
 	       (float) (mScale << 2) / 32768.0;
 }
+#endif
 	
-void LSM9DS0::gWriteByte(uint8_t subAddress, uint8_t data)
+LSM9DS0::bus_status LSM9DS0::gWriteByte(uint8_t subAddress, uint8_t data)
 {
-	// Whether we're using I2C or SPI, write a byte using the
-	// gyro-specific I2C address or SPI CS pin.
-	if (interfaceMode == MODE_I2C)
-		I2CwriteByte(gAddress, subAddress, data);
-	else if (interfaceMode == MODE_SPI)
-		SPIwriteByte(gAddress, subAddress, data);
+	// Write a byte using the gyro-specific I2C address or SPI CS pin.
+	return writeBytes(gAddress, subAddress, &data, 1);
 }
 
-void LSM9DS0::xmWriteByte(uint8_t subAddress, uint8_t data)
+LSM9DS0::bus_status LSM9DS0::xmWriteByte(uint8_t subAddress, uint8_t data)
 {
-	// Whether we're using I2C or SPI, write a byte using the
-	// accelerometer-specific I2C address or SPI CS pin.
-	if (interfaceMode == MODE_I2C)
-		return I2CwriteByte(xmAddress, subAddress, data);
-	else if (interfaceMode == MODE_SPI)
-		return SPIwriteByte(xmAddress, subAddress, data);
+	// Write a byte using the accelerometer-specific I2C address or SPI CS pin.
+	return writeBytes(xmAddress, subAddress, &data, 1);
+}
+
+LSM9DS0::bus_status LSM9DS0::gWriteBytes(uint8_t subAddress, const uint8_t * src,
+										 uint8_t count)
+{
+	return writeBytes(gAddress, subAddress, src, count);
+}
+
+LSM9DS0::bus_status LSM9DS0::xmWriteBytes(uint8_t subAddress, const uint8_t * src,
+										  uint8_t count)
+{
+	return writeBytes(xmAddress, subAddress, src, count);
 }
 
 uint8_t LSM9DS0::gReadByte(uint8_t subAddress)
 {
-	// Whether we're using I2C or SPI, read a byte using the
-	// gyro-specific I2C address or SPI CS pin.
-	if (interfaceMode == MODE_I2C)
-		return I2CreadByte(gAddress, subAddress);
-	else if (interfaceMode == MODE_SPI)
-		return SPIreadByte(gAddress, subAddress);
+	// A one-byte burst: a failed read returns 0xFF, like an idle bus.
+	uint8_t data;
+	if (readBytes(gAddress, subAddress, &data, 1) != BUS_OK)
+		return 0xFF;
+	recordStatus(true, subAddress, data);
+	return data;
 }
 
-void LSM9DS0::gReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count)
+LSM9DS0::bus_status LSM9DS0::gReadBytes(uint8_t subAddress, uint8_t * dest,
+										uint8_t count)
 {
-	// Whether we're using I2C or SPI, read multiple bytes using the
-	// gyro-specific I2C address or SPI CS pin.
-	if (interfaceMode == MODE_I2C)
-		I2CreadBytes(gAddress, subAddress, dest, count);
-	else if (interfaceMode == MODE_SPI)
-		SPIreadBytes(gAddress, subAddress, dest, count);
+	return readBytes(gAddress, subAddress, dest, count);
 }
 
 uint8_t LSM9DS0::xmReadByte(uint8_t subAddress)
 {
-	// Whether we're using I2C or SPI, read a byte using the
-	// accelerometer-specific I2C address or SPI CS pin.
-	if (interfaceMode == MODE_I2C)
-		return I2CreadByte(xmAddress, subAddress);
-	else if (interfaceMode == MODE_SPI)
-		return SPIreadByte(xmAddress, subAddress);
+	// A one-byte burst: a failed read returns 0xFF, like an idle bus.
+	uint8_t data;
+	if (readBytes(xmAddress, subAddress, &data, 1) != BUS_OK)
+		return 0xFF;
+	recordStatus(false, subAddress, data);
+	return data;
 }
 
-void LSM9DS0::xmReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count)
+LSM9DS0::bus_status LSM9DS0::xmReadBytes(uint8_t subAddress, uint8_t * dest,
+										 uint8_t count)
 {
-	// Whether we're using I2C or SPI, read multiple bytes using the
-	// accelerometer-specific I2C address or SPI CS pin.
+	return readBytes(xmAddress, subAddress, dest, count);
+}
+
+LSM9DS0::bus_status LSM9DS0::writeBytes(uint8_t address, uint8_t subAddress,
+										const uint8_t * src, uint8_t count)
+{
+	// Whether we're using I2C or SPI, write using the given I2C address or
+	// SPI CS pin. SPI has no acknowledge, so it can't fail.
+	for (uint8_t attempt = 0; ; attempt++)
+	{
+		unsigned long start = statsClock();
+		uint8_t status = 4; // Wire's "other error", if no transport ran
+#if LSM9DS0_USE_I2C
+		if (interfaceMode == MODE_I2C)
+		{
+			if (count == 1)
+				status = I2CwriteByte(address, subAddress, *src);
+			else
+				status = I2CwriteBytes(address, subAddress, src, count);
+		}
+#endif
+#if LSM9DS0_USE_SPI
+		if (interfaceMode == MODE_SPI)
+		{
+			if (count == 1)
+				SPIwriteByte(address, subAddress, *src);
+			else
+				SPIwriteBytes(address, subAddress, src, count);
+			status = 0;
+		}
+#endif
+		recordTransfer(true, count, status ? 0 : count, start);
+		if (status == 0)
+			return BUS_OK;
+		if (attempt >= busRetries)
+			return (status == 2) ? BUS_NACK : BUS_ERROR; // 2: address NACK
+		recordRetry(attempt);
+	}
+}
+
+LSM9DS0::bus_status LSM9DS0::readBytes(uint8_t address, uint8_t subAddress,
+									   uint8_t * dest, uint8_t count, bool fifo)
+{
+	for (uint8_t attempt = 0; ; attempt++)
+	{
+		unsigned long start = statsClock();
+		uint8_t done = 0; // Nothing, if no transport ran
+#if LSM9DS0_USE_I2C
+		if (interfaceMode == MODE_I2C)
+			done = I2CreadBytes(address, subAddress, dest, count, fifo);
+#endif
+#if LSM9DS0_USE_SPI
+		if (interfaceMode == MODE_SPI)
+		{
+			SPIreadBytes(address, subAddress, dest, count);
+			done = count;
+		}
+#endif
+		recordTransfer(false, count, done, start);
+		if (done == count)
+			return BUS_OK;
+		if (attempt >= busRetries || (fifo && done))
+			return done ? BUS_SHORT_READ : BUS_NACK;
+		recordRetry(attempt);
+	}
+}
+
+void LSM9DS0::recordRetry(uint8_t attempt)
+{
+#if LSM9DS0_STATS
+	stats.retries++;
+#endif
+	// The first retry is immediate: most glitches are one-offs. If that
+	// failed too, the bus itself may be stuck.
+	if (attempt > 0)
+		recoverBus();
+}
+
+void LSM9DS0::setBusRetry(uint8_t retries, uint16_t timeoutUs)
+{
+	busRetries = retries;
+	busTimeoutUs = timeoutUs;
+#if LSM9DS0_USE_I2C && defined(WIRE_HAS_TIMEOUT)
 	if (interfaceMode == MODE_I2C)
-		I2CreadBytes(xmAddress, subAddress, dest, count);
-	else if (interfaceMode == MODE_SPI)
-		SPIreadBytes(xmAddress, subAddress, dest, count);
+		Wire.setWireTimeout(busTimeoutUs, true);
+#endif
+}
+
+void LSM9DS0::recoverBus()
+{
+#if LSM9DS0_USE_I2C
+	if (interfaceMode != MODE_I2C)
+		return;
+#if LSM9DS0_STATS
+	stats.recoveries++;
+#endif
+#if defined(SDA) && defined(SCL)
+	// A slave that lost clocks mid-byte holds SDA low, waiting for the rest
+	// of them. Clock SCL (at ~100 kHz) until it lets go, then send a STOP.
+	Wire.end();
+	pinMode(SDA, INPUT_PULLUP);
+	pinMode(SCL, INPUT_PULLUP);
+	for (uint8_t i = 0; i < 9 && !digitalRead(SDA); i++)
+	{
+		pinMode(SCL, OUTPUT);
+		digitalWrite(SCL, LOW);
+		delayMicroseconds(5);
+		pinMode(SCL, INPUT_PULLUP);
+		delayMicroseconds(5);
+	}
+	pinMode(SDA, OUTPUT); // STOP: SDA rises while SCL is high
+	digitalWrite(SDA, LOW);
+	delayMicroseconds(5);
+	pinMode(SDA, INPUT_PULLUP);
+	delayMicroseconds(5);
+#endif
+	initI2C();
+#endif
+}
+
+#if LSM9DS0_STATS
+void LSM9DS0::recordTransfer(bool write, uint8_t count, uint8_t done,
+							 unsigned long start)
+{
+	uint32_t us = micros() - start;
+	if (write)
+	{
+		stats.writes++;
+		stats.writeBytes += done;
+	}
+	else
+	{
+		stats.reads++;
+		stats.readBytes += done;
+	}
+	if (!done && count)
+		stats.nacks++;
+	else if (done < count)
+		stats.shortReads++;
+	
+	stats.totalUs += us;
+	if (us < stats.minUs)
+		stats.minUs = us;
+	if (us > stats.maxUs)
+		stats.maxUs = us;
+	uint8_t bucket = 0;
+	while (us > 1 && bucket < LSM9DS0_STATS_BUCKETS - 1)
+	{
+		us >>= 1;
+		bucket++;
+	}
+	stats.hist[bucket]++;
+}
+
+void LSM9DS0::recordStatus(bool gyro, uint8_t subAddress, uint8_t value)
+{
+	// FIFO_SRC_REG(_G) bit 6 is OVRN; STATUS_REG_G/A/M bit 7 is ZYXOR.
+	if (gyro)
+	{
+		if (subAddress == FIFO_SRC_REG_G && (value & 0x40))
+			stats.gOverruns++;
+		else if (subAddress == STATUS_REG_G && (value & 0x80))
+			stats.gMissed++;
+	}
+	else
+	{
+		if (subAddress == FIFO_SRC_REG && (value & 0x40))
+			stats.aOverruns++;
+		else if (subAddress == STATUS_REG_A && (value & 0x80))
+			stats.aMissed++;
+		else if (subAddress == STATUS_REG_M && (value & 0x80))
+			stats.mMissed++;
+	}
+}
+#endif
+
+bool LSM9DS0::getStats(LSM9DS0_stats & out)
+{
+#if LSM9DS0_STATS
+	out = stats;
+	if (!out.reads && !out.writes)
+		out.minUs = 0;
+#else
+	memset(&out, 0, sizeof(out));
+#endif
+	out.version = LSM9DS0_STATS_VERSION;
+	out.enabled = LSM9DS0_STATS;
+	out.check = checksum(&out, offsetof(LSM9DS0_stats, check));
+	return LSM9DS0_STATS;
+}
+
+void LSM9DS0::resetStats()
+{
+#if LSM9DS0_STATS
+	memset(&stats, 0, sizeof(stats));
+	stats.minUs = 0xFFFFFFFF;
+#endif
+}
+
+#if LSM9DS0_USE_SPI
+void LSM9DS0::setSPIClock(uint32_t hz)
+{
+	if (hz > LSM9DS0_SPI_MAX_HZ)
+		hz = LSM9DS0_SPI_MAX_HZ;
+	spiClock = hz;
+	// Data is read and written MSb first. Data is captured on the rising
+	// edge of the clock (CPHA = 1), whose base value is HIGH (CPOL = 1).
+	// Without SPI transactions, initSPI() applies the clock at begin().
+#ifdef SPI_HAS_TRANSACTION
+	spiSettings = SPISettings(spiClock, MSBFIRST, SPI_MODE3);
+#endif
 }
 
 void LSM9DS0::initSPI()
@@ -587,42 +1833,97 @@ void LSM9DS0::initSPI()
 	digitalWrite(gAddress, HIGH);
 	pinMode(xmAddress, OUTPUT);
 	digitalWrite(xmAddress, HIGH);
+#ifdef __AVR__
+	gCsPort = portOutputRegister(digitalPinToPort(gAddress));
+	gCsMask = digitalPinToBitMask(gAddress);
+	xmCsPort = portOutputRegister(digitalPinToPort(xmAddress));
+	xmCsMask = digitalPinToBitMask(xmAddress);
+#endif
 	
 	SPI.begin();
-	// Maximum SPI frequency is 10MHz, could divide by 2 here:
-	SPI.setClockDivider(SPI_CLOCK_DIV4);
-	// Data is read and written MSb first.
+#ifndef SPI_HAS_TRANSACTION
+	// No transactions: set the bus up once, with the fastest divider that
+	// doesn't exceed spiClock.
+	static const uint8_t dividers[] = {SPI_CLOCK_DIV2, SPI_CLOCK_DIV4,
+		SPI_CLOCK_DIV8, SPI_CLOCK_DIV16, SPI_CLOCK_DIV32, SPI_CLOCK_DIV64};
+	uint8_t i = 0;
+	while (i < sizeof(dividers) && (F_CPU >> (i + 1)) > spiClock)
+		i++;
+	SPI.setClockDivider(i < sizeof(dividers) ? dividers[i] : SPI_CLOCK_DIV128);
 	SPI.setBitOrder(MSBFIRST);
-	// Data is captured on rising edge of clock (CPHA = 0)
-	// Base value of the clock is HIGH (CPOL = 1)
-	SPI.setDataMode(SPI_MODE1);
+	SPI.setDataMode(SPI_MODE3);
+#endif
+}
+
+void LSM9DS0::spiSelect(uint8_t csPin, uint8_t level)
+{
+#ifdef __AVR__
+	volatile uint8_t * port = (csPin == gAddress) ? gCsPort : xmCsPort;
+	uint8_t mask = (csPin == gAddress) ? gCsMask : xmCsMask;
+	// The port may be outside the SBI/CBI range, making this a
+	// read-modify-write an interrupt could tear.
+	uint8_t oldSREG = SREG;
+	cli();
+	if (level == LOW)
+		*port &= ~mask;
+	else
+		*port |= mask;
+	SREG = oldSREG;
+#else
+	digitalWrite(csPin, level);
+#endif
+}
+
+void LSM9DS0::spiBegin(uint8_t csPin)
+{
+#ifdef SPI_HAS_TRANSACTION
+	SPI.beginTransaction(spiSettings);
+#endif
+	spiSelect(csPin, LOW); // Initiate communication
+}
+
+void LSM9DS0::spiEnd(uint8_t csPin)
+{
+	spiSelect(csPin, HIGH); // Close communication
+#ifdef SPI_HAS_TRANSACTION
+	SPI.endTransaction();
+#endif
 }
 
 void LSM9DS0::SPIwriteByte(uint8_t csPin, uint8_t subAddress, uint8_t data)
 {
-	digitalWrite(csPin, LOW); // Initiate communication
+	spiBegin(csPin);
 	
 	// If write, bit 0 (MSB) should be 0
 	// If single write, bit 1 should be 0
 	SPI.transfer(subAddress & 0x3F); // Send Address
 	SPI.transfer(data); // Send data
 	
-	digitalWrite(csPin, HIGH); // Close communication
+	spiEnd(csPin);
 }
 
-uint8_t LSM9DS0::SPIreadByte(uint8_t csPin, uint8_t subAddress)
+void LSM9DS0::SPIwriteBytes(uint8_t csPin, uint8_t subAddress,
+							const uint8_t * src, uint8_t count)
 {
-	uint8_t temp;
-	// Use the multiple read function to read 1 byte. 
-	// Value is returned to `temp`.
-	SPIreadBytes(csPin, subAddress, &temp, 1);
-	return temp;
+	spiBegin(csPin);
+	
+	// If write, bit 0 (MSB) should be 0
+	// If multiple write, bit 1 should be 1 to auto-increment the address
+	SPI.transfer(0x40 | (subAddress & 0x3F)); // Send Address
+	// Register writes are few and short, and a block transfer would
+	// overwrite src; send them a byte at a time.
+	for (int i=0; i<count; i++)
+	{
+		SPI.transfer(src[i]); // Send data
+	}
+	
+	spiEnd(csPin);
 }
 
 void LSM9DS0::SPIreadBytes(uint8_t csPin, uint8_t subAddress,
 							uint8_t * dest, uint8_t count)
 {
-	digitalWrite(csPin, LOW); // Initiate communication
+	spiBegin(csPin);
 	// To indicate a read, set bit 0 (msb) to 1
 	// If we're reading multiple bytes, set bit 1 to 1
 	// The remaining six bytes are the address to be read
@@ -630,48 +1931,111 @@ void LSM9DS0::SPIreadBytes(uint8_t csPin, uint8_t subAddress,
 		SPI.transfer(0xC0 | (subAddress & 0x3F));
 	else
 		SPI.transfer(0x80 | (subAddress & 0x3F));
-	for (int i=0; i<count; i++)
-	{
-		dest[i] = SPI.transfer(0x00); // Read into destination array
-	}
-	digitalWrite(csPin, HIGH); // Close communication
+	// Clock the data in with one block transfer, which sends dest's
+	// contents (zeros) out as it reads.
+	memset(dest, 0, count);
+	SPI.transfer(dest, count);
+	spiEnd(csPin);
 }
+#endif
 
+#if LSM9DS0_USE_I2C
 void LSM9DS0::initI2C()
 {
 	Wire.begin();	// Initialize I2C library
+#if ARDUINO >= 10600
+	// After begin(), which resets the clock to its default.
+	if (i2cClock)
+		Wire.setClock(i2cClock);
+#endif
+#ifdef WIRE_HAS_TIMEOUT
+	// Never let a stuck bus hang us; Wire resets itself on a timeout.
+	Wire.setWireTimeout(busTimeoutUs, true);
+#endif
+}
+
+void LSM9DS0::setI2CClock(uint32_t hz)
+{
+	i2cClock = hz;
+#if ARDUINO >= 10600
+	if (interfaceMode == MODE_I2C)
+		Wire.setClock(i2cClock);
+#endif
 }
 
 // Wire.h read and write protocols
-void LSM9DS0::I2CwriteByte(uint8_t address, uint8_t subAddress, uint8_t data)
+uint8_t LSM9DS0::I2CwriteByte(uint8_t address, uint8_t subAddress, uint8_t data)
 {
 	Wire.beginTransmission(address);  // Initialize the Tx buffer
 	Wire.write(subAddress);           // Put slave register address in Tx buffer
 	Wire.write(data);                 // Put data in Tx buffer
-	Wire.endTransmission();           // Send the Tx buffer
+	return Wire.endTransmission();    // Send the Tx buffer
 }
 
-uint8_t LSM9DS0::I2CreadByte(uint8_t address, uint8_t subAddress)
+uint8_t LSM9DS0::I2CwriteBytes(uint8_t address, uint8_t subAddress,
+							   const uint8_t * src, uint8_t count)
 {
-	uint8_t data; // `data` will store the register data	 
-	Wire.beginTransmission(address);         // Initialize the Tx buffer
-	Wire.write(subAddress);	                 // Put slave register address in Tx buffer
-	Wire.endTransmission(false);             // Send the Tx buffer, but send a restart to keep connection alive
-	Wire.requestFrom(address, (uint8_t) 1);  // Read one byte from slave register address 
-	data = Wire.read();                      // Fill Rx buffer with result
-	return data;                             // Return data read from slave register
+	// Each transaction carries the sub-address, then as much data as fits.
+	uint8_t done = 0;
+	do
+	{
+		uint8_t n = count - done;
+		if (n > LSM9DS0_WIRE_BUFFER - 1)
+			n = LSM9DS0_WIRE_BUFFER - 1;
+		Wire.beginTransmission(address);  // Initialize the Tx buffer
+		// OR the register address with 0x80 to auto-increment it.
+		Wire.write((subAddress + done) | 0x80); // Put slave register address in Tx buffer
+		for (int i=0; i<n; i++)
+		{
+			Wire.write(src[done + i]);    // Put data in Tx buffer
+		}
+		uint8_t status = Wire.endTransmission(); // Send the Tx buffer
+		if (status != 0)
+			return status;
+		done += n;
+	} while (done < count);
+	return 0;
 }
 
-void LSM9DS0::I2CreadBytes(uint8_t address, uint8_t subAddress, uint8_t * dest, uint8_t count)
-{  
+uint8_t LSM9DS0::I2CwriteRead(uint8_t address, uint8_t subAddress, uint8_t * dest,
+							  uint8_t count)
+{
 	Wire.beginTransmission(address);   // Initialize the Tx buffer
 	// Next send the register to be read. OR with 0x80 to indicate multi-read.
 	Wire.write(subAddress | 0x80);     // Put slave register address in Tx buffer
-	Wire.endTransmission(false);       // Send the Tx buffer, but send a restart to keep connection alive
+	// Send the Tx buffer, but send a restart to keep connection alive
+	if (Wire.endTransmission(false) != 0)
+		return 0;
 	uint8_t i = 0;
 	Wire.requestFrom(address, count);  // Read bytes from slave register address 
-	while (Wire.available()) 
+	while (Wire.available() && i < count) 
 	{
 		dest[i++] = Wire.read(); // Put read results in the Rx buffer
 	}
+	return i;
 }
+
+uint8_t LSM9DS0::I2CreadBytes(uint8_t address, uint8_t subAddress, uint8_t * dest,
+							  uint8_t count, bool fifo)
+{
+	// A FIFO's address wraps from OUT_Z_H back to OUT_X_L, so its chunks
+	// hold whole samples and each starts at subAddress again. Other reads
+	// pick up where the last chunk ended.
+	uint8_t chunk = LSM9DS0_WIRE_BUFFER;
+	if (fifo)
+		chunk -= chunk % 6;
+	uint8_t done = 0;
+	while (done < count)
+	{
+		uint8_t n = count - done;
+		if (n > chunk)
+			n = chunk;
+		uint8_t got = I2CwriteRead(address, fifo ? subAddress : subAddress + done,
+								   dest + done, n);
+		done += got;
+		if (got < n)
+			break;
+	}
+	return done;
+}
+#endif
@@ -29,6 +29,22 @@ Distributed as-is; no warranty is given.
   #include "pins_arduino.h"
 #endif
 
+#include "SFE_LSM9DS0_Config.h"
+#if LSM9DS0_USE_SPI
+#include <SPI.h>
+#endif
+#include "SFE_LSM9DS0_Frame.h"
+
+// LSM9DS0_SPI_MAX_HZ is the fastest SPI clock the LSM9DS0 supports, and the
+// default for setSPIClock().
+#define LSM9DS0_SPI_MAX_HZ	10000000
+
+// I2C clocks for setI2CClock(). The LSM9DS0 is rated for Standard and Fast
+// mode; Fast-mode Plus runs it out of spec, so check the bus with it first.
+#define LSM9DS0_I2C_STANDARD	100000
+#define LSM9DS0_I2C_FAST		400000
+#define LSM9DS0_I2C_FAST_PLUS	1000000
+
 ////////////////////////////
 // LSM9DS0 Gyro Registers //
 ////////////////////////////
@@ -118,6 +134,8 @@ Distributed as-is; no warranty is given.
 #define ACT_THS				0x3E
 #define ACT_DUR				0x3F
 
+struct LSM9DS0_reg_write; // SFE_LSM9DS0_Registers.h
+
 // The LSM9DS0 functions over both I2C or SPI. This library supports both.
 // But the interface mode used must be sent to the LSM9DS0 constructor. Use
 // one of these two as the first parameter of the constructor.
@@ -127,6 +145,113 @@ enum interface_mode
 	MODE_I2C,
 };
 
+// LSM9DS0_accel_cal holds the result of a multi-pose accelerometer
+// calibration (see SFE_LSM9DS0_AccelCal.h). A corrected reading, in g's, is
+//	a = M * (aRes * raw - offset)
+// where M is upper-triangular: scale[] on the diagonal, cross[] above it.
+// The struct is plain data with no padding, so it can be copied straight
+// into EEPROM (or a file) and handed back to setAccelCal() on the next boot.
+#define LSM9DS0_ACCEL_CAL_VERSION	1
+#define LSM9DS0_CAL_CROSS_AXIS		0x01 // flags: cross[] terms were fit
+struct LSM9DS0_accel_cal
+{
+	float offset[3];	// Zero-g offset of each axis, in g's
+	float scale[3];		// Diagonal of M: x, y, z scale factors
+	float cross[3];		// Upper triangle of M: xy, xz, yz terms
+	uint8_t version;	// LSM9DS0_ACCEL_CAL_VERSION
+	uint8_t flags;		// LSM9DS0_CAL_CROSS_AXIS, if cross[] is in use
+	uint16_t check;		// LSM9DS0::checksum() of all preceding bytes
+};
+
+// LSM9DS0_profile is a snapshot of everything begin() and calibration set
+// up: the control register images, biases, the accelerometer calibration,
+// and the mag hard-iron offsets (OFFSET_X_L_M..OFFSET_Z_H_M, stored in the
+// first six bytes of xmCtrl). It also holds the HPF references and the
+// interrupt, click, and activity setup. That's every writable register but
+// the self-test state, which selfTest() restores itself. Fill one with
+// getProfile(), save it with saveLSM9DS0Profile() (SFE_LSM9DS0_Storage.h),
+// and pass it to begin() on the next boot to skip both register setup and
+// calibration.
+// The part has no serial number, so a profile can't tell which board it
+// came from. Don't move one between boards.
+#define LSM9DS0_PROFILE_VERSION		3
+#define LSM9DS0_PROFILE_ACCEL_CAL	0x01 // flags: aCal is in use
+struct LSM9DS0_profile
+{
+	float gbias[3];			// Gyro biases, in DPS
+	float abias[3];			// Accel biases, in g's
+	LSM9DS0_accel_cal aCal;	// Valid if flags has LSM9DS0_PROFILE_ACCEL_CAL
+	uint8_t gCtrl[6];		// CTRL_REG1_G through REFERENCE_G
+	uint8_t gIntCfg;		// INT1_CFG_G
+	uint8_t gInt[7];		// INT1_THS_XH_G through INT1_DURATION_G (not
+							// INT1_SRC_G, which is read-only)
+	uint8_t xmCtrl[17];		// OFFSET_X_L_M through CTRL_REG7_XM
+	uint8_t intCtrlM;		// INT_CTRL_REG_M
+	uint8_t intThsM[2];		// INT_THS_L_M, INT_THS_H_M
+	// The XM interrupt and click blocks, split around the read-only
+	// INT_GEN_1_SRC, INT_GEN_2_SRC, and CLICK_SRC:
+	uint8_t intGen1Cfg;		// INT_GEN_1_REG
+	uint8_t intGen1[3];		// INT_GEN_1_THS through INT_GEN_2_REG
+	uint8_t intGen2[3];		// INT_GEN_2_THS through CLICK_CFG
+	uint8_t click[6];		// CLICK_THS through ACT_DUR
+	uint8_t gFifoCtrl;		// FIFO_CTRL_REG_G
+	uint8_t xmFifoCtrl;		// FIFO_CTRL_REG
+	uint8_t flags;			// LSM9DS0_PROFILE_* flags
+	uint8_t version;		// LSM9DS0_PROFILE_VERSION
+	uint8_t reserved;		// 0; keeps whoAmI aligned without padding
+	uint16_t whoAmI;		// begin()'s return value: the part type, not
+							// the board
+	uint16_t check;			// LSM9DS0::checksum() of all preceding bytes
+};
+
+// LSM9DS0_self_test holds the result of selfTest(). Deltas are the change in
+// output with the self-test actuation on, averaged over a FIFO's worth of
+// samples. Each pass mask has bit 0 set for x, bit 1 for y, bit 2 for z.
+#define LSM9DS0_ST_ALL_AXES	0x07
+struct LSM9DS0_self_test
+{
+	float gDelta[3];	// Gyro output change, in DPS
+	float aDelta[3];	// Accel output change, in g's
+	float gMin, gMax;	// Gyro limits used, in DPS (depend on gScale)
+	float aMin, aMax;	// Accel limits used, in g's
+	uint8_t gPass;		// Axes whose |gDelta| is within [gMin, gMax]
+	uint8_t aPass;		// Axes whose |aDelta| is within [aMin, aMax]
+	uint16_t ms;		// How long the whole test took
+};
+
+// begin()'s return value when both the gyro (0xD4) and the accel/mag (0x49)
+// answer with the right WHO_AM_I.
+#define LSM9DS0_WHO_AM_I	0x49D4
+
+// LSM9DS0_stats holds the bus instrumentation enabled by LSM9DS0_STATS.
+// Like the profile, it's plain data with no padding, so it doubles as a
+// compact binary record: write it out as-is (e.g. Serial.write((uint8_t *)
+// &stats, sizeof(stats))) and decode it elsewhere. Status flags are counted
+// whenever the library (e.g. readFrame()) reads the register holding them.
+#define LSM9DS0_STATS_VERSION	2
+#define LSM9DS0_STATS_BUCKETS	12
+struct LSM9DS0_stats
+{
+	uint32_t reads, writes;			// Register accesses (a long I2C access
+									// may take several transactions)
+	uint32_t readBytes, writeBytes;	// Data bytes, not counting sub-addresses
+	uint32_t nacks;			// Transactions not acknowledged (I2C)
+	uint32_t shortReads;	// Reads that got fewer bytes than asked (I2C)
+	uint32_t gOverruns, aOverruns;	// FIFO_SRC reads with OVRN set
+	uint32_t gMissed, aMissed, mMissed;	// STATUS reads with ZYXOR set:
+										// a sample replaced before being read
+	uint32_t retries;		// Transactions repeated after a failure
+	uint32_t recoveries;	// Bus recovery sequences run
+	uint32_t totalUs;		// Time spent in transactions
+	uint32_t minUs, maxUs;	// Shortest and longest transaction
+	uint32_t hist[LSM9DS0_STATS_BUCKETS];	// Transactions by duration: bucket
+								// k counts [2^k, 2^(k+1)) us, bucket 0 also
+								// 0 us, and the last everything longer.
+	uint8_t version;		// LSM9DS0_STATS_VERSION
+	uint8_t enabled;		// LSM9DS0_STATS, as compiled
+	uint16_t check;			// LSM9DS0::checksum() of all preceding bytes
+};
+
 class LSM9DS0
 {
 public:
@@ -198,6 +323,71 @@ public:
 		A_ABW_50,		//  50 Hz (0x3)
 	};
 
+	// gyro_hpf_mode defines the gyro high-pass filter modes (HPM[1:0]):
+	enum gyro_hpf_mode
+	{
+		G_HPF_NORMAL_RESET,	// 00: Normal, reset by reading REFERENCE_G
+		G_HPF_REFERENCE,	// 01: Reference signal for filtering
+		G_HPF_NORMAL,		// 10: Normal mode
+		G_HPF_AUTORESET,	// 11: Autoreset on interrupt event
+	};
+
+	// gyro_path selects which filters feed the gyro output registers/FIFO
+	// (Out_Sel[1:0]) or the INT1 generator (INT1_Sel[1:0]):
+	enum gyro_path
+	{
+		G_PATH_LPF1,		// 00: LPF1 only (HPF bypassed)
+		G_PATH_HPF,			// 01: LPF1, then HPF
+		G_PATH_HPF_LPF2,	// 10: LPF1, HPF, then LPF2 (the ODR bandwidth)
+	};
+
+	// accel_hpf_mode defines the accel high-pass filter modes (AHPM[1:0]):
+	enum accel_hpf_mode
+	{
+		A_HPF_NORMAL_RESET,	// 00: Normal, reset by reading REFERENCE_X/Y/Z
+		A_HPF_REFERENCE,	// 01: Reference signal for filtering
+		A_HPF_NORMAL,		// 10: Normal mode
+		A_HPF_AUTORESET,	// 11: Autoreset on interrupt event
+	};
+
+	// accel_hpf_route flags select what the accel high-pass filter feeds.
+	// OR them together; anything not listed gets unfiltered data.
+	enum accel_hpf_route
+	{
+		A_HPF_DATA	= 0x01,	// Output registers and FIFO (AFDS)
+		A_HPF_CLICK	= 0x02,	// Click detection (HP_CLICK)
+		A_HPF_INT1	= 0x04,	// Interrupt generator 1 (HPIS1)
+		A_HPF_INT2	= 0x08,	// Interrupt generator 2 (HPIS2)
+	};
+
+	// fifo_mode defines the FIFO modes of both the gyro and accel (FM[2:0]):
+	enum fifo_mode
+	{
+		FIFO_BYPASS,			// 000: FIFO off, output registers only
+		FIFO_MODE,				// 001: Collect samples, stop when full
+		FIFO_STREAM,			// 010: Collect samples, overwrite oldest
+		FIFO_STREAM_TO_FIFO,	// 011: Stream until interrupt, then FIFO
+		FIFO_BYPASS_TO_STREAM,	// 100: Bypass until interrupt, then stream
+	};
+	
+	// bus_status is the outcome of a register read or write, after retries.
+	enum bus_status
+	{
+		BUS_OK,			// Every byte transferred
+		BUS_NACK,		// The device didn't answer; nothing transferred
+		BUS_SHORT_READ,	// Only some of the bytes arrived
+		BUS_ERROR,		// Any other failure, including a bus timeout
+	};
+	
+	// valid_flags, in the valid member, say which readings are fresh.
+	enum valid_flags
+	{
+		VALID_G		= 0x01,	// gx, gy, gz
+		VALID_A		= 0x02,	// ax, ay, az
+		VALID_M		= 0x04,	// mx, my, mz
+		VALID_TEMP	= 0x08,	// temperature
+	};
+
 
 	// mag_oder defines all possible output data rates of the magnetometer:
 	enum mag_odr
@@ -218,9 +408,16 @@ public:
 	int16_t gx, gy, gz; // x, y, and z axis readings of the gyroscope
 	int16_t ax, ay, az; // x, y, and z axis readings of the accelerometer
 	int16_t mx, my, mz; // x, y, and z axis readings of the magnetometer
+#if LSM9DS0_USE_TEMP
         int16_t temperature;
+#endif
+#if LSM9DS0_USE_CAL
 	float abias[3];
         float gbias[3];
+#endif
+	// valid has a valid_flags bit set for each reading whose last read
+	// succeeded. A failed read clears the bit and leaves the old values.
+	uint8_t valid;
 
 	// LSM9DS0 -- LSM9DS0 class constructor
 	// The constructor will set up a handful of private variables, and set the
@@ -247,6 +444,8 @@ public:
 	// Output: The function will return an unsigned 16-bit value. The most-sig
 	//		bytes of the output are the WHO_AM_I reading of the accel. The
 	//		least significant two bytes are the WHO_AM_I reading of the gyro.
+	//		Unless it's LSM9DS0_WHO_AM_I, nothing is configured: whatever
+	//		answered isn't an LSM9DS0.
 	// All parameters have a defaulted value, so you can call just "begin()".
 	// Default values are FSR's of:  245DPS, 2g, 2Gs; ODRs of 95 Hz for 
 	// gyro, 100 Hz for accelerometer, 100 Hz for magnetometer.
@@ -256,30 +455,67 @@ public:
 				gyro_odr gODR = G_ODR_95_BW_125, accel_odr aODR = A_ODR_50, 
 				mag_odr mODR = M_ODR_50);
 	
+	// begin() -- Initialize the LSM9DS0 from a saved profile.
+	// This restores every register in a handful of burst writes, along with
+	// the biases and calibration, so neither the register-by-register setup
+	// nor calLSM9DS0() needs to run.
+	// Input:
+	//	- profile = A profile filled by getProfile(), e.g. loaded with
+	//		loadLSM9DS0Profile().
+	// Output: The WHO_AM_I value, as with the other begin(), if the profile
+	//	was applied. 0 if its version or checksum is bad, or if the part
+	//	answering doesn't have the WHO_AM_I values it was taken on. Nothing
+	//	but the bus is touched in that case, so fall back to begin() and
+	//	calibrate. Any LSM9DS0 passes the WHO_AM_I check, so a profile from
+	//	another board is applied all the same.
+	uint16_t begin(const LSM9DS0_profile & profile);
+	
+	// getProfile() -- Snapshot the current configuration into a profile.
+	// Call it after begin(), any set* functions, and calibration. The
+	// member abias and gbias arrays are what get saved. It reads the HPF
+	// reference registers, which resets a filter in normal-reset mode (see
+	// resetGyroHPF()).
+	// Input:
+	//	- profile = Where the snapshot will be stored.
+	void getProfile(LSM9DS0_profile & profile);
+	
+	// setMagOffset() -- Set the magnetometer's hard-iron offset registers.
+	// The LSM9DS0 subtracts these from every mag reading in hardware.
+	// Input:
+	//	- x, y, z = Offsets in raw mag ADC ticks.
+	void setMagOffset(int16_t x, int16_t y, int16_t z);
+	
 	// readGyro() -- Read the gyroscope output registers.
 	// This function will read all six gyroscope output registers.
 	// The readings are stored in the class' gx, gy, and gz variables. Read
 	// those _after_ calling readGyro().
-	void readGyro();
+	// Output: true if the read succeeded (see valid).
+	bool readGyro();
 	
 	// readAccel() -- Read the accelerometer output registers.
 	// This function will read all six accelerometer output registers.
 	// The readings are stored in the class' ax, ay, and az variables. Read
 	// those _after_ calling readAccel().
-	void readAccel();
+	// Output: true if the read succeeded (see valid).
+	bool readAccel();
 	
 	// readMag() -- Read the magnetometer output registers.
 	// This function will read all six magnetometer output registers.
 	// The readings are stored in the class' mx, my, and mz variables. Read
 	// those _after_ calling readMag().
-	void readMag();
+	// Output: true if the read succeeded (see valid).
+	bool readMag();
 
 	// readTemp() -- Read the temperature output register.
 	// This function will read two temperature output registers.
 	// The combined readings are stored in the class' temperature variables. Read
 	// those _after_ calling readTemp().
-	void readTemp();
+	// Output: true if the read succeeded (see valid).
+#if LSM9DS0_USE_TEMP
+	bool readTemp();
+#endif
 	
+#if LSM9DS0_USE_FLOAT
 	// calcGyro() -- Convert from RAW signed 16-bit value to degrees per second
 	// This function reads in a signed 16-bit value and returns the scaled
 	// DPS. This function relies on gScale and gRes being correct.
@@ -300,14 +536,28 @@ public:
 	// Input:
 	//	- mag = A signed 16-bit raw reading from the magnetometer.
 	float calcMag(int16_t mag);
+#endif
 	
 	// setGyroScale() -- Set the full-scale range of the gyroscope.
 	// This function can be called to set the scale of the gyroscope to 
 	// 245, 500, or 200 degrees per second.
+	// It can be called while samples stream: this and the other scale and
+	// ODR setters start a new epoch for the sensor, without flushing or
+	// pausing anything.
+	//	- Samples still in the FIFO from before keep the old resolution
+	//	  and ODR: readFrame() ends a frame where they do, and labels each
+	//	  frame's samples with the epoch and res they were taken under.
+	//	- gx, gy, gz (and ax..., mx...) are converted to the new scale, and
+	//	  the next readGyro() keeps them until the sensor has a sample
+	//	  taken under it.
+	// A sample landing during the register write itself can still get
+	// either label.
 	// Input:
 	// 	- gScl = The desired gyroscope scale. Must be one of three possible
 	//		values from the gyro_scale enum.
-	void setGyroScale(gyro_scale gScl);
+	// Output: false if the bus failed. A failed read leaves the register
+	//	(and the library's scale) as it was.
+	bool setGyroScale(gyro_scale gScl);
 	
 	// setAccelScale() -- Set the full-scale range of the accelerometer.
 	// This function can be called to set the scale of the accelerometer to
@@ -315,7 +565,8 @@ public:
 	// Input:
 	// 	- aScl = The desired accelerometer scale. Must be one of five possible
 	//		values from the accel_scale enum.
-	void setAccelScale(accel_scale aScl);
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setAccelScale(accel_scale aScl);
 	
 	// setMagScale() -- Set the full-scale range of the magnetometer.
 	// This function can be called to set the scale of the magnetometer to
@@ -323,25 +574,29 @@ public:
 	// Input:
 	// 	- mScl = The desired magnetometer scale. Must be one of four possible
 	//		values from the mag_scale enum.
-	void setMagScale(mag_scale mScl);
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setMagScale(mag_scale mScl);
 	
 	// setGyroODR() -- Set the output data rate and bandwidth of the gyroscope
 	// Input:
 	//	- gRate = The desired output rate and cutoff frequency of the gyro.
 	//		Must be a value from the gyro_odr enum (check above, there're 14).
-	void setGyroODR(gyro_odr gRate);
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setGyroODR(gyro_odr gRate);
 	
 	// setAccelODR() -- Set the output data rate of the accelerometer
 	// Input:
 	//	- aRate = The desired output rate of the accel.
 	//		Must be a value from the accel_odr enum (check above, there're 11).
-	void setAccelODR(accel_odr aRate); 	
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setAccelODR(accel_odr aRate); 	
 
         // setAccelABW() -- Set the anti-aliasing filter rate of the accelerometer
 	// Input:
 	//	- abwRate = The desired anti-aliasing filter rate of the accel.
 	//		Must be a value from the accel_abw enum (check above, there're 4).
-	void setAccelABW(accel_abw abwRate);
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setAccelABW(accel_abw abwRate);
 
 
 	
@@ -349,7 +604,67 @@ public:
 	// Input:
 	//	- mRate = The desired output rate of the mag.
 	//		Must be a value from the mag_odr enum (check above, there're 6).
-	void setMagODR(mag_odr mRate);
+	// Output: false if the bus failed, as for setGyroScale().
+	bool setMagODR(mag_odr mRate);
+	
+#if LSM9DS0_USE_FLOAT
+	// setGyroHPF() -- Set up the gyro's on-chip high-pass filter.
+	// The filter removes drift (and, in reference mode, a fixed rate) from
+	// the gyro data before it reaches the output registers and FIFO, so
+	// there's no need to filter every sample on the host.
+	// The cutoff options depend on the ODR (datasheet table 26): from
+	// 0.009-7.2 Hz at 95 Hz up to 0.09-51.4 Hz at 760 Hz. The closest one
+	// to the requested cutoff is used. The cutoff scales with the ODR, so
+	// call this again after setGyroODR().
+	// Input:
+	//	- mode = The filter mode, from the gyro_hpf_mode enum.
+	//	- cutoff = The desired cutoff frequency, in Hz.
+	//	- out = Filters feeding the output registers and FIFO.
+	//	- int1 = Filters feeding the INT1 (angular rate) interrupt generator.
+	// Output: The cutoff actually selected, in Hz. 0 if the requested
+	//	cutoff is out of range for the current ODR (nothing is changed
+	//	then), or if the bus failed.
+	float setGyroHPF(gyro_hpf_mode mode, float cutoff,
+					 gyro_path out = G_PATH_HPF, gyro_path int1 = G_PATH_LPF1);
+#endif
+	
+	// disableGyroHPF() -- Bypass the gyro high-pass filter on both paths.
+	// Output: false if the bus failed.
+	bool disableGyroHPF();
+	
+	// setGyroHPFReference() -- Set the reference the HPF subtracts in
+	// G_HPF_REFERENCE mode (REFERENCE_G).
+	// Input:
+	//	- ref = The reference, in 8-bit gyro ticks: 1 LSB is 256 raw ticks.
+	void setGyroHPFReference(int8_t ref);
+	
+	// resetGyroHPF() -- Reset the filter's state in G_HPF_NORMAL_RESET mode,
+	// e.g. after the sensor has been re-oriented. Reads REFERENCE_G.
+	void resetGyroHPF();
+	
+	// setAccelHPF() -- Set up the accelerometer's on-chip high-pass filter.
+	// With A_HPF_DATA routed, gravity and other slow offsets are removed
+	// before samples reach the output registers and FIFO, so vibration data
+	// needs no host-side filtering. The interrupt generators and click
+	// detection can be filtered independently.
+	// Input:
+	//	- mode = The filter mode, from the accel_hpf_mode enum.
+	//	- routes = accel_hpf_route flags, OR'd together. 0 bypasses the
+	//		filter everywhere.
+	// Output: false if the bus failed. Nothing is changed if it failed
+	//	reading.
+	bool setAccelHPF(accel_hpf_mode mode, uint8_t routes);
+	
+	// setAccelHPFReference() -- Set the references the HPF subtracts in
+	// A_HPF_REFERENCE mode (REFERENCE_X, REFERENCE_Y, REFERENCE_Z).
+	// Input:
+	//	- x, y, z = References, in 8-bit accel ticks: 1 LSB is 256 raw ticks.
+	void setAccelHPFReference(int8_t x, int8_t y, int8_t z);
+	
+	// resetAccelHPF() -- Reset the filter's state in A_HPF_NORMAL_RESET
+	// mode, e.g. after the sensor has been re-oriented. Reads the
+	// REFERENCE_X/Y/Z registers.
+	void resetAccelHPF();
 	
 	// configGyroInt() -- Configure the gyro interrupt output.
 	// Triggers can be set to either rising above or falling below a specified
@@ -358,20 +673,222 @@ public:
 	// Input:
 	//	- int1Cfg = A 8-bit value that is sent directly to the INT1_CFG_G
 	//		register. This sets AND/OR and high/low interrupt gen for each axis
-	//	- int1ThsX = 16-bit interrupt threshold value for x-axis
-	//	- int1ThsY = 16-bit interrupt threshold value for y-axis
-	//	- int1ThsZ = 16-bit interrupt threshold value for z-axis
-	//	- duration = Duration an interrupt holds after triggered. This value
-	// 		is copied directly into the INT1_DURATION_G register.
+	//	- int1ThsX = 15-bit interrupt threshold value for x-axis
+	//	- int1ThsY = 15-bit interrupt threshold value for y-axis
+	//	- int1ThsZ = 15-bit interrupt threshold value for z-axis
+	//	- duration = Samples (0-127) an interrupt holds after triggered.
+	//		Anything but 0 also sets WAIT in INT1_DURATION_G.
 	// Before using this function, read about the INT1_CFG_G register and
 	// the related INT1* registers in the LMS9DS0 datasheet.
 	void configGyroInt(uint8_t int1Cfg, uint16_t int1ThsX = 0,
 						  uint16_t int1ThsY = 0, uint16_t int1ThsZ = 0, 
 						  uint8_t duration = 0);
+	
+	// configAccelInt() -- Configure the accel's interrupt generator 1 and
+	// signal it on INT1_XM, in place of the accel data-ready signal begin()
+	// puts there, e.g. to wake the host only when the board moves.
+	// Input:
+	//	- cfg = Sent directly to INT_GEN_1_REG: which axes going above or
+	//		below the threshold count (LSM9DS0Reg::IntGen1Reg), and whether
+	//		they're OR'd (AOI = 0) or AND'd. 0 turns the generator off and
+	//		puts accel data ready back on INT1_XM.
+	//	- threshold = 0-127, in steps of 1/128 of the full scale (16 mg at
+	//		2 g).
+	//	- duration = 0-127 accel ODR periods the event must last.
+	//	- latch = Hold the interrupt until readAccelIntSource() (LIR1),
+	//		rather than let it follow the event.
+	// The generator compares the readings with gravity in them; to trigger
+	// on motion in any orientation, also route the high-pass filter to it
+	// with setAccelHPF(A_HPF_NORMAL, A_HPF_INT1).
+	// Output: false if the bus failed. Nothing is changed if it failed
+	//	reading.
+	bool configAccelInt(uint8_t cfg, uint8_t threshold, uint8_t duration = 0,
+						bool latch = true);
+	
+	// readAccelIntSource() -- Read INT_GEN_1_SRC, clearing a latched
+	// interrupt.
+	// Output: 0 IA ZH ZL YH YL XH XL: IA if the interrupt is active, and
+	// which of the events in configAccelInt()'s cfg caused it.
+	uint8_t readAccelIntSource();
 
-
+#if LSM9DS0_USE_CAL
         void calLSM9DS0(float gbias[3], float abias[3]);
 
+	// readAccelAverage() -- Average a burst of accelerometer samples.
+	// This function fills the accelerometer FIFO (up to 32 samples, or
+	// about one second's worth at low ODRs), averages it, and converts the
+	// result to g's. The sensor can be in any orientation. Use it to gather
+	// poses for an LSM9DS0AccelCal.
+	// Input:
+	//	- a = Array of three floats where the x, y, and z averages will go.
+	// Output: The number of samples averaged (0 if none were available).
+	uint8_t readAccelAverage(float * a);
+
+	// setAccelCal() -- Load a multi-pose accelerometer calibration.
+	// The calibration's offsets are also copied into abias, so code that
+	// subtracts abias keeps working. Call it after begin() -- in place of
+	// calLSM9DS0()'s accelerometer pass -- with a blob saved from an earlier
+	// LSM9DS0AccelCal::solve().
+	// Input:
+	//	- cal = The calibration blob to load.
+	// Output: true if the blob's version and checksum are valid.
+	bool setAccelCal(const LSM9DS0_accel_cal & cal);
+
+	// calcAccelCal() -- Convert the latest ax, ay, and az to calibrated g's.
+	// Applies the offset, scale, and cross-axis terms loaded by
+	// setAccelCal(). Without a calibration, it falls back to calcAccel()
+	// minus abias.
+	// Input:
+	//	- a = Array of three floats where x, y, and z g's will be stored.
+	void calcAccelCal(float * a);
+
+	// selfTest() -- Run the gyro and accelerometer self-tests.
+	// Each sensor is switched to its fastest ODR, and the FIFO is used to
+	// average a batch of samples with the self-test actuation off and then
+	// on. The differences are checked against the datasheet limits
+	// (Table 3): 20-250, 70-400, or 150-1000 DPS for the gyro, depending on
+	// the current scale, and 60-1700 mg for the accel (tested at +/-2g).
+	// Every register touched is restored before returning. Most of the
+	// ~90 ms the test takes is spent waiting for the FIFOs to fill.
+	// Input:
+	//	- result = Where the per-axis deltas and pass masks will be stored.
+	// Output: true if every axis of both sensors passed.
+	bool selfTest(LSM9DS0_self_test & result);
+#endif
+	
+	// setGyroFIFO() -- Set the gyro FIFO mode and watermark.
+	// The FIFO is enabled (FIFO_EN) for every mode but FIFO_BYPASS, and it
+	// always passes through bypass first, which empties it.
+	// Input:
+	//	- mode = The FIFO mode, from the fifo_mode enum.
+	//	- watermark = FIFO level (0-31) that raises the watermark flag.
+	// Output: false if the bus failed. Nothing is changed if it failed
+	//	reading.
+	bool setGyroFIFO(fifo_mode mode, uint8_t watermark = 0x1F);
+	
+	// setAccelFIFO() -- Set the accelerometer FIFO mode and watermark.
+	// Same as setGyroFIFO(), for the accelerometer.
+	bool setAccelFIFO(fifo_mode mode, uint8_t watermark = 0x1F);
+	
+	// setGyroWatermark() -- Change the gyro FIFO watermark, keeping its
+	// mode and the samples in it (unlike setGyroFIFO()).
+	// Input:
+	//	- watermark = FIFO level (0-31) that raises the watermark flag.
+	// Output: false if the bus failed. Nothing is changed if it failed
+	//	reading.
+	bool setGyroWatermark(uint8_t watermark);
+	
+	// setAccelWatermark() -- Same as setGyroWatermark(), for the
+	// accelerometer.
+	bool setAccelWatermark(uint8_t watermark);
+	
+	// setWatermarkInt() -- Signal FIFO watermarks on the interrupt pins.
+	// The gyro's goes on DRDY_G (I2_WTM) and the accel's on INT2_XM
+	// (P2_WTM), in place of the data-ready signals begin() puts there, so
+	// the pins only wake the host once per batch. The mag has no FIFO:
+	// readFrame() picks up its latest sample on every drain, so keep its
+	// ODR at or below the drain rate. Pins are left as they are for a
+	// sensor given false. See LSM9DS0Watermark for picking a watermark.
+	// Input:
+	//	- gyro = Route the gyro FIFO's watermark to DRDY_G.
+	//	- accel = Route the accel FIFO's watermark to INT2_XM.
+	// Output: false if the bus failed. A sensor whose register couldn't
+	//	be read is left as it was.
+	bool setWatermarkInt(bool gyro, bool accel);
+	
+	// readGyroFIFO() -- Burst-read the samples waiting in the gyro FIFO.
+	// Input:
+	//	- dest = Array where raw samples are stored, interleaved x, y, z.
+	//	- maxSamples = Room in dest, in samples (3 int16_t's each).
+	// Output: The number of samples read. Any beyond maxSamples are left
+	//	in the FIFO for the next call.
+	uint8_t readGyroFIFO(int16_t * dest, uint8_t maxSamples);
+	
+	// readAccelFIFO() -- Burst-read the samples waiting in the accel FIFO.
+	// Same as readGyroFIFO(), for the accelerometer.
+	uint8_t readAccelFIFO(int16_t * dest, uint8_t maxSamples);
+	
+#if LSM9DS0_USE_FRAME
+	// initFrame() -- Set up a frame's header for readFrame().
+	// Reads the output data rates from the device. Scales, ODRs, epochs,
+	// and biases are refreshed by every readFrame().
+	// Input:
+	//	- frame = The frame, e.g. in shared memory. Its generation counter
+	//		is kept, so readers already using it see it change.
+	void initFrame(LSM9DS0_frame & frame);
+	
+	// readFrame() -- Drain both FIFOs, and the mag if it has new data,
+	// straight into a frame (see SFE_LSM9DS0_Frame.h).
+	// The gyro and accel FIFOs should be in stream mode (setGyroFIFO(),
+	// setAccelFIFO()). The frame is marked as being written throughout, so
+	// readers of it never see a half-written batch. It stops at the first
+	// sample taken after a scale or ODR change, and at its capacity; the
+	// header then has LSM9DS0_FRAME_MORE set, and the rest is read by the
+	// next call.
+	// Input:
+	//	- frame = A frame set up by initFrame().
+	// Output: The number of gyro, accel, and mag samples read.
+	uint8_t readFrame(LSM9DS0_frame & frame);
+#endif
+	
+	// setBusRetry() -- Bound how long a failing register access can take.
+	// A failed transaction is repeated up to retries times; from the second
+	// retry on, recoverBus() runs first. Where Wire supports it
+	// (WIRE_HAS_TIMEOUT), every I2C transaction is also cut off after
+	// timeoutUs, so a stuck bus can't hang the caller. Worst case, one
+	// access takes (retries + 1) transactions of at most timeoutUs each,
+	// plus retries - 1 recoveries (~0.1 ms each). FIFO bursts that fail
+	// part-way are not repeated, since the samples read are gone.
+	// Input:
+	//	- retries = Extra attempts after a failure (default 2).
+	//	- timeoutUs = I2C transaction timeout, in microseconds (default 5000).
+	void setBusRetry(uint8_t retries, uint16_t timeoutUs = 5000);
+	
+#if LSM9DS0_USE_SPI
+	// setSPIClock() -- Set the SPI clock, in Hz.
+	// Every access runs in its own SPI transaction with these settings, so
+	// the LSM9DS0 can share the bus with other SPI devices. The SPI library
+	// picks the fastest clock it can make that doesn't exceed hz.
+	// Input:
+	//	- hz = Target SCK frequency, at most LSM9DS0_SPI_MAX_HZ (the
+	//	  default). Faster requests are capped. With an SPI library that
+	//	  lacks transactions, call this before begin().
+	void setSPIClock(uint32_t hz);
+#endif
+	
+#if LSM9DS0_USE_I2C
+	// setI2CClock() -- Set the I2C clock, in Hz.
+	// Takes effect right away, and again whenever Wire is restarted (e.g.
+	// by recoverBus()). Without a call, Wire's default (normally 100 kHz)
+	// is left alone. At 400 kHz, each transaction's fixed cost (start,
+	// device address, sub-address, repeated start, stop: about 30 bits)
+	// drops from ~300 us to ~75 us; lsm9ds0_i2cbench reports it per clock.
+	// Input:
+	//	- hz = LSM9DS0_I2C_STANDARD, LSM9DS0_I2C_FAST,
+	//	  LSM9DS0_I2C_FAST_PLUS, or any rate the Wire library accepts.
+	void setI2CClock(uint32_t hz);
+#endif
+	
+	// recoverBus() -- Free an I2C bus held by a slave stuck mid-byte.
+	// With the SDA and SCL pins known, clocks SCL (up to 9 pulses) until
+	// the slave lets go of SDA, sends a STOP, and restarts Wire. Elsewhere
+	// it only restarts Wire. Does nothing in SPI mode.
+	void recoverBus();
+	
+	// getStats() -- Snapshot the bus instrumentation (see LSM9DS0_stats).
+	// Input:
+	//	- stats = Where the counters are copied, with version and check set.
+	// Output: false if the library was built without LSM9DS0_STATS (stats
+	//	is then all zeros, apart from version and check).
+	bool getStats(LSM9DS0_stats & stats);
+	
+	// resetStats() -- Zero the bus instrumentation.
+	void resetStats();
+	
+	// checksum() -- Fletcher-16 checksum over a block of bytes.
+	// Used to validate calibration blobs loaded from non-volatile memory.
+	static uint16_t checksum(const void * data, uint16_t count);
+
 
 private:	
 	// xmAddress and gAddress store the I2C address or SPI chip select pin
@@ -389,11 +906,94 @@ private:
 	// gRes, aRes, and mRes store the current resolution for each sensor. 
 	// Units of these values would be DPS (or g's or Gs's) per ADC tick.
 	// This value is calculated as (sensor scale) / (2^15).
+#if LSM9DS0_USE_FLOAT
 	float gRes, aRes, mRes;
+#endif
+	
+	// stale has a valid_flags bit set for each sensor whose output
+	// registers may still hold a sample from before its last change.
+	uint8_t stale;
+	
+#if LSM9DS0_USE_FRAME
+	// epoch and odr are the current configuration's number and output data
+	// rate (in eighths of a Hz), for the gyro, accel, and mag.
+	uint8_t epoch[3];
+	uint16_t odr[3];
+	
+	// fifo_run -- Samples in a FIFO taken under an earlier configuration.
+	struct fifo_run
+	{
+		uint16_t odr;
+		uint8_t scale, epoch;
+		uint8_t count;		// Samples of it still in the FIFO
+	};
+	// fifo_epochs -- A FIFO's queue of earlier configurations, oldest
+	// first. Samples beyond them are under the current one.
+	struct fifo_epochs
+	{
+		fifo_run run[LSM9DS0_EPOCH_DEPTH];
+		uint8_t runs;
+		bool stream;			// A full FIFO drops its oldest sample
+		unsigned long changed;	// micros() at the last change
+	};
+	fifo_epochs fifoEpochs[2];	// Gyro, accel
+#endif
+
+#if LSM9DS0_USE_CAL
+	// aCal stores the calibration loaded by setAccelCal(). aCalValid is
+	// false until one has been loaded.
+	LSM9DS0_accel_cal aCal;
+	bool aCalValid;
+#endif
+	
+	// busRetries and busTimeoutUs are set by setBusRetry().
+	uint8_t busRetries;
+	uint16_t busTimeoutUs;
+	
+#if LSM9DS0_USE_SPI
+	// spiSettings holds the SPI transaction settings from setSPIClock().
+	// Without SPI transaction support, spiClock is applied once instead.
+#ifdef SPI_HAS_TRANSACTION
+	SPISettings spiSettings;
+#endif
+	uint32_t spiClock;
+#ifdef __AVR__
+	// Port registers and bit masks of the chip selects, so spiSelect()
+	// can skip digitalWrite()'s pin lookups.
+	volatile uint8_t * gCsPort, * xmCsPort;
+	uint8_t gCsMask, xmCsMask;
+#endif
+#endif
+#if LSM9DS0_USE_I2C
+	// i2cClock is set by setI2CClock(); 0 leaves Wire's default.
+	uint32_t i2cClock;
+#endif
+	
+#if LSM9DS0_STATS
+	// stats accumulates what the read/write functions below record.
+	LSM9DS0_stats stats;
+	unsigned long statsClock() { return micros(); }
+	
+	// recordTransfer() -- Count one transaction.
+	// Input:
+	//	- write = true for a write, false for a read.
+	//	- count = Bytes requested.
+	//	- done = Bytes transferred; 0 if the transaction failed.
+	//	- start = statsClock() when it began.
+	void recordTransfer(bool write, uint8_t count, uint8_t done,
+						unsigned long start);
+	
+	// recordStatus() -- Count the overrun flags in a status register read.
+	void recordStatus(bool gyro, uint8_t subAddress, uint8_t value);
+#else
+	unsigned long statsClock() { return 0; }
+	void recordTransfer(bool, uint8_t, uint8_t, unsigned long) {}
+	void recordStatus(bool, uint8_t, uint8_t) {}
+#endif
 	
 	// initGyro() -- Sets up the gyroscope to begin reading.
-	// This function steps through all five gyroscope control registers.
-	// Upon exit, the following parameters will be set:
+	// This function writes all five gyroscope control registers, from the
+	// gyroInit table in SFE_LSM9DS0.cpp:
 	//	- CTRL_REG1_G = 0x0F: Normal operation mode, all axes enabled. 
 	//		95 Hz ODR, 12.5 Hz cutoff frequency.
 	//	- CTRL_REG2_G = 0x00: HPF set to normal mode, cutoff frequency
@@ -406,31 +1006,35 @@ private:
 	void initGyro();
 	
 	// initAccel() -- Sets up the accelerometer to begin reading.
-	// This function steps through all accelerometer related control registers.
-	// Upon exit these registers will be set as:
+	// This function writes the accelerometer control registers, from the
+	// accelInit table:
 	//	- CTRL_REG0_XM = 0x00: FIFO disabled. HPF bypassed. Normal mode.
-	//	- CTRL_REG1_XM = 0x57: 100 Hz data rate. Continuous update.
+	//	- CTRL_REG1_XM = 0x57: 50 Hz data rate. Continuous update.
 	//		all axes enabled.
 	//	- CTRL_REG2_XM = 0x00:  2g scale. 773 Hz anti-alias filter BW.
 	//	- CTRL_REG3_XM = 0x04: Accel data ready signal on INT1_XM pin.
 	void initAccel();
 	
 	// initMag() -- Sets up the magnetometer to begin reading.
-	// This function steps through all magnetometer-related control registers.
-	// Upon exit these registers will be set as:
-	//	- CTRL_REG4_XM = 0x04: Mag data ready signal on INT2_XM pin.
-	//	- CTRL_REG5_XM = 0x14: 100 Hz update rate. Low resolution. Interrupt
-	//		requests don't latch. Temperature sensor disabled.
+	// This function writes the magnetometer control registers, from the
+	// magInit table:
+	//	- CTRL_REG5_XM = 0x94: 100 Hz update rate. Low resolution. Interrupt
+	//		requests don't latch. Temperature sensor enabled.
 	//	- CTRL_REG6_XM = 0x00:  2 Gs scale.
 	//	- CTRL_REG7_XM = 0x00: Continuous conversion mode. Normal HPF mode.
+	//	- CTRL_REG4_XM = 0x04: Mag data ready signal on INT2_XM pin.
 	//	- INT_CTRL_REG_M = 0x09: Interrupt active-high. Enable interrupts.
 	void initMag();
 	
+	// writeRegs() -- Write a table of register images, in order.
+	void writeRegs(const LSM9DS0_reg_write * regs, uint8_t count);
+	
 	// gReadByte() -- Reads a byte from a specified gyroscope register.
 	// Input:
 	// 	- subAddress = Register to be read from.
 	// Output:
-	// 	- An 8-bit value read from the requested address.
+	// 	- An 8-bit value read from the requested address, or 0xFF if the
+	//	read failed.
 	uint8_t gReadByte(uint8_t subAddress);
 	
 	// gReadBytes() -- Reads a number of bytes -- beginning at an address
@@ -440,21 +1044,32 @@ private:
 	// 	- * dest = A pointer to an array of uint8_t's. Values read will be
 	//		stored in here on return.
 	//	- count = The number of bytes to be read.
-	// Output: No value is returned, but the `dest` array will store
-	// 	the data read upon exit.
-	void gReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count);
+	// Output: BUS_OK if `dest` holds all count bytes read, after any
+	//	retries (see setBusRetry()).
+	bus_status gReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count);
 	
 	// gWriteByte() -- Write a byte to a register in the gyroscope.
 	// Input:
 	//	- subAddress = Register to be written to.
 	//	- data = data to be written to the register.
-	void gWriteByte(uint8_t subAddress, uint8_t data);
+	// Output: BUS_OK on success, after any retries.
+	bus_status gWriteByte(uint8_t subAddress, uint8_t data);
+	
+	// gWriteBytes() -- Write a number of bytes -- beginning at an address
+	// and incrementing from there -- to the gyroscope.
+	// Input:
+	//	- subAddress = Register to be written to first.
+	//	- * src = A pointer to the bytes to be written.
+	//	- count = The number of bytes to be written.
+	// Output: BUS_OK on success, after any retries.
+	bus_status gWriteBytes(uint8_t subAddress, const uint8_t * src, uint8_t count);
 	
 	// xmReadByte() -- Read a byte from a register in the accel/mag sensor
 	// Input:
 	//	- subAddress = Register to be read from.
 	// Output:
-	//	- An 8-bit value read from the requested register.
+	//	- An 8-bit value read from the requested register, or 0xFF if the
+	//	read failed.
 	uint8_t xmReadByte(uint8_t subAddress);
 	
 	// xmReadBytes() -- Reads a number of bytes -- beginning at an address
@@ -464,16 +1079,134 @@ private:
 	// 	- * dest = A pointer to an array of uint8_t's. Values read will be
 	//		stored in here on return.
 	//	- count = The number of bytes to be read.
-	// Output: No value is returned, but the `dest` array will store
-	// 	the data read upon exit.
-	void xmReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count);
+	// Output: BUS_OK if `dest` holds all count bytes read, after any
+	//	retries (see setBusRetry()).
+	bus_status xmReadBytes(uint8_t subAddress, uint8_t * dest, uint8_t count);
 	
 	// xmWriteByte() -- Write a byte to a register in the accel/mag sensor.
 	// Input:
 	//	- subAddress = Register to be written to.
 	//	- data = data to be written to the register.
-	void xmWriteByte(uint8_t subAddress, uint8_t data);
+	// Output: BUS_OK on success, after any retries.
+	bus_status xmWriteByte(uint8_t subAddress, uint8_t data);
+	
+	// xmWriteBytes() -- Write a number of bytes -- beginning at an address
+	// and incrementing from there -- to the accelerometer/magnetometer.
+	// Input:
+	//	- subAddress = Register to be written to first.
+	//	- * src = A pointer to the bytes to be written.
+	//	- count = The number of bytes to be written.
+	// Output: BUS_OK on success, after any retries.
+	bus_status xmWriteBytes(uint8_t subAddress, const uint8_t * src, uint8_t count);
+	
+	// readBytes(), writeBytes() -- What the g/xm functions above share:
+	// the transaction, its instrumentation, and the retries.
+	// Input:
+	//	- address = gAddress or xmAddress.
+	//	- fifo = true for a FIFO burst, which isn't repeated once it has
+	//		transferred anything (the samples read are gone).
+	bus_status readBytes(uint8_t address, uint8_t subAddress, uint8_t * dest,
+						 uint8_t count, bool fifo = false);
+	bus_status writeBytes(uint8_t address, uint8_t subAddress,
+						  const uint8_t * src, uint8_t count);
+	
+	// recordRetry() -- Count a retry, and run recoverBus() before all but
+	// the first.
+	void recordRetry(uint8_t attempt);
+	
+#if LSM9DS0_USE_CAL
+	// readFIFOSum() -- Burst-read samples from a FIFO and sum each axis.
+	// Samples are read several at a time: with the FIFO enabled, the output
+	// register address wraps from OUT_Z_H back to OUT_X_L.
+	// Input:
+	//	- gyro = true for the gyro FIFO, false for the accelerometer's.
+	//	- samples = How many samples to read.
+	//	- sum = Array of three 32-bit sums the samples are added to.
+	// Output: The number of samples read and summed.
+	uint8_t readFIFOSum(bool gyro, uint8_t samples, int32_t * sum);
+#endif
+	
+	// readFIFO() -- Burst-read raw samples from a FIFO, as readGyroFIFO()
+	// and readAccelFIFO() do.
+	// Input:
+	//	- gyro = true for the gyro FIFO, false for the accelerometer's.
+	//	- dest = Array where raw samples are stored, interleaved x, y, z.
+	//	- samples = How many samples to read.
+	// Output: The number of samples read; fewer than asked if a burst
+	//	failed, which ends the read.
+	uint8_t readFIFO(bool gyro, int16_t * dest, uint8_t samples);
+	
+#if LSM9DS0_USE_FRAME
+	// readFIFOFrame() -- Burst-read the samples waiting in a FIFO into a
+	// frame's per-axis arrays, up to the end of the oldest epoch in it.
+	// Input:
+	//	- gyro = true for the gyro FIFO, false for the accelerometer's.
+	//	- dest = The frame's g or a arrays.
+	//	- h = The frame's header. The sensor's count, res, scale, ODR,
+	//	  epoch, and later are set, and so are its flags.
+	// Output: The number of samples read.
+	uint8_t readFIFOFrame(bool gyro, int16_t (* dest)[LSM9DS0_FRAME_SAMPLES],
+						  LSM9DS0_frame_header & h);
+#endif
+	
+	// beginEpoch() -- Get ready to change a sensor's scale or ODR.
+	// With its FIFO on, the samples in it so far are queued with the
+	// current configuration. Otherwise the output registers are read, so
+	// the last sample before the change is in gx... (or ax..., mx...),
+	// and the sensor is marked stale until it has a new one.
+	// Input:
+	//	- sensor = VALID_G, VALID_A, or VALID_M.
+	// Output: false if the FIFO registers couldn't be read. Nothing is
+	//	changed then, and the caller shouldn't go on with the change.
+	bool beginEpoch(uint8_t sensor);
+	
+#if LSM9DS0_USE_FRAME
+	// trimEpochs() -- Drop the queued samples that have left a FIFO.
+	// Input:
+	//	- fifo = 0 for the gyro, 1 for the accelerometer.
+	//	- stored = Samples in the FIFO now.
+	//	- overrun = The FIFO overran, so the oldest may have been dropped.
+	void trimEpochs(uint8_t fifo, uint8_t stored, bool overrun);
+#endif
+	
+	// restartEpochs() -- Forget the queued samples and stale registers,
+	// re-read the ODRs, and start a new epoch for every sensor. For when
+	// the FIFOs and configuration are set wholesale (begin(), selfTest()).
+	void restartEpochs();
+	
+#if LSM9DS0_USE_FRAME
+	// updateODRs() -- Read the output data rates into odr.
+	void updateODRs();
+#endif
+	
+	// staleOutput() -- Whether a sensor's output registers still hold the
+	// sample from before its last change (see beginEpoch()).
+	bool staleOutput(uint8_t sensor);
+	
+#if LSM9DS0_USE_CAL
+	// discardSamples() -- Wait for and throw away a sensor's next samples,
+	// polling its ZYXDA status bit, e.g. while it settles after a change.
+	// Input:
+	//	- gyro = true for the gyro, false for the accelerometer.
+	//	- samples = How many samples to throw away.
+	// Output: false if they didn't arrive in time.
+	bool discardSamples(bool gyro, uint8_t samples);
+	
+	// averageFIFO() -- Restart a FIFO, wait for it to collect a batch of
+	// samples, and return their average in raw ADC ticks.
+	// Input:
+	//	- gyro = true for the gyro FIFO, false for the accelerometer's.
+	//	- samples = How many samples to average (at most 31).
+	//	- avg = Array of three floats where the averages will be stored.
+	// Output: false if the samples didn't arrive in time.
+	bool averageFIFO(bool gyro, uint8_t samples, float * avg);
+#endif
+	
+	// initInterface() -- Start the SPI or I2C hardware and read WHO_AM_I.
+	// Output: The combined WHO_AM_I values, as returned by begin().
+	uint16_t initInterface();
 	
+#if LSM9DS0_USE_FLOAT
 	// calcgRes() -- Calculate the resolution of the gyroscope.
 	// This function will set the value of the gRes variable. gScale must
 	// be set prior to calling this function.
@@ -488,7 +1221,9 @@ private:
 	// This function will set the value of the aRes variable. aScale must
 	// be set prior to calling this function.
 	void calcaRes();
+#endif
 	
+#if LSM9DS0_USE_SPI
 	///////////////////
 	// SPI Functions //
 	///////////////////
@@ -496,6 +1231,14 @@ private:
 	// This function will setup all SPI pins and related hardware.
 	void initSPI();
 	
+	// spiBegin() and spiEnd() -- Start and finish a transfer with one chip:
+	// begin an SPI transaction and assert its chip select, then release both.
+	void spiBegin(uint8_t csPin);
+	void spiEnd(uint8_t csPin);
+	
+	// spiSelect() -- Drive a chip select pin, low to select.
+	void spiSelect(uint8_t csPin, uint8_t level);
+	
 	// SPIwriteByte() -- Write a byte out of SPI to a register in the device
 	// Input:
 	//	- csPin = The chip select pin of the slave device.
@@ -503,15 +1246,17 @@ private:
 	//	- data = Byte to be written to the register.
 	void SPIwriteByte(uint8_t csPin, uint8_t subAddress, uint8_t data);
 	
-	// SPIreadByte() -- Read a single byte from a register over SPI.
+	// SPIwriteBytes() -- Write a series of bytes, starting at a register
 	// Input:
 	//	- csPin = The chip select pin of the slave device.
-	//	- subAddress = The register to be read from.
-	// Output:
-	//	- The byte read from the requested address.
-	uint8_t SPIreadByte(uint8_t csPin, uint8_t subAddress);
+	//	- subAddress = The register to begin writing.
+	//	- * src = Pointer to the bytes to be written.
+	//	- count = Number of registers to be written.
+	void SPIwriteBytes(uint8_t csPin, uint8_t subAddress,
+							const uint8_t * src, uint8_t count);
 	
 	// SPIreadBytes() -- Read a series of bytes, starting at a register via SPI
+	// The data bytes are clocked in with a single block transfer.
 	// Input:
 	//	- csPin = The chip select pin of a slave device.
 	//	- subAddress = The register to begin reading.
@@ -521,7 +1266,9 @@ private:
 	// 		all stored in the *dest array given.
 	void SPIreadBytes(uint8_t csPin, uint8_t subAddress, 
 							uint8_t * dest, uint8_t count);
+#endif
 	
+#if LSM9DS0_USE_I2C
 	///////////////////
 	// I2C Functions //
 	///////////////////
@@ -534,25 +1281,40 @@ private:
 	//	- address = The 7-bit I2C address of the slave device.
 	//	- subAddress = The register to be written to.
 	//	- data = Byte to be written to the register.
-	void I2CwriteByte(uint8_t address, uint8_t subAddress, uint8_t data);
+	// Output: Wire.endTransmission()'s status: 0 on success.
+	uint8_t I2CwriteByte(uint8_t address, uint8_t subAddress, uint8_t data);
 	
-	// I2CreadByte() -- Read a single byte from a register over I2C.
+	// I2CwriteBytes() -- Write a series of bytes, starting at a register
+	// Writes longer than Wire's buffer are split into several transactions.
 	// Input:
 	//	- address = The 7-bit I2C address of the slave device.
-	//	- subAddress = The register to be read from.
-	// Output:
-	//	- The byte read from the requested address.
-	uint8_t I2CreadByte(uint8_t address, uint8_t subAddress);
+	//	- subAddress = The register to begin writing.
+	//	- * src = Pointer to the bytes to be written.
+	//	- count = Number of registers to be written.
+	// Output: Wire.endTransmission()'s status: 0 on success.
+	uint8_t I2CwriteBytes(uint8_t address, uint8_t subAddress,
+							const uint8_t * src, uint8_t count);
 	
-	// I2CreadBytes() -- Read a series of bytes, starting at a register via SPI
+	// I2CreadBytes() -- Read a series of bytes, starting at a register via I2C
+	// Reads longer than Wire's buffer are split into several transactions.
 	// Input:
 	//	- address = The 7-bit I2C address of the slave device.
 	//	- subAddress = The register to begin reading.
 	// 	- * dest = Pointer to an array where we'll store the readings.
 	//	- count = Number of registers to be read.
-	// Output: No value is returned by the function, but the registers read are
-	// 		all stored in the *dest array given.
-	void I2CreadBytes(uint8_t address, uint8_t subAddress, uint8_t * dest, uint8_t count);
+	//	- fifo = true when reading samples out of a FIFO, whose address
+	//	  wraps back to subAddress after every sample.
+	// Output: The number of bytes read into dest: 0 if the device didn't
+	//	answer, fewer than count on a short read.
+	uint8_t I2CreadBytes(uint8_t address, uint8_t subAddress, uint8_t * dest,
+						 uint8_t count, bool fifo = false);
+	
+	// I2CwriteRead() -- One combined transaction: write the sub-address,
+	// then read with a repeated start. count must fit Wire's buffer.
+	// Output: The number of bytes read into dest.
+	uint8_t I2CwriteRead(uint8_t address, uint8_t subAddress, uint8_t * dest,
+						 uint8_t count);
+#endif
 };
 
 #endif // SFE_LSM9DS0_H //
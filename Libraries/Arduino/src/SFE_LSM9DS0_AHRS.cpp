@@ -0,0 +1,491 @@
+/******************************************************************************
+SFE_LSM9DS0_AHRS.cpp
+SFE_LSM9DS0 Library Orientation Filters
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Sebastian Madgwick's "efficient orientation filter for inertial/magnetic
+sensor arrays" and Mahony's complementary filter, moved here from the AHRS
+example (see http://www.x-io.co.uk/category/open-source/), and an
+error-state Kalman filter along the lines of Sola's "Quaternion kinematics
+for the error-state Kalman filter" (arXiv:1711.02508).
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_AHRS.h"
+#include <string.h>
+
+void quaternionToEuler(const float * q, float & yaw, float & pitch, float & roll)
+{
+	yaw   = atan2(2.0f * (q[1] * q[2] + q[0] * q[3]),
+				  q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3]);
+	pitch = -asin(2.0f * (q[1] * q[3] - q[0] * q[2]));
+	roll  = atan2(2.0f * (q[0] * q[1] + q[2] * q[3]),
+				  q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]);
+	yaw *= 180.0f / PI;
+	pitch *= 180.0f / PI;
+	roll *= 180.0f / PI;
+}
+
+// normalize3() -- Scale a vector to unit length.
+// Output: false if it's all zeros.
+static bool normalize3(float & x, float & y, float & z)
+{
+	float norm = sqrt(x * x + y * y + z * z);
+	if (norm == 0.0f)
+		return false;
+	norm = 1.0f / norm;
+	x *= norm;
+	y *= norm;
+	z *= norm;
+	return true;
+}
+
+static void normalize4(float * q, float q1, float q2, float q3, float q4)
+{
+	float norm = 1.0f / sqrt(q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4);
+	q[0] = q1 * norm;
+	q[1] = q2 * norm;
+	q[2] = q3 * norm;
+	q[3] = q4 * norm;
+}
+
+/////////////////////
+// LSM9DS0Madgwick //
+/////////////////////
+LSM9DS0Madgwick::LSM9DS0Madgwick(float b, float z) : beta(b), zeta(z)
+{
+	reset();
+}
+
+void LSM9DS0Madgwick::reset()
+{
+	q[0] = 1.0f;
+	q[1] = q[2] = q[3] = 0.0f;
+	gBias[0] = gBias[1] = gBias[2] = 0.0f;
+}
+
+void LSM9DS0Madgwick::getEuler(float & yaw, float & pitch, float & roll)
+{
+	quaternionToEuler(q, yaw, pitch, roll);
+}
+
+void LSM9DS0Madgwick::update(float ax, float ay, float az, float gx, float gy,
+							 float gz, float mx, float my, float mz, float dt)
+{
+	float q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3];
+	if (!normalize3(ax, ay, az) || !normalize3(mx, my, mz))
+		return;
+
+	// Auxiliary variables to avoid repeated arithmetic
+	float _2q1 = 2.0f * q1;
+	float _2q2 = 2.0f * q2;
+	float _2q3 = 2.0f * q3;
+	float _2q4 = 2.0f * q4;
+	float _2q1q3 = 2.0f * q1 * q3;
+	float _2q3q4 = 2.0f * q3 * q4;
+	float q1q1 = q1 * q1;
+	float q1q2 = q1 * q2;
+	float q1q3 = q1 * q3;
+	float q1q4 = q1 * q4;
+	float q2q2 = q2 * q2;
+	float q2q3 = q2 * q3;
+	float q2q4 = q2 * q4;
+	float q3q3 = q3 * q3;
+	float q3q4 = q3 * q4;
+	float q4q4 = q4 * q4;
+
+	// Reference direction of Earth's magnetic field
+	float _2q1mx = 2.0f * q1 * mx;
+	float _2q1my = 2.0f * q1 * my;
+	float _2q1mz = 2.0f * q1 * mz;
+	float _2q2mx = 2.0f * q2 * mx;
+	float hx = mx * q1q1 - _2q1my * q4 + _2q1mz * q3 + mx * q2q2 + _2q2 * my * q3 +
+			   _2q2 * mz * q4 - mx * q3q3 - mx * q4q4;
+	float hy = _2q1mx * q4 + my * q1q1 - _2q1mz * q2 + _2q2mx * q3 - my * q2q2 +
+			   my * q3q3 + _2q3 * mz * q4 - my * q4q4;
+	float _2bx = sqrt(hx * hx + hy * hy);
+	float _2bz = -_2q1mx * q3 + _2q1my * q2 + mz * q1q1 + _2q2mx * q4 - mz * q2q2 +
+				 _2q3 * my * q4 - mz * q3q3 + mz * q4q4;
+	float _4bx = 2.0f * _2bx;
+	float _4bz = 2.0f * _2bz;
+
+	// Gradient descent corrective step
+	float fx = 2.0f * q2q4 - _2q1q3 - ax;
+	float fy = 2.0f * q1q2 + _2q3q4 - ay;
+	float fz = 1.0f - 2.0f * q2q2 - 2.0f * q3q3 - az;
+	float fmx = _2bx * (0.5f - q3q3 - q4q4) + _2bz * (q2q4 - q1q3) - mx;
+	float fmy = _2bx * (q2q3 - q1q4) + _2bz * (q1q2 + q3q4) - my;
+	float fmz = _2bx * (q1q3 + q2q4) + _2bz * (0.5f - q2q2 - q3q3) - mz;
+	float s1 = -_2q3 * fx + _2q2 * fy - _2bz * q3 * fmx +
+			   (-_2bx * q4 + _2bz * q2) * fmy + _2bx * q3 * fmz;
+	float s2 = _2q4 * fx + _2q1 * fy - 4.0f * q2 * fz + _2bz * q4 * fmx +
+			   (_2bx * q3 + _2bz * q1) * fmy + (_2bx * q4 - _4bz * q2) * fmz;
+	float s3 = -_2q1 * fx + _2q4 * fy - 4.0f * q3 * fz + (-_4bx * q3 - _2bz * q1) * fmx +
+			   (_2bx * q2 + _2bz * q4) * fmy + (_2bx * q1 - _4bz * q3) * fmz;
+	float s4 = _2q2 * fx + _2q3 * fy + (-_4bx * q4 + _2bz * q2) * fmx +
+			   (-_2bx * q1 + _2bz * q3) * fmy + _2bx * q2 * fmz;
+	float norm = sqrt(s1 * s1 + s2 * s2 + s3 * s3 + s4 * s4);
+	if (norm > 0.0f)
+	{
+		norm = 1.0f / norm;
+		s1 *= norm;
+		s2 *= norm;
+		s3 *= norm;
+		s4 *= norm;
+	}
+
+	// Gyro bias drift compensation: the gradient, as a rotation rate in the
+	// sensor frame (2 q* s), integrated into the bias
+	if (zeta != 0.0f)
+	{
+		float ex = _2q1 * s2 - _2q2 * s1 - _2q3 * s4 + _2q4 * s3;
+		float ey = _2q1 * s3 + _2q2 * s4 - _2q3 * s1 - _2q4 * s2;
+		float ez = _2q1 * s4 - _2q2 * s3 + _2q3 * s2 - _2q4 * s1;
+		gBias[0] += ex * dt * zeta;
+		gBias[1] += ey * dt * zeta;
+		gBias[2] += ez * dt * zeta;
+		gx -= gBias[0];
+		gy -= gBias[1];
+		gz -= gBias[2];
+	}
+
+	// Rate of change of the quaternion, integrated
+	float qDot1 = 0.5f * (-q2 * gx - q3 * gy - q4 * gz) - beta * s1;
+	float qDot2 = 0.5f * (q1 * gx + q3 * gz - q4 * gy) - beta * s2;
+	float qDot3 = 0.5f * (q1 * gy - q2 * gz + q4 * gx) - beta * s3;
+	float qDot4 = 0.5f * (q1 * gz + q2 * gy - q3 * gx) - beta * s4;
+	normalize4(q, q1 + qDot1 * dt, q2 + qDot2 * dt, q3 + qDot3 * dt, q4 + qDot4 * dt);
+}
+
+///////////////////
+// LSM9DS0Mahony //
+///////////////////
+LSM9DS0Mahony::LSM9DS0Mahony(float p, float i) : kp(p), ki(i)
+{
+	reset();
+}
+
+void LSM9DS0Mahony::reset()
+{
+	q[0] = 1.0f;
+	q[1] = q[2] = q[3] = 0.0f;
+	eInt[0] = eInt[1] = eInt[2] = 0.0f;
+}
+
+void LSM9DS0Mahony::getEuler(float & yaw, float & pitch, float & roll)
+{
+	quaternionToEuler(q, yaw, pitch, roll);
+}
+
+void LSM9DS0Mahony::update(float ax, float ay, float az, float gx, float gy,
+						   float gz, float mx, float my, float mz, float dt)
+{
+	float q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3];
+	if (!normalize3(ax, ay, az) || !normalize3(mx, my, mz))
+		return;
+
+	float q1q1 = q1 * q1;
+	float q1q2 = q1 * q2;
+	float q1q3 = q1 * q3;
+	float q1q4 = q1 * q4;
+	float q2q2 = q2 * q2;
+	float q2q3 = q2 * q3;
+	float q2q4 = q2 * q4;
+	float q3q3 = q3 * q3;
+	float q3q4 = q3 * q4;
+	float q4q4 = q4 * q4;
+
+	// Reference direction of Earth's magnetic field
+	float hx = 2.0f * mx * (0.5f - q3q3 - q4q4) + 2.0f * my * (q2q3 - q1q4) +
+			   2.0f * mz * (q2q4 + q1q3);
+	float hy = 2.0f * mx * (q2q3 + q1q4) + 2.0f * my * (0.5f - q2q2 - q4q4) +
+			   2.0f * mz * (q3q4 - q1q2);
+	float bx = sqrt((hx * hx) + (hy * hy));
+	float bz = 2.0f * mx * (q2q4 - q1q3) + 2.0f * my * (q3q4 + q1q2) +
+			   2.0f * mz * (0.5f - q2q2 - q3q3);
+
+	// Estimated direction of gravity and magnetic field
+	float vx = 2.0f * (q2q4 - q1q3);
+	float vy = 2.0f * (q1q2 + q3q4);
+	float vz = q1q1 - q2q2 - q3q3 + q4q4;
+	float wx = 2.0f * bx * (0.5f - q3q3 - q4q4) + 2.0f * bz * (q2q4 - q1q3);
+	float wy = 2.0f * bx * (q2q3 - q1q4) + 2.0f * bz * (q1q2 + q3q4);
+	float wz = 2.0f * bx * (q1q3 + q2q4) + 2.0f * bz * (0.5f - q2q2 - q3q3);
+
+	// Error is the cross product between estimated and measured directions
+	float ex = (ay * vz - az * vy) + (my * wz - mz * wy);
+	float ey = (az * vx - ax * vz) + (mz * wx - mx * wz);
+	float ez = (ax * vy - ay * vx) + (mx * wy - my * wx);
+	if (ki > 0.0f)
+	{
+		eInt[0] += ex * dt;
+		eInt[1] += ey * dt;
+		eInt[2] += ez * dt;
+	}
+	else
+		eInt[0] = eInt[1] = eInt[2] = 0.0f; // Prevent integral wind-up
+
+	// Apply feedback terms
+	gx += kp * ex + ki * eInt[0];
+	gy += kp * ey + ki * eInt[1];
+	gz += kp * ez + ki * eInt[2];
+
+	// Integrate the rate of change of the quaternion. Unlike the example,
+	// every term uses the quaternion from before the step.
+	float h = 0.5f * dt;
+	normalize4(q, q1 + (-q2 * gx - q3 * gy - q4 * gz) * h,
+			   q2 + (q1 * gx + q3 * gz - q4 * gy) * h,
+			   q3 + (q1 * gy - q2 * gz + q4 * gx) * h,
+			   q4 + (q1 * gz + q2 * gy - q3 * gx) * h);
+}
+
+/////////////////
+// LSM9DS0ESKF //
+/////////////////
+LSM9DS0ESKF::LSM9DS0ESKF(bool accelBias) :
+	gyroNoise(LSM9DS0_ESKF_GYRO_NOISE), gyroWalk(LSM9DS0_ESKF_GYRO_WALK),
+	accelNoise(LSM9DS0_ESKF_ACCEL_NOISE), accelWalk(LSM9DS0_ESKF_ACCEL_WALK),
+	magNoise(LSM9DS0_ESKF_MAG_NOISE), accelGate(LSM9DS0_ESKF_ACCEL_GATE),
+	n(accelBias ? 9 : 6)
+{
+	reset();
+}
+
+void LSM9DS0ESKF::reset()
+{
+	q[0] = 1.0f;
+	q[1] = q[2] = q[3] = 0.0f;
+	memset(P, 0, sizeof(P));
+	memset(dx, 0, sizeof(dx));
+	for (int i = 0; i < 3; i++)
+	{
+		gBias[i] = aBias[i] = 0.0f;
+		P[i][i] = 0.25f;			// 0.5 rad
+		P[3 + i][3 + i] = 0.0025f;	// 0.05 rad/s, about 3 DPS
+		if (n > 6)
+			P[6 + i][6 + i] = 0.0025f;	// 0.05 g
+	}
+	aligned = false;
+}
+
+void LSM9DS0ESKF::getEuler(float & yaw, float & pitch, float & roll)
+{
+	quaternionToEuler(q, yaw, pitch, roll);
+}
+
+// align() -- Set q from a single accel (and mag) reading: the earth's z
+// axis is along the accel, and its x axis along the horizontal part of the
+// mag, as the Madgwick filter's reference has it.
+void LSM9DS0ESKF::align(float ax, float ay, float az, float mx, float my,
+						float mz)
+{
+	normalize3(ax, ay, az);
+	if (!normalize3(mx, my, mz))
+	{
+		// No mag: face along whichever body axis is most horizontal.
+		if (fabs(ax) < 0.9f)
+			mx = 1.0f, my = mz = 0.0f;
+		else
+			my = 1.0f, mx = mz = 0.0f;
+	}
+	float d = mx * ax + my * ay + mz * az;
+	float xx = mx - d * ax, xy = my - d * ay, xz = mz - d * az;
+	if (!normalize3(xx, xy, xz))
+		return;
+	float yx = ay * xz - az * xy;
+	float yy = az * xx - ax * xz;
+	float yz = ax * xy - ay * xx;
+
+	// The rows of the body-to-earth rotation are the earth axes, in body
+	// coordinates. Convert it to a quaternion from its largest diagonal.
+	float trace = xx + yy + az;
+	if (trace > 0.0f)
+	{
+		float s = 2.0f * sqrt(1.0f + trace);
+		q[0] = 0.25f * s;
+		q[1] = (ay - yz) / s;
+		q[2] = (xz - ax) / s;
+		q[3] = (yx - xy) / s;
+	}
+	else if (xx > yy && xx > az)
+	{
+		float s = 2.0f * sqrt(1.0f + xx - yy - az);
+		q[0] = (ay - yz) / s;
+		q[1] = 0.25f * s;
+		q[2] = (xy + yx) / s;
+		q[3] = (xz + ax) / s;
+	}
+	else if (yy > az)
+	{
+		float s = 2.0f * sqrt(1.0f + yy - xx - az);
+		q[0] = (xz - ax) / s;
+		q[1] = (xy + yx) / s;
+		q[2] = 0.25f * s;
+		q[3] = (yz + ay) / s;
+	}
+	else
+	{
+		float s = 2.0f * sqrt(1.0f + az - xx - yy);
+		q[0] = (yx - xy) / s;
+		q[1] = (xz + ax) / s;
+		q[2] = (yz + ay) / s;
+		q[3] = 0.25f * s;
+	}
+	normalize4(q, q[0], q[1], q[2], q[3]);
+	aligned = true;
+}
+
+// predict() -- Integrate the bias-corrected rate w into q, and propagate
+// the covariance through F = [A -dt*I 0; 0 I 0; 0 0 I], A = I - [w*dt]x.
+// Only the attitude rows and columns change, so F*P*F' is done as F*P on
+// three rows, then the upper triangle of the attitude block of (F*P)*F';
+// the rest is mirrored.
+void LSM9DS0ESKF::predict(float wx, float wy, float wz, float dt)
+{
+	float h = 0.5f * dt;
+	normalize4(q, q[0] + (-q[1] * wx - q[2] * wy - q[3] * wz) * h,
+			   q[1] + (q[0] * wx + q[2] * wz - q[3] * wy) * h,
+			   q[2] + (q[0] * wy - q[1] * wz + q[3] * wx) * h,
+			   q[3] + (q[0] * wz + q[1] * wy - q[2] * wx) * h);
+
+	float px = wx * dt, py = wy * dt, pz = wz * dt;
+	const float A[3][3] = {{1.0f, pz, -py}, {-pz, 1.0f, px}, {py, -px, 1.0f}};
+	float M[3][9];
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < n; j++)
+			M[i][j] = A[i][0] * P[0][j] + A[i][1] * P[1][j] +
+					  A[i][2] * P[2][j] - dt * P[3 + i][j];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = i; j < 3; j++)
+			P[i][j] = M[i][0] * A[j][0] + M[i][1] * A[j][1] +
+					  M[i][2] * A[j][2] - dt * M[i][3 + j];
+		for (int j = 3; j < n; j++)
+			P[i][j] = M[i][j];
+	}
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < i && j < 3; j++)
+			P[i][j] = P[j][i];
+
+	float qTheta = gyroNoise * gyroNoise * dt;
+	float qGyro = gyroWalk * gyroWalk * dt;
+	float qAccel = accelWalk * accelWalk * dt;
+	for (int i = 0; i < 3; i++)
+	{
+		P[i][i] += qTheta;
+		P[3 + i][3 + i] += qGyro;
+		if (n > 6)
+			P[6 + i][6 + i] += qAccel;
+	}
+}
+
+// correct() -- One scalar measurement, whose Jacobian is h on the attitude
+// error plus 1 on accel bias biasIndex (or none, if it's -1). With a scalar
+// the gain needs no inverse, and P - K*H*P = P - PH'*PH'/s is a symmetric
+// rank-one update, done on the upper triangle.
+// Input:
+//	- residual = Measured minus predicted, before the pending error state.
+//	- r = Measurement variance.
+void LSM9DS0ESKF::correct(const float * h, int8_t biasIndex, float residual,
+						  float r)
+{
+	float PHt[9];
+	int b = (biasIndex >= 0 && n > 6) ? 6 + biasIndex : -1;
+	for (int i = 0; i < n; i++)
+	{
+		PHt[i] = P[i][0] * h[0] + P[i][1] * h[1] + P[i][2] * h[2];
+		if (b >= 0)
+			PHt[i] += P[i][b];
+	}
+	float s = r + h[0] * PHt[0] + h[1] * PHt[1] + h[2] * PHt[2];
+	float y = residual - (h[0] * dx[0] + h[1] * dx[1] + h[2] * dx[2]);
+	if (b >= 0)
+	{
+		s += PHt[b];
+		y -= dx[b];
+	}
+	if (s <= 0.0f)
+		return;
+	float inv = 1.0f / s;
+	for (int i = 0; i < n; i++)
+	{
+		float k = PHt[i] * inv;
+		dx[i] += k * y;
+		for (int j = i; j < n; j++)
+			P[j][i] = P[i][j] -= k * PHt[j];
+	}
+}
+
+// inject() -- Fold the error state into q and the biases, and clear it.
+void LSM9DS0ESKF::inject()
+{
+	float h = 0.5f;
+	normalize4(q, q[0] + (-q[1] * dx[0] - q[2] * dx[1] - q[3] * dx[2]) * h,
+			   q[1] + (q[0] * dx[0] + q[2] * dx[2] - q[3] * dx[1]) * h,
+			   q[2] + (q[0] * dx[1] - q[1] * dx[2] + q[3] * dx[0]) * h,
+			   q[3] + (q[0] * dx[2] + q[1] * dx[1] - q[2] * dx[0]) * h);
+	for (int i = 0; i < 3; i++)
+	{
+		gBias[i] += dx[3 + i];
+		if (n > 6)
+			aBias[i] += dx[6 + i];
+	}
+	memset(dx, 0, sizeof(dx));
+}
+
+void LSM9DS0ESKF::update(float ax, float ay, float az, float gx, float gy,
+						 float gz, float mx, float my, float mz, float dt)
+{
+	if (!aligned)
+	{
+		if (ax != 0.0f || ay != 0.0f || az != 0.0f)
+			align(ax, ay, az, mx, my, mz);
+		return;
+	}
+	predict(gx - gBias[0], gy - gBias[1], gz - gBias[2], dt);
+
+	float q1q1 = q[0] * q[0], q1q2 = q[0] * q[1], q1q3 = q[0] * q[2];
+	float q1q4 = q[0] * q[3], q2q2 = q[1] * q[1], q2q3 = q[1] * q[2];
+	float q2q4 = q[1] * q[3], q3q3 = q[2] * q[2], q3q4 = q[2] * q[3];
+	float q4q4 = q[3] * q[3];
+
+	// Accel: gravity's direction in the body frame, v, plus the bias. The
+	// Jacobian on the attitude error is [v]x. Skipped while accelerating.
+	float bx = ax - aBias[0], by = ay - aBias[1], bz = az - aBias[2];
+	float norm = sqrt(bx * bx + by * by + bz * bz);
+	if (norm > 0.0f && fabs(norm - 1.0f) <= accelGate)
+	{
+		float v[3] = {2.0f * (q2q4 - q1q3), 2.0f * (q1q2 + q3q4),
+					  q1q1 - q2q2 - q3q3 + q4q4};
+		const float h[3][3] = {{0.0f, -v[2], v[1]}, {v[2], 0.0f, -v[0]},
+							   {-v[1], v[0], 0.0f}};
+		float r = accelNoise * accelNoise;
+		correct(h[0], 0, bx - v[0], r);
+		correct(h[1], 1, by - v[1], r);
+		correct(h[2], 2, bz - v[2], r);
+	}
+
+	// Mag: the earth's field, flattened onto the x-z plane as the Madgwick
+	// filter does, then rotated into the body frame.
+	if (normalize3(mx, my, mz))
+	{
+		float hx = 2.0f * mx * (0.5f - q3q3 - q4q4) + 2.0f * my * (q2q3 - q1q4) +
+				   2.0f * mz * (q2q4 + q1q3);
+		float hy = 2.0f * mx * (q2q3 + q1q4) + 2.0f * my * (0.5f - q2q2 - q4q4) +
+				   2.0f * mz * (q3q4 - q1q2);
+		float ex = sqrt(hx * hx + hy * hy);
+		float ez = 2.0f * mx * (q2q4 - q1q3) + 2.0f * my * (q3q4 + q1q2) +
+				   2.0f * mz * (0.5f - q2q2 - q3q3);
+		float w[3] = {2.0f * ex * (0.5f - q3q3 - q4q4) + 2.0f * ez * (q2q4 - q1q3),
+					  2.0f * ex * (q2q3 - q1q4) + 2.0f * ez * (q1q2 + q3q4),
+					  2.0f * ex * (q1q3 + q2q4) + 2.0f * ez * (0.5f - q2q2 - q3q3)};
+		const float h[3][3] = {{0.0f, -w[2], w[1]}, {w[2], 0.0f, -w[0]},
+							   {-w[1], w[0], 0.0f}};
+		float r = magNoise * magNoise;
+		correct(h[0], -1, mx - w[0], r);
+		correct(h[1], -1, my - w[1], r);
+		correct(h[2], -1, mz - w[2], r);
+	}
+	inject();
+}
@@ -0,0 +1,164 @@
+/******************************************************************************
+SFE_LSM9DS0_AHRS.h
+SFE_LSM9DS0 Library Orientation Filters
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The Madgwick and Mahony filters from the SparkFun_LSM9DS0_AHRS example, as
+classes, so several sensors (or threads) can each run their own filter,
+and LSM9DS0ESKF, an error-state Kalman filter that also estimates the gyro
+(and optionally the accel) bias. All fuse gyro, accel, and mag readings
+into an orientation quaternion q = {w, x, y, z}.
+
+Typical use:
+	LSM9DS0Madgwick ahrs;
+	...
+	ahrs.update(ax, ay, az, gx * PI / 180, gy * PI / 180, gz * PI / 180,
+				mx, my, mz, dt);
+	float yaw, pitch, roll;
+	ahrs.getEuler(yaw, pitch, roll);
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_AHRS_H__
+#define __SFE_LSM9DS0_AHRS_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Default Madgwick gain: sqrt(3/4) times a gyro measurement error of
+// 40 DPS, as in the AHRS example. Lower converges slower but is smoother.
+#define LSM9DS0_MADGWICK_BETA	0.6045998f
+// Default Madgwick gyro bias gain (zeta): off, as in the AHRS example, where
+// it's sqrt(3/4) times a gyro drift of 0 DPS/s.
+#define LSM9DS0_MADGWICK_ZETA	0.0f
+// Default Mahony gains, as in the AHRS example.
+#define LSM9DS0_MAHONY_KP		10.0f
+#define LSM9DS0_MAHONY_KI		0.0f
+// Default ESKF noise densities, roughly the LSM9DS0 datasheet's figures with
+// some margin for vibration.
+#define LSM9DS0_ESKF_GYRO_NOISE		0.005f	// rad/s/sqrt(Hz)
+#define LSM9DS0_ESKF_GYRO_WALK		0.0002f	// Gyro bias, rad/s/sqrt(s)
+#define LSM9DS0_ESKF_ACCEL_NOISE	0.05f	// g's
+#define LSM9DS0_ESKF_ACCEL_WALK		0.0005f	// Accel bias, g/sqrt(s)
+#define LSM9DS0_ESKF_MAG_NOISE		0.05f	// Normalized field
+#define LSM9DS0_ESKF_ACCEL_GATE		0.15f	// Skip the accel if |a| is off
+											// 1 g by more than this
+
+class LSM9DS0Madgwick
+{
+public:
+	// LSM9DS0Madgwick -- Constructor. Starts level, facing north.
+	// Input:
+	//	- beta = Filter gain.
+	//	- zeta = Gyro bias gain. With 0, the bias is held at zero.
+	LSM9DS0Madgwick(float beta = LSM9DS0_MADGWICK_BETA,
+					float zeta = LSM9DS0_MADGWICK_ZETA);
+
+	// reset() -- Go back to the identity quaternion, and clear the gyro
+	// bias.
+	void reset();
+
+	// update() -- Run one filter step.
+	// Input:
+	//	- ax, ay, az = Acceleration, in any unit (it's normalized).
+	//	- gx, gy, gz = Rotation rate, in radians per second.
+	//	- mx, my, mz = Magnetic field, in any unit (it's normalized).
+	//	- dt = Time since the last update, in seconds.
+	// A zero accel or mag vector skips the update.
+	void update(float ax, float ay, float az, float gx, float gy, float gz,
+				float mx, float my, float mz, float dt);
+
+	// getEuler() -- Yaw, pitch, and roll of q, in degrees.
+	void getEuler(float & yaw, float & pitch, float & roll);
+
+	float q[4];		// Orientation quaternion: w, x, y, z
+	float beta;		// Filter gain
+	float zeta;		// Gyro bias gain
+	float gBias[3];	// Gyro bias, in radians per second
+};
+
+class LSM9DS0Mahony
+{
+public:
+	// LSM9DS0Mahony -- Constructor. Starts level, facing north.
+	// Input:
+	//	- kp = Proportional gain.
+	//	- ki = Integral gain. With 0, the integral term is held at zero.
+	LSM9DS0Mahony(float kp = LSM9DS0_MAHONY_KP, float ki = LSM9DS0_MAHONY_KI);
+
+	// reset() -- Go back to the identity quaternion, and clear the
+	// integral term.
+	void reset();
+
+	// update() -- Run one filter step. Same as LSM9DS0Madgwick::update().
+	void update(float ax, float ay, float az, float gx, float gy, float gz,
+				float mx, float my, float mz, float dt);
+
+	// getEuler() -- Yaw, pitch, and roll of q, in degrees.
+	void getEuler(float & yaw, float & pitch, float & roll);
+
+	float q[4];		// Orientation quaternion: w, x, y, z
+	float kp, ki;	// Proportional and integral gains
+	float eInt[3];	// Integral of the error
+};
+
+// LSM9DS0ESKF -- Error-state (multiplicative) extended Kalman filter.
+// The state is the orientation q, the gyro bias, and, if asked for, the
+// accel bias; the 6x6 or 9x9 covariance is a fixed member array, and each
+// step costs a few hundred multiplies: the prediction works block by block
+// and the accel and mag vectors are applied as scalar updates, so nothing
+// is ever inverted, and only one triangle of the covariance is computed.
+class LSM9DS0ESKF
+{
+public:
+	// LSM9DS0ESKF -- Constructor. The first update() with an accel
+	// reading sets q from the accel and mag.
+	// Input:
+	//	- accelBias = Also estimate the accel bias.
+	LSM9DS0ESKF(bool accelBias = false);
+
+	// reset() -- Forget q and the biases, and go back to the initial
+	// covariance.
+	void reset();
+
+	// update() -- Run one filter step.
+	// Input:
+	//	- ax, ay, az = Acceleration, in g's.
+	//	- gx, gy, gz = Rotation rate, in radians per second.
+	//	- mx, my, mz = Magnetic field, in any unit (it's normalized).
+	//	- dt = Time since the last update, in seconds.
+	// A zero accel or mag vector skips that correction; the gyro is always
+	// integrated.
+	void update(float ax, float ay, float az, float gx, float gy, float gz,
+				float mx, float my, float mz, float dt);
+
+	// getEuler() -- Yaw, pitch, and roll of q, in degrees.
+	void getEuler(float & yaw, float & pitch, float & roll);
+
+	// variance() -- Diagonal of the covariance: 0-2 attitude (rad^2),
+	// 3-5 gyro bias ((rad/s)^2), 6-8 accel bias (g^2).
+	float variance(uint8_t i) { return i < n ? P[i][i] : 0.0f; }
+
+	float q[4];			// Orientation quaternion: w, x, y, z
+	float gBias[3];		// Gyro bias, in radians per second
+	float aBias[3];		// Accel bias, in g's (0 unless estimated)
+	float gyroNoise, gyroWalk;		// See LSM9DS0_ESKF_*
+	float accelNoise, accelWalk;
+	float magNoise, accelGate;
+
+private:
+	void align(float ax, float ay, float az, float mx, float my, float mz);
+	void predict(float wx, float wy, float wz, float dt);
+	void correct(const float * h, int8_t biasIndex, float residual, float r);
+	void inject();
+
+	float P[9][9];		// Error covariance: attitude, gyro bias, accel bias
+	float dx[9];		// Error state, between corrections and inject()
+	uint8_t n;			// 6, or 9 with the accel bias
+	bool aligned;		// q has been set from the accel and mag
+};
+
+// quaternionToEuler() -- Yaw, pitch, and roll of a quaternion, in degrees,
+// as the AHRS example computes them.
+void quaternionToEuler(const float * q, float & yaw, float & pitch, float & roll);
+
+#endif // __SFE_LSM9DS0_AHRS_H__ //
@@ -0,0 +1,154 @@
+/******************************************************************************
+SFE_LSM9DS0_AccelCal.cpp
+SFE_LSM9DS0 Library Multi-Pose Accelerometer Calibration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the ellipsoid fit declared in SFE_LSM9DS0_AccelCal.h. The normal
+equations are solved with an in-place Cholesky factorization of the packed
+matrix, so solving needs no memory beyond a 9x9 triangle on the stack.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_AccelCal.h"
+
+// Index of element (i, j), i >= j, in a packed lower-triangular matrix.
+static inline uint8_t tri(uint8_t i, uint8_t j)
+{
+	return (i >= j) ? (i * (i + 1)) / 2 + j : (j * (j + 1)) / 2 + i;
+}
+
+// choleskySolve() -- Solve L * L^T * x = b in place.
+// L is a packed n x n symmetric positive-definite matrix, which is replaced
+// by its Cholesky factor. b is replaced by x.
+// Output: false if the matrix isn't (numerically) positive-definite.
+static bool choleskySolve(float * L, float * b, uint8_t n)
+{
+	for (uint8_t i = 0; i < n; i++)
+	{
+		for (uint8_t j = 0; j <= i; j++)
+		{
+			float s = L[tri(i, j)];
+			for (uint8_t k = 0; k < j; k++)
+				s -= L[tri(i, k)] * L[tri(j, k)];
+			if (i == j)
+			{
+				// A pivot that collapses relative to its starting value
+				// means the poses don't pin this parameter down.
+				if (s <= 1e-6f * L[tri(i, i)])
+					return false;
+				L[tri(i, i)] = sqrt(s);
+			}
+			else
+				L[tri(i, j)] = s / L[tri(j, j)];
+		}
+	}
+	for (uint8_t i = 0; i < n; i++) // Forward substitution: L * y = b
+	{
+		for (uint8_t k = 0; k < i; k++)
+			b[i] -= L[tri(i, k)] * b[k];
+		b[i] /= L[tri(i, i)];
+	}
+	for (int8_t i = n - 1; i >= 0; i--) // Back substitution: L^T * x = y
+	{
+		for (uint8_t k = i + 1; k < n; k++)
+			b[i] -= L[tri(k, i)] * b[k];
+		b[i] /= L[tri(i, i)];
+	}
+	return true;
+}
+
+LSM9DS0AccelCal::LSM9DS0AccelCal()
+{
+	reset();
+}
+
+void LSM9DS0AccelCal::reset()
+{
+	memset(N, 0, sizeof(N));
+	memset(r, 0, sizeof(r));
+	count = 0;
+}
+
+void LSM9DS0AccelCal::addSample(float x, float y, float z)
+{
+	// One row of the design matrix; the right-hand side is always 1.
+	float phi[9] = {x * x, y * y, z * z, x * y, x * z, y * z, x, y, z};
+
+	for (uint8_t i = 0; i < 9; i++)
+	{
+		for (uint8_t j = 0; j <= i; j++)
+			N[tri(i, j)] += phi[i] * phi[j];
+		r[i] += phi[i];
+	}
+	count++;
+}
+
+bool LSM9DS0AccelCal::solve(LSM9DS0_accel_cal & cal, bool crossAxis)
+{
+	// Without cross-axis terms only the squares and linear terms are fit.
+	static const uint8_t diagonal[6] = {0, 1, 2, 6, 7, 8};
+	static const uint8_t full[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+	const uint8_t * idx = crossAxis ? full : diagonal;
+	uint8_t n = crossAxis ? 9 : 6;
+	if (count < n)
+		return false;
+
+	float L[45], p[9];
+	for (uint8_t i = 0; i < n; i++)
+	{
+		for (uint8_t j = 0; j <= i; j++)
+			L[tri(i, j)] = N[tri(idx[i], idx[j])];
+		p[i] = r[idx[i]];
+	}
+	if (!choleskySolve(L, p, n))
+		return false;
+
+	// Unpack into the quadratic form A (packed 3x3) and linear term b.
+	float A[6], b[3];
+	A[tri(0, 0)] = p[0];
+	A[tri(1, 1)] = p[1];
+	A[tri(2, 2)] = p[2];
+	if (crossAxis)
+	{
+		A[tri(1, 0)] = p[3] / 2;
+		A[tri(2, 0)] = p[4] / 2;
+		A[tri(2, 1)] = p[5] / 2;
+	}
+	else
+		A[tri(1, 0)] = A[tri(2, 0)] = A[tri(2, 1)] = 0;
+	for (uint8_t i = 0; i < 3; i++)
+		b[i] = -p[n - 3 + i] / 2;
+
+	// The ellipsoid's center is the offset: A * c = -b / 2. That also
+	// leaves Cholesky(A) in place of A, which is what we want for M.
+	float Aorig[6];
+	memcpy(Aorig, A, sizeof(A));
+	if (!choleskySolve(A, b, 3))
+		return false;
+
+	// Completing the square: (v - c)^T A (v - c) = 1 + c^T A c = k.
+	// Scaling A by 1/k maps the ellipsoid onto the 1 g sphere.
+	float k = 1;
+	for (uint8_t i = 0; i < 3; i++)
+		for (uint8_t j = 0; j < 3; j++)
+			k += b[i] * Aorig[tri(i, j)] * b[j];
+	if (k <= 0)
+		return false;
+	float s = 1 / sqrt(k);
+
+	// A / k = (L s)(L s)^T, so M = (L s)^T is upper-triangular and satisfies
+	// |M (v - c)| = 1 for every point on the fitted ellipsoid.
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		cal.offset[i] = b[i];
+		cal.scale[i] = A[tri(i, i)] * s;
+	}
+	cal.cross[0] = A[tri(1, 0)] * s;
+	cal.cross[1] = A[tri(2, 0)] * s;
+	cal.cross[2] = A[tri(2, 1)] * s;
+	cal.version = LSM9DS0_ACCEL_CAL_VERSION;
+	cal.flags = crossAxis ? LSM9DS0_CAL_CROSS_AXIS : 0;
+	cal.check = LSM9DS0::checksum(&cal, sizeof(cal) - sizeof(cal.check));
+	return true;
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+SFE_LSM9DS0_AccelCal.h
+SFE_LSM9DS0 Library Multi-Pose Accelerometer Calibration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+calLSM9DS0() assumes the sensor is lying flat, Z-axis up, and only measures
+an offset. LSM9DS0AccelCal instead fits an ellipsoid to averaged readings
+taken in several orientations -- any orientations, as long as they're spread
+out -- and solves for per-axis offset and scale (and, optionally, cross-axis
+terms). The fit is accumulated incrementally, so no samples are stored.
+
+Typical use:
+	LSM9DS0AccelCal fit;
+	for each pose:
+		float a[3];
+		dof.readAccelAverage(a);
+		fit.addSample(a[0], a[1], a[2]);
+	LSM9DS0_accel_cal cal;
+	if (fit.solve(cal))
+		dof.setAccelCal(cal); // ...and save cal for the next boot
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_ACCELCAL_H__
+#define __SFE_LSM9DS0_ACCELCAL_H__
+
+#include "SFE_LSM9DS0.h"
+
+class LSM9DS0AccelCal
+{
+public:
+	// LSM9DS0AccelCal -- Constructor. Starts with an empty fit.
+	LSM9DS0AccelCal();
+
+	// reset() -- Discard every sample added so far.
+	void reset();
+
+	// addSample() -- Add one averaged, stationary reading to the fit.
+	// Input:
+	//	- x, y, z = Acceleration in g's, e.g. from readAccelAverage().
+	void addSample(float x, float y, float z);
+
+	// samples() -- Returns the number of samples added since reset().
+	uint16_t samples() { return count; }
+
+	// solve() -- Solve for the calibration.
+	// Six well-spread poses (e.g. each axis up and down) are enough for
+	// offset and scale. Cross-axis terms need at least nine, including some
+	// tilted ones. solve() can be called again after more samples are added.
+	// Input:
+	//	- cal = Where the result will be stored, ready for setAccelCal().
+	//	- crossAxis = Also fit the cross-axis (misalignment) terms.
+	// Output: false if the poses don't constrain the fit (too few, or too
+	//	similar). cal is left untouched in that case.
+	bool solve(LSM9DS0_accel_cal & cal, bool crossAxis = false);
+
+private:
+	// The fit is the linear least-squares ellipsoid
+	//	A11 x^2 + A22 y^2 + A33 z^2 + 2A12 xy + 2A13 xz + 2A23 yz
+	//		+ b1 x + b2 y + b3 z = 1
+	// N holds the packed lower triangle of the 9x9 normal matrix and r the
+	// right-hand side, so memory use doesn't grow with the sample count.
+	float N[45];
+	float r[9];
+	uint16_t count;
+};
+
+#endif // __SFE_LSM9DS0_ACCELCAL_H__ //
@@ -0,0 +1,284 @@
+/******************************************************************************
+SFE_LSM9DS0_Align.cpp
+SFE_LSM9DS0 Library Multi-Rate Sample Alignment
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the alignment stage declared in SFE_LSM9DS0_Align.h. Gyro
+samples wait in a ring; each accel or mag sample, taken in time order,
+fills in the waiting gyro samples up to its own time, so only the two
+newest samples of each need to be kept.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Align.h"
+#include <string.h>
+
+// since() -- a - b, in microseconds, correct across micros()' wrap.
+static inline int32_t since(uint32_t a, uint32_t b)
+{
+	return (int32_t) (a - b);
+}
+
+// sampleTime() -- When sample i of count in a frame was taken, given when
+// the last one was.
+static inline uint32_t sampleTime(uint32_t last, float period, uint8_t count,
+								  uint8_t i)
+{
+	return last - (uint32_t) ((count - 1 - i) * period + 0.5f);
+}
+
+LSM9DS0Align::LSM9DS0Align(uint32_t maxLatencyUs)
+{
+	begin(maxLatencyUs);
+}
+
+void LSM9DS0Align::begin(uint32_t maxLatencyUs)
+{
+	maxLatency = maxLatencyUs;
+	memset(timeline, 0, sizeof(timeline));
+	memset(res, 0, sizeof(res));
+	memset(history, 0, sizeof(history));
+	head = count = 0;
+	filled[SENSOR_A] = filled[SENSOR_M] = 0;
+	awaited = (1 << SENSOR_A) | (1 << SENSOR_M);
+	drops = 0;
+}
+
+uint32_t LSM9DS0Align::stamp(Timeline & tl, float odr, uint8_t n, uint8_t later,
+							 uint32_t now, bool restart)
+{
+	if (odr <= 0)
+	{
+		tl.valid = false;
+		return now;
+	}
+	float period = 1e6f / odr;
+	// On average, the newest sample is half a period old when it's read,
+	// and any left in the FIFO were taken after the frame's last one.
+	uint32_t measured = now - (uint32_t) ((later + 0.5f) * period);
+	if (!tl.valid || restart || period != tl.period)
+	{
+		tl.valid = true;
+		tl.period = period;
+		tl.last = measured;
+		return tl.last;
+	}
+	// Carry on by the samples read, and take out 1/8 of the drift.
+	uint32_t predicted = tl.last + (uint32_t) (n * period + 0.5f);
+	int32_t error = since(measured, predicted);
+	if (error > 2 * period || error < -2 * period)
+		tl.last = measured; // Samples were lost, or the ODR changed
+	else
+		tl.last = predicted + error / 8;
+	return tl.last;
+}
+
+// scaleTicks() -- Multiply a raw sample by k, saturating.
+static void scaleTicks(int16_t * v, float k)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		float r = v[i] * k;
+		v[i] = (r >= 32767) ? 32767 : (r <= -32768) ? -32768 :
+			   (int16_t) (r < 0 ? r - 0.5f : r + 0.5f);
+	}
+}
+
+void LSM9DS0Align::convert(uint8_t sensor, float newRes)
+{
+	float k = res[sensor] / newRes;
+	res[sensor] = newRes;
+	if (!(k > 0) || k == 1)
+		return; // First frame, or no change
+	for (uint8_t i = 0; i < count; i++)
+	{
+		LSM9DS0_aligned & s = entries[(head + i) % LSM9DS0_ALIGN_PENDING].s;
+		scaleTicks(sensor == 0 ? s.g : sensor == 1 ? s.a : s.m, k);
+	}
+	if (sensor)
+	{
+		History & h = history[sensor == 1 ? SENSOR_A : SENSOR_M];
+		scaleTicks(h.v[0], k);
+		scaleTicks(h.v[1], k);
+	}
+}
+
+void LSM9DS0Align::push(uint8_t sensor, uint32_t t, int16_t x, int16_t y, int16_t z)
+{
+	History & h = history[sensor];
+	h.t[0] = h.t[1];
+	memcpy(h.v[0], h.v[1], sizeof(h.v[0]));
+	h.t[1] = t;
+	h.v[1][0] = x;
+	h.v[1][1] = y;
+	h.v[1][2] = z;
+	if (h.n < 2)
+		h.n++;
+	fill(sensor);
+}
+
+void LSM9DS0Align::fill(uint8_t sensor)
+{
+	const History & h = history[sensor];
+	uint8_t bit = 1 << sensor;
+	while (h.n && filled[sensor] < count)
+	{
+		Entry & e = entries[(head + filled[sensor]) % LSM9DS0_ALIGN_PENDING];
+		if (since(e.s.timestamp, h.t[1]) > 0)
+			break; // The sensor hasn't got this far yet
+		int16_t * v = (sensor == SENSOR_A) ? e.s.a : e.s.m;
+		int32_t span = since(h.t[1], h.t[0]);
+		int32_t into = since(e.s.timestamp, h.t[0]);
+		if (h.n == 2 && span > 0 && into >= 0)
+		{
+			float f = (float) into / span;
+			for (int k = 0; k < 3; k++)
+			{
+				float d = f * (h.v[1][k] - h.v[0][k]);
+				v[k] = h.v[0][k] + (int16_t) (d < 0 ? d - 0.5f : d + 0.5f);
+			}
+		}
+		else
+		{
+			// Older than both samples (e.g. the first ones): use the oldest.
+			uint8_t oldest = (h.n == 2 && into < 0) ? 0 : 1;
+			memcpy(v, h.v[oldest], sizeof(h.v[0]));
+			e.s.flags |= (sensor == SENSOR_A) ? LSM9DS0_ALIGN_A_HELD
+											  : LSM9DS0_ALIGN_M_HELD;
+		}
+		e.have |= bit;
+		filled[sensor]++;
+	}
+}
+
+void LSM9DS0Align::append(uint32_t t, int16_t x, int16_t y, int16_t z,
+						  LSM9DS0_aligned * out, uint8_t maxOut, uint8_t & n)
+{
+	if (count == LSM9DS0_ALIGN_PENDING)
+		emit(true, t, out, maxOut, n);
+	Entry & e = entries[(head + count) % LSM9DS0_ALIGN_PENDING];
+	memset(&e, 0, sizeof(e));
+	e.s.timestamp = t;
+	e.s.g[0] = x;
+	e.s.g[1] = y;
+	e.s.g[2] = z;
+	count++;
+	fill(SENSOR_A);
+	fill(SENSOR_M);
+}
+
+bool LSM9DS0Align::emit(bool force, uint32_t now, LSM9DS0_aligned * out,
+						uint8_t maxOut, uint8_t & n)
+{
+	if (!count)
+		return false;
+	Entry & e = entries[head];
+	bool complete = (e.have & awaited) == awaited;
+	bool expired = since(now, e.s.timestamp) > (int32_t) maxLatency;
+	if (!complete && !expired && !force)
+		return false;
+	if (n < maxOut)
+	{
+		// Whatever hasn't caught up is held at its latest sample.
+		for (uint8_t sensor = SENSOR_A; sensor <= SENSOR_M; sensor++)
+		{
+			const History & h = history[sensor];
+			if ((e.have & (1 << sensor)) || !(awaited & (1 << sensor)))
+				continue;
+			if (h.n)
+				memcpy(sensor == SENSOR_A ? e.s.a : e.s.m, h.v[1], sizeof(h.v[1]));
+			e.s.flags |= (sensor == SENSOR_A) ? LSM9DS0_ALIGN_A_HELD
+											  : LSM9DS0_ALIGN_M_HELD;
+		}
+		out[n++] = e.s;
+	}
+	else if (force)
+		drops++;
+	else
+		return false; // Wait for the next call's room
+	head = (head + 1) % LSM9DS0_ALIGN_PENDING;
+	count--;
+	for (uint8_t sensor = SENSOR_A; sensor <= SENSOR_M; sensor++)
+	{
+		if (filled[sensor])
+			filled[sensor]--;
+	}
+	return true;
+}
+
+uint8_t LSM9DS0Align::addFrame(const LSM9DS0_frame & frame, LSM9DS0_aligned * out,
+							   uint8_t maxOut)
+{
+	const LSM9DS0_frame_header & h = frame.header;
+	uint32_t now = (uint32_t) h.timestamp;
+	uint8_t gn = (h.gCount < LSM9DS0_FRAME_SAMPLES) ? h.gCount : LSM9DS0_FRAME_SAMPLES;
+	uint8_t an = (h.aCount < LSM9DS0_FRAME_SAMPLES) ? h.aCount : LSM9DS0_FRAME_SAMPLES;
+	uint8_t mn = (h.mCount < LSM9DS0_FRAME_MAG_SAMPLES) ? h.mCount
+														: LSM9DS0_FRAME_MAG_SAMPLES;
+	Timeline & tg = timeline[0];
+	Timeline & ta = timeline[1];
+	Timeline & tm = timeline[2];
+	if (h.gRes > 0 && h.gRes != res[0])
+		convert(0, h.gRes);
+	if (h.aRes > 0 && h.aRes != res[1])
+		convert(1, h.aRes);
+	if (h.mRes > 0 && h.mRes != res[2])
+		convert(2, h.mRes);
+	if (gn)
+		stamp(tg, h.gOdr, gn, h.gLater, now, h.flags & LSM9DS0_FRAME_G_OVERRUN);
+	if (an)
+		stamp(ta, h.aOdr, an, h.aLater, now, h.flags & LSM9DS0_FRAME_A_OVERRUN);
+	if (mn)
+		stamp(tm, h.mOdr, mn, 0, now, false);
+	
+	// A powered-down sensor isn't waited for, and when it's back its
+	// timeline and history start over.
+	const float odrs[2] = {h.aOdr, h.mOdr};
+	Timeline * const lines[2] = {&ta, &tm};
+	for (uint8_t sensor = SENSOR_A; sensor <= SENSOR_M; sensor++)
+	{
+		if (odrs[sensor] > 0)
+			awaited |= 1 << sensor;
+		else
+		{
+			awaited &= ~(1 << sensor);
+			lines[sensor]->valid = false;
+			history[sensor].n = 0;
+		}
+	}
+
+	// Take the frame's samples in time order, so that each accel or mag
+	// sample fills in the gyro samples up to it. On a tie, the accel or mag
+	// goes first, and the gyro sample gets it as is.
+	uint8_t n = 0;
+	uint8_t gi = 0, ai = 0, mi = 0;
+	while (gi < gn || ai < an || mi < mn)
+	{
+		uint32_t g = sampleTime(tg.last, tg.period, gn, gi);
+		uint32_t a = sampleTime(ta.last, ta.period, an, ai);
+		uint32_t m = sampleTime(tm.last, tm.period, mn, mi);
+		bool aFirst = ai < an && (gi >= gn || since(a, g) <= 0) &&
+					  (mi >= mn || since(a, m) <= 0);
+		bool mFirst = !aFirst && mi < mn && (gi >= gn || since(m, g) <= 0);
+		if (aFirst)
+		{
+			push(SENSOR_A, a, frame.a[0][ai], frame.a[1][ai], frame.a[2][ai]);
+			ai++;
+		}
+		else if (mFirst)
+		{
+			push(SENSOR_M, m, frame.m[0][mi], frame.m[1][mi], frame.m[2][mi]);
+			mi++;
+		}
+		else
+		{
+			append(g, frame.g[0][gi], frame.g[1][gi], frame.g[2][gi], out, maxOut, n);
+			gi++;
+		}
+	}
+
+	while (emit(false, now, out, maxOut, n))
+		;
+	return n;
+}
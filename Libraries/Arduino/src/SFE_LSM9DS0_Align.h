@@ -0,0 +1,151 @@
+/******************************************************************************
+SFE_LSM9DS0_Align.h
+SFE_LSM9DS0 Library Multi-Rate Sample Alignment
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The gyro, accelerometer, and magnetometer each run at their own ODR, so the
+latest reading of each was taken at a different time. Fusing them as if
+they were simultaneous skews the result whenever the board moves.
+LSM9DS0Align resamples the accel and mag onto the gyro's timeline. For every
+gyro sample, it outputs one coherent 9-DoF sample:
+
+	- Sample times come from each sensor's own clock. Within a frame,
+	  samples are one ODR period apart. From frame to frame, the timeline
+	  carries on by the number of samples read, and is only nudged toward
+	  micros() (by 1/8 of the error per frame). Host jitter therefore
+	  barely moves it. An overrun, or a jump of more than two periods,
+	  restarts it from micros().
+	- The accel and mag are linearly interpolated between the two samples
+	  around each gyro sample's time.
+	- A gyro sample waits until the accel and mag have samples at or past
+	  its time. It waits at most maxLatencyUs. After that, it goes out with
+	  the latest accel or mag reading held, and is flagged. Samples only
+	  go out when a frame is added, so the worst-case latency is
+	  maxLatencyUs plus the time between frames.
+	- A sensor that's powered down (ODR 0 in the frame) isn't waited for.
+	  Its a[] or m[] is left at 0, unflagged, so a filter that skips an
+	  all-zero mag (LSM9DS0Madgwick does) runs on the gyro and accel.
+	- Output samples are raw ticks at the resolutions in the header of
+	  the frame they go out with. Samples still waiting when a frame
+	  brings a new resolution (a scale change) are converted to it.
+
+Everything is in fixed-size arrays inside the object; nothing is allocated.
+
+Typical use:
+	LSM9DS0Align align(20000);	// Wait at most 20 ms for the accel and mag
+	LSM9DS0_aligned out[LSM9DS0_FRAME_SAMPLES];
+	...
+	dof.readFrame(frame);
+	uint8_t n = align.addFrame(frame, out, LSM9DS0_FRAME_SAMPLES);
+	for (uint8_t i = 0; i < n; i++)
+		... fuse out[i] ...
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_ALIGN_H__
+#define __SFE_LSM9DS0_ALIGN_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Gyro samples that can wait for the accel and mag (at most 255). Beyond
+// this, the oldest goes out early, held, so it should cover maxLatencyUs of
+// gyro samples: 192 is 250 ms at 760 Hz.
+#ifndef LSM9DS0_ALIGN_PENDING
+#if defined(__AVR__)
+#define LSM9DS0_ALIGN_PENDING	16
+#else
+#define LSM9DS0_ALIGN_PENDING	192
+#endif
+#endif
+
+// LSM9DS0_aligned flags.
+#define LSM9DS0_ALIGN_A_HELD	0x01	// a[] is the latest accel sample, not
+										// one interpolated at timestamp
+#define LSM9DS0_ALIGN_M_HELD	0x02	// The same, for m[]
+
+// LSM9DS0_aligned -- One gyro sample, with the accel and mag at its time.
+struct LSM9DS0_aligned
+{
+	uint32_t timestamp;		// micros() the gyro sample was taken at
+	int16_t g[3];			// Raw ticks, at the latest frame's resolutions
+	int16_t a[3];
+	int16_t m[3];
+	uint8_t flags;			// LSM9DS0_ALIGN_* flags
+};
+
+class LSM9DS0Align
+{
+public:
+	// LSM9DS0Align -- Constructor. Same as begin().
+	LSM9DS0Align(uint32_t maxLatencyUs = 50000);
+
+	// begin() -- Start over, forgetting every sample.
+	// Input:
+	//	- maxLatencyUs = Longest a gyro sample waits for the accel and mag,
+	//	  in microseconds, counted from when it was taken.
+	void begin(uint32_t maxLatencyUs);
+
+	// addFrame() -- Add a frame's samples, and output the aligned samples
+	// that are ready, oldest first.
+	// Input:
+	//	- frame = A frame from readFrame(), the next one for this device.
+	//	- out = Where the aligned samples are stored.
+	//	- maxOut = Room in out. Samples that don't fit wait for the next
+	//	  call (and are dropped if there's no room for them there either).
+	// Output: The number of samples stored in out.
+	uint8_t addFrame(const LSM9DS0_frame & frame, LSM9DS0_aligned * out,
+					 uint8_t maxOut);
+
+	// pending() -- Gyro samples still waiting.
+	uint8_t pending() { return count; }
+
+	// dropped() -- Gyro samples discarded because there was no room.
+	uint32_t dropped() { return drops; }
+
+private:
+	enum { SENSOR_A, SENSOR_M };
+
+	// Timeline -- When a sensor's newest sample was taken.
+	struct Timeline
+	{
+		uint32_t last;		// micros() of the newest sample
+		float period;		// Microseconds between samples
+		bool valid;
+	};
+
+	// History -- A sensor's two newest samples, to interpolate between.
+	struct History
+	{
+		uint32_t t[2];		// Previous, current
+		int16_t v[2][3];
+		uint8_t n;			// Samples seen, up to 2
+	};
+
+	struct Entry
+	{
+		LSM9DS0_aligned s;
+		uint8_t have;		// Bit per sensor: a[] or m[] filled in
+	};
+
+	uint32_t stamp(Timeline & tl, float odr, uint8_t n, uint8_t later,
+				   uint32_t now, bool restart);
+	void convert(uint8_t sensor, float newRes);
+	void push(uint8_t sensor, uint32_t t, int16_t x, int16_t y, int16_t z);
+	void fill(uint8_t sensor);
+	void append(uint32_t t, int16_t x, int16_t y, int16_t z,
+				LSM9DS0_aligned * out, uint8_t maxOut, uint8_t & n);
+	bool emit(bool force, uint32_t now, LSM9DS0_aligned * out, uint8_t maxOut,
+			  uint8_t & n);
+
+	uint32_t maxLatency;
+	Timeline timeline[3];	// Gyro, accel, mag
+	float res[3];			// Their resolutions in the last frame
+	History history[2];		// SENSOR_A, SENSOR_M
+	Entry entries[LSM9DS0_ALIGN_PENDING];
+	uint8_t head, count;
+	uint8_t filled[2];		// Entries from head with each sensor filled in
+	uint8_t awaited;		// Bit per sensor: running, so worth waiting for
+	uint32_t drops;
+};
+
+#endif // __SFE_LSM9DS0_ALIGN_H__ //
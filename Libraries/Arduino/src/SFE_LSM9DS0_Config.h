@@ -0,0 +1,71 @@
+/******************************************************************************
+SFE_LSM9DS0_Config.h
+SFE_LSM9DS0 Library Build Configuration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Everything the LSM9DS0 class can leave out at compile time, for boards where
+every byte counts (an ATmega328 has 2 KB of RAM and 32 KB of flash). Edit
+the defaults here, or define them on the compiler's command line (e.g.
+-DLSM9DS0_USE_SPI=0). Each is 1 (in) or 0 (out). What a feature costs on a
+given compiler is reported by `make footprint` in the Linux directory.
+
+	LSM9DS0_USE_I2C		The I2C transport (Wire).
+	LSM9DS0_USE_SPI		The SPI transport. At least one of the two must
+						be in.
+	LSM9DS0_USE_FLOAT	gRes, aRes, mRes, calcGyro(), calcAccel(),
+						calcMag(), and setGyroHPF(). Without it, readings
+						stay in raw ticks; readFrame() still fills the
+						frame header's float fields.
+	LSM9DS0_USE_CAL		gbias, abias, calLSM9DS0(), the accelerometer
+						calibration, and selfTest(). Needs LSM9DS0_USE_FLOAT.
+	LSM9DS0_USE_TEMP	readTemp(), temperature, and the temperature sensor
+						itself (TEMP_EN), which is otherwise left off.
+	LSM9DS0_USE_FRAME	initFrame(), readFrame(), and the FIFO epoch queue
+						behind them (LSM9DS0_EPOCH_DEPTH).
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_CONFIG_H__
+#define __SFE_LSM9DS0_CONFIG_H__
+
+#ifndef LSM9DS0_USE_I2C
+#define LSM9DS0_USE_I2C		1
+#endif
+#ifndef LSM9DS0_USE_SPI
+#define LSM9DS0_USE_SPI		1
+#endif
+#ifndef LSM9DS0_USE_FLOAT
+#define LSM9DS0_USE_FLOAT	1
+#endif
+#ifndef LSM9DS0_USE_CAL
+#define LSM9DS0_USE_CAL		LSM9DS0_USE_FLOAT
+#endif
+#ifndef LSM9DS0_USE_TEMP
+#define LSM9DS0_USE_TEMP	1
+#endif
+#ifndef LSM9DS0_USE_FRAME
+#define LSM9DS0_USE_FRAME	1
+#endif
+
+// Set LSM9DS0_STATS to 1 (here, or with -DLSM9DS0_STATS=1) to count and time
+// every bus transaction; see getStats(). With 0, the instrumentation
+// compiles away entirely.
+#ifndef LSM9DS0_STATS
+#define LSM9DS0_STATS	0
+#endif
+
+// Earlier configurations whose samples can wait in each FIFO at once, for
+// readFrame() to label (see setGyroScale()). Changes beyond this between
+// two readFrame()s are labelled as the last one kept.
+#ifndef LSM9DS0_EPOCH_DEPTH
+#define LSM9DS0_EPOCH_DEPTH	2
+#endif
+
+#if !LSM9DS0_USE_I2C && !LSM9DS0_USE_SPI
+#error "SFE_LSM9DS0: LSM9DS0_USE_I2C and LSM9DS0_USE_SPI are both 0"
+#endif
+#if LSM9DS0_USE_CAL && !LSM9DS0_USE_FLOAT
+#error "SFE_LSM9DS0: LSM9DS0_USE_CAL needs LSM9DS0_USE_FLOAT"
+#endif
+
+#endif // __SFE_LSM9DS0_CONFIG_H__ //
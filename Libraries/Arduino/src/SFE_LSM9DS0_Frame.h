@@ -0,0 +1,182 @@
+/******************************************************************************
+SFE_LSM9DS0_Frame.h
+SFE_LSM9DS0 Library Sample Frame Layout
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+LSM9DS0_frame is one batch of samples -- typically a drain of both FIFOs
+and a mag reading -- in a fixed, versioned layout that can be placed
+directly in shared memory or a DMA buffer and read there, in place, by
+another process or core. LSM9DS0::readFrame() fills one.
+
+	- It's plain data: no pointers, no constructors, no implicit padding.
+	- Samples are stored as a struct of arrays, one array per axis, so a
+	  consumer working on one axis touches only that axis's cache lines.
+	  The header and each sensor's arrays start on their own cache line.
+	- The header carries everything needed to interpret the raw samples:
+	  scales and resolutions, output data rates, biases, and counts.
+	  All of a frame's samples of one sensor were taken under the same
+	  configuration, numbered by that sensor's epoch (see setGyroScale()):
+	  a frame ends at a change, and the rest follows in the next.
+	- A generation counter makes it a seqlock. The writer makes it odd
+	  while it's writing and even when it's done, so a reader can use the
+	  frame in place and then check it wasn't rewritten underneath it:
+
+	uint32_t gen = getLSM9DS0FrameGeneration(frame);
+	... use frame.g, frame.a, frame.m ...
+	if (!checkLSM9DS0FrameGeneration(frame, gen))
+		... discard what was computed ...
+
+This header doesn't depend on the driver, so a consumer needs nothing else.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_FRAME_H__
+#define __SFE_LSM9DS0_FRAME_H__
+
+#include <stdint.h>
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+#define LSM9DS0_FRAME_MAGIC		0x464D534C	// "LSMF"
+#define LSM9DS0_FRAME_VERSION	1
+
+// Gyro and accel samples per frame. Samples beyond this stay in the FIFO
+// for the next frame.
+#ifndef LSM9DS0_FRAME_SAMPLES
+#if defined(__AVR__)
+#define LSM9DS0_FRAME_SAMPLES	8
+#else
+#define LSM9DS0_FRAME_SAMPLES	32
+#endif
+#endif
+
+// Mag samples per frame. readFrame() stores at most one, since the mag has
+// no FIFO, but other writers may batch more.
+#ifndef LSM9DS0_FRAME_MAG_SAMPLES
+#if defined(__AVR__)
+#define LSM9DS0_FRAME_MAG_SAMPLES	1
+#else
+#define LSM9DS0_FRAME_MAG_SAMPLES	4
+#endif
+#endif
+
+// Alignment of the frame and of each sensor's arrays. There's no cache on
+// an AVR, so there it's 1 and the frame is packed.
+#ifndef LSM9DS0_FRAME_ALIGN
+#if defined(__AVR__)
+#define LSM9DS0_FRAME_ALIGN		1
+#else
+#define LSM9DS0_FRAME_ALIGN		64
+#endif
+#endif
+#define LSM9DS0_FRAME_ALIGNED	__attribute__((aligned(LSM9DS0_FRAME_ALIGN)))
+
+// Header flags.
+#define LSM9DS0_FRAME_G_OVERRUN	0x01	// Gyro FIFO overran since the last frame
+#define LSM9DS0_FRAME_A_OVERRUN	0x02	// Accel FIFO overran since the last frame
+#define LSM9DS0_FRAME_A_CAL		0x04	// aCal was in use (see calcAccelCal())
+#define LSM9DS0_FRAME_BUS_ERROR	0x08	// A read failed; the counts only cover
+										// samples read intact
+#define LSM9DS0_FRAME_MORE		0x10	// Samples were left in a FIFO (see
+										// gLater, aLater): read another frame
+
+struct LSM9DS0_frame_header
+{
+	uint32_t magic;			// LSM9DS0_FRAME_MAGIC
+	uint16_t version;		// LSM9DS0_FRAME_VERSION
+	uint16_t size;			// sizeof(LSM9DS0_frame), as built by the writer
+	uint32_t generation;	// Odd while the frame is being written
+	uint32_t sequence;		// Frames written, including this one
+	uint64_t timestamp;		// micros() when the frame was read
+	float gOdr, aOdr, mOdr;	// Output data rates, in Hz
+	float gRes, aRes, mRes;	// DPS, g's, and Gs per raw tick
+	uint8_t gScale, aScale, mScale;	// gyro_scale, accel_scale, mag_scale
+	uint8_t gCount, aCount, mCount;	// Valid samples in g[], a[], and m[]
+	uint8_t flags;			// LSM9DS0_FRAME_* flags
+	uint8_t reserved0;
+	int16_t temperature;	// Raw temperature, as LSM9DS0::temperature
+	uint8_t gLater, aLater;	// Newer samples left in each FIFO, e.g. taken
+							// after a configuration change
+	float gbias[3];			// Gyro biases, in DPS
+	float abias[3];			// Accel biases, in g's
+	uint8_t gEpoch, aEpoch, mEpoch;	// Configuration the samples were taken
+									// under; changes with res, scale, or ODR
+	uint8_t reserved2;
+};
+
+// Each array is indexed [axis][sample], oldest sample first. Sample i of a
+// gyro or accel was taken about (count - 1 - i + later) / ODR seconds before
+// timestamp (with gLater or aLater), and the mag's at (count - 1 - i) / ODR.
+struct LSM9DS0_frame
+{
+	LSM9DS0_frame_header header;
+	int16_t g[3][LSM9DS0_FRAME_SAMPLES] LSM9DS0_FRAME_ALIGNED;
+	int16_t a[3][LSM9DS0_FRAME_SAMPLES] LSM9DS0_FRAME_ALIGNED;
+	int16_t m[3][LSM9DS0_FRAME_MAG_SAMPLES] LSM9DS0_FRAME_ALIGNED;
+} LSM9DS0_FRAME_ALIGNED;
+
+// The header is the same everywhere: 88 bytes, with no padding.
+typedef char lsm9ds0_frame_header_is_88_bytes[sizeof(LSM9DS0_frame_header) == 88 ? 1 : -1];
+
+// getLSM9DS0FrameGeneration() -- Start reading a frame in place.
+// Output: The generation to hand to checkLSM9DS0FrameGeneration().
+static inline uint32_t getLSM9DS0FrameGeneration(const LSM9DS0_frame & frame)
+{
+#if defined(__AVR__)
+	// An 8-bit MCU reads 32 bits a byte at a time; keep the writer (an
+	// ISR) out while it does.
+	uint8_t sreg = SREG;
+	cli();
+	uint32_t gen = *(volatile const uint32_t *) &frame.header.generation;
+	SREG = sreg;
+	return gen;
+#else
+	return __atomic_load_n(&frame.header.generation, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// checkLSM9DS0FrameGeneration() -- Finish reading a frame in place.
+// Output: true if the frame was complete when the generation was read and
+//	hasn't been rewritten since, so what was read from it is consistent.
+static inline bool checkLSM9DS0FrameGeneration(const LSM9DS0_frame & frame,
+											   uint32_t generation)
+{
+#if !defined(__AVR__)
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+	return !(generation & 1) && getLSM9DS0FrameGeneration(frame) == generation;
+}
+
+// startLSM9DS0FrameWrite() -- Mark a frame as being written (odd).
+static inline void startLSM9DS0FrameWrite(LSM9DS0_frame & frame)
+{
+	uint32_t gen = getLSM9DS0FrameGeneration(frame);
+	gen += 1 + (gen & 1); // Odd, and always different from before
+#if defined(__AVR__)
+	uint8_t sreg = SREG;
+	cli();
+	*(volatile uint32_t *) &frame.header.generation = gen;
+	SREG = sreg;
+#else
+	__atomic_store_n(&frame.header.generation, gen, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+// finishLSM9DS0FrameWrite() -- Publish a frame written since the last
+// startLSM9DS0FrameWrite() (even).
+static inline void finishLSM9DS0FrameWrite(LSM9DS0_frame & frame)
+{
+	uint32_t gen = getLSM9DS0FrameGeneration(frame) + 1;
+#if defined(__AVR__)
+	uint8_t sreg = SREG;
+	cli();
+	*(volatile uint32_t *) &frame.header.generation = gen;
+	SREG = sreg;
+#else
+	__atomic_store_n(&frame.header.generation, gen, __ATOMIC_RELEASE);
+#endif
+}
+
+#endif // __SFE_LSM9DS0_FRAME_H__ //
@@ -0,0 +1,156 @@
+/******************************************************************************
+SFE_LSM9DS0_Heading.cpp
+SFE_LSM9DS0 Library Fast Tilt-Compensated Heading
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the functions declared in SFE_LSM9DS0_Heading.h. With the roll
+phi and pitch theta from the accel, the mag reading turned back to level
+gives the heading psi (as in Freescale's AN4248, for z up):
+
+	phi   = atan2(ay, az)
+	theta = atan2(ax, sqrt(ay^2 + az^2))
+	psi   = atan2(my cos(phi) - mz sin(phi),
+				  mx cos(theta) - (my sin(phi) + mz cos(phi)) sin(theta))
+
+The float version folds the sines and cosines into the atan2() arguments,
+which leaves two sqrt()s and no trig. The fixed-point version works them
+out in Q15, from integer square roots.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Heading.h"
+#include "SFE_LSM9DS0_IntMath.h"
+
+#ifdef __AVR__
+  #include <avr/pgmspace.h>
+  #define LSM9DS0_TABLE(x)	pgm_read_word(&(x))
+#else
+  #define PROGMEM
+  #define LSM9DS0_TABLE(x)	(x)
+#endif
+
+// atan(i / 64), i = 0 to 64, in eighths of a hundredth of a degree. With
+// linear interpolation in between, the worst error is 0.0013 degrees;
+// rounding to hundredths adds up to another 0.005.
+static const uint16_t atanTable[65] PROGMEM = {
+	0, 716, 1432, 2147, 2861, 3574, 4285, 4994, 5700, 6404, 7105, 7802, 8496,
+	9186, 9871, 10552, 11229, 11901, 12567, 13228, 13883, 14533, 15176,
+	15814, 16445, 17069, 17688, 18299, 18904, 19501, 20092, 20676, 21252,
+	21821, 22384, 22939, 23486, 24027, 24560, 25086, 25604, 26116, 26620,
+	27117, 27607, 28090, 28565, 29034, 29496, 29951, 30399, 30840, 31275,
+	31703, 32125, 32540, 32949, 33351, 33748, 34138, 34522, 34900, 35272,
+	35639, 36000};
+
+// divide() -- n << 15 / d, rounded, for |n| <= d < 2^16 (so within Q15).
+static int32_t divide(int32_t n, uint16_t d)
+{
+	n <<= 15;
+	return (n + ((n < 0) ? -(int32_t) (d >> 1) : (int32_t) (d >> 1))) / d;
+}
+
+float LSM9DS0Heading::fastAtan2(float y, float x)
+{
+	float ux = fabs(x), uy = fabs(y);
+	if (ux == 0 && uy == 0)
+		return 0;
+	bool swap = uy > ux;
+	float t = swap ? ux / uy : uy / ux; // 0 to 1
+	float t2 = t * t;
+	float a = t * (0.9998660f + t2 * (-0.3302995f + t2 * (0.1801410f +
+			  t2 * (-0.0851330f + t2 * 0.0208351f))));
+	a *= 180.0f / PI;
+	if (swap)
+		a = 90.0f - a;
+	if (x < 0)
+		a = 180.0f - a;
+	return (y < 0) ? -a : a;
+}
+
+float LSM9DS0Heading::fastAsin(float x)
+{
+	float ux = fabs(x);
+	if (ux > 1.0f)
+		ux = 1.0f;
+	float a = 90.0f - sqrt(1.0f - ux) * (1.5707288f + ux * (-0.2121144f +
+			  ux * (0.0742610f - ux * 0.0187293f))) * (180.0f / PI);
+	return (x < 0) ? -a : a;
+}
+
+int16_t LSM9DS0Heading::fixedAtan2(int32_t y, int32_t x)
+{
+	uint32_t ux = (x < 0) ? -(uint32_t) x : x;
+	uint32_t uy = (y < 0) ? -(uint32_t) y : y;
+	bool swap = uy > ux;
+	uint32_t lo = swap ? ux : uy, hi = swap ? uy : ux;
+	if (!hi)
+		return 0;
+	// Keep lo << 15 within 32 bits; the ratio only needs 16 bits of each.
+	while (hi > 0xFFFF)
+	{
+		hi >>= 1;
+		lo >>= 1;
+	}
+	uint16_t t = (lo << 15) / hi; // Q15, 0 to 32768
+	uint8_t i = t >> 9;
+	uint16_t a = LSM9DS0_TABLE(atanTable[i]);
+	if (i < 64)
+		a += ((uint32_t) (LSM9DS0_TABLE(atanTable[i + 1]) - a) * (t & 0x1FF) +
+			  0x100) >> 9;
+	int16_t cd = (a + 4) >> 3; // 0 to 4500
+	if (swap)
+		cd = 9000 - cd;
+	if (x < 0)
+		cd = 18000 - cd;
+	return (y < 0) ? -cd : cd;
+}
+
+bool LSM9DS0Heading::attitude(float ax, float ay, float az, float mx,
+							  float my, float mz, LSM9DS0_attitude & out)
+{
+	float r2 = ay * ay + az * az;
+	float norm2 = r2 + ax * ax;
+	if (norm2 == 0)
+		return false;
+	float r = sqrt(r2);
+	out.roll = fastAtan2(ay, az);
+	out.pitch = fastAtan2(ax, r);
+	// psi's arguments, both times r |a| (which is positive):
+	float heading = fastAtan2((my * az - mz * ay) * sqrt(norm2),
+							  mx * r2 - ax * (my * ay + mz * az));
+	out.heading = (heading < 0) ? heading + 360.0f : heading;
+	return true;
+}
+
+bool LSM9DS0Heading::attitude(int16_t ax, int16_t ay, int16_t az, int16_t mx,
+							  int16_t my, int16_t mz, LSM9DS0_attitude_cd & out)
+{
+	// Each square is at most 2^30, so all three add up within 32 bits.
+	uint32_t r2 = (uint32_t) ((int32_t) ay * ay) + (uint32_t) ((int32_t) az * az);
+	uint32_t norm2 = r2 + (uint32_t) ((int32_t) ax * ax);
+	if (!norm2)
+		return false;
+	uint16_t r = lsm9ds0Isqrt(r2), norm = lsm9ds0Isqrt(norm2);
+	out.roll = fixedAtan2(ay, az);
+	out.pitch = fixedAtan2(ax, r);
+
+	// Sines and cosines of roll and pitch, in Q15. Straight up or down, the
+	// roll is undefined; call it 0.
+	int32_t sr = 0, cr = 32768;
+	if (r)
+	{
+		sr = divide(ay, r);
+		cr = divide(az, r);
+	}
+	int32_t sp = divide(ax, norm);
+	int32_t cp = divide(r, norm);
+
+	// psi's arguments, in Q15. Each is a rotation of a vector of at most
+	// 2^15 * sqrt(3), so stays under 2^31.
+	int32_t y = (int32_t) my * cr - (int32_t) mz * sr;
+	int32_t t = ((int32_t) my * sr + (int32_t) mz * cr + 0x4000) >> 15;
+	int32_t x = (int32_t) mx * cp - t * sp;
+	int16_t heading = fixedAtan2(y, x);
+	out.heading = (heading < 0) ? heading + 36000 : heading;
+	return true;
+}
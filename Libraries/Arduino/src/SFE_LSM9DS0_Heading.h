@@ -0,0 +1,79 @@
+/******************************************************************************
+SFE_LSM9DS0_Heading.h
+SFE_LSM9DS0 Library Fast Tilt-Compensated Heading
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Heading, pitch, and roll straight from one accel and one mag reading, for
+loops that can't afford libm's atan2(), asin(), and trig on an 8 MHz AVR
+(or don't need a fusion filter). The tilt comes from the accel alone, so
+it's only right while the board isn't accelerating.
+
+Two versions:
+	- float: LSM9DS0Heading::attitude(ax, ay, az, mx, my, mz, out), in
+	  degrees, on a polynomial atan2(). Error under 0.001 degrees.
+	- Fixed-point: the same on raw int16_t readings, in hundredths of a
+	  degree, on a 65-entry table with linear interpolation and no floats
+	  at all. Error under 0.02 degrees.
+Both take the accel and mag in any units (raw ticks or calcAccel() and
+calcMag() output), as long as each is consistent across its three axes.
+
+Angles are for a board with x forward and z up, as the LSM9DS0's axes are
+printed (the accel and mag share them):
+	- heading: clockwise from magnetic north, seen from above, 0 to 360.
+	  Add the local declination for true north.
+	- pitch: nose (+x) up is positive, -90 to 90.
+	- roll: +y (left) side up is positive, -180 to 180.
+
+lsm9ds0_headingbench (Linux) checks the error bounds against libm, and the
+SparkFun_LSM9DS0_Heading example prints the cycles per call on the board.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_HEADING_H__
+#define __SFE_LSM9DS0_HEADING_H__
+
+#include "SFE_LSM9DS0.h"
+
+// LSM9DS0_attitude -- attitude() output, in degrees.
+struct LSM9DS0_attitude
+{
+	float heading;
+	float pitch;
+	float roll;
+};
+
+// LSM9DS0_attitude_cd -- attitude() output, in hundredths of a degree.
+struct LSM9DS0_attitude_cd
+{
+	uint16_t heading;		// 0 to 35999
+	int16_t pitch;
+	int16_t roll;
+};
+
+class LSM9DS0Heading
+{
+public:
+	// fastAtan2() -- atan2(y, x), in degrees, -180 to 180. 0 if both are 0.
+	// A 9th-order polynomial (Abramowitz and Stegun 4.4.49) on the ratio of
+	// the smaller to the larger: error under 0.001 degrees.
+	static float fastAtan2(float y, float x);
+
+	// fastAsin() -- asin(x), in degrees, for x in -1 to 1 (clamped). A cubic
+	// times sqrt(1 - |x|) (Abramowitz and Stegun 4.4.45): error under
+	// 0.004 degrees.
+	static float fastAsin(float x);
+
+	// fixedAtan2() -- atan2(y, x), in hundredths of a degree, -18000 to
+	// 18000, without floats. 0 if both are 0. Error under 0.01 degrees.
+	static int16_t fixedAtan2(int32_t y, int32_t x);
+
+	// attitude() -- Tilt-compensated heading, pitch, and roll, from an
+	// accel and a mag reading taken together.
+	// Output: false (and out unchanged) if the accel reading is all zeros.
+	static bool attitude(float ax, float ay, float az, float mx, float my,
+						 float mz, LSM9DS0_attitude & out);
+	static bool attitude(int16_t ax, int16_t ay, int16_t az, int16_t mx,
+						 int16_t my, int16_t mz, LSM9DS0_attitude_cd & out);
+};
+
+#endif // __SFE_LSM9DS0_HEADING_H__ //
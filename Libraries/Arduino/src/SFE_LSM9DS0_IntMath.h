@@ -0,0 +1,36 @@
+/******************************************************************************
+SFE_LSM9DS0_IntMath.h
+SFE_LSM9DS0 Library Integer Math Helpers
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Small integer routines shared by the fixed-point modules (LSM9DS0Heading,
+LSM9DS0Motion). Internal to the library; sketches needn't include it.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_INTMATH_H__
+#define __SFE_LSM9DS0_INTMATH_H__
+
+#include <stdint.h>
+
+// lsm9ds0Isqrt() -- sqrt(n), rounded, bit by bit.
+inline uint16_t lsm9ds0Isqrt(uint32_t n)
+{
+	uint32_t root = 0, bit = 1UL << 30;
+	while (bit > n)
+		bit >>= 2;
+	while (bit)
+	{
+		if (n >= root + bit)
+		{
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return (n > root) ? root + 1 : root; // n is what's left over root^2
+}
+
+#endif // __SFE_LSM9DS0_INTMATH_H__ //
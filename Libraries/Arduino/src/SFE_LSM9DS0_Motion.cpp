@@ -0,0 +1,218 @@
+/******************************************************************************
+SFE_LSM9DS0_Motion.cpp
+SFE_LSM9DS0 Library On-Device Motion Classification
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements LSM9DS0Motion. Each sample is turned into milli-g's once, less
+the gravity reference, and only added into the window's sums; the square
+roots and the one division per feature wait for the end of the window.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Motion.h"
+#include "SFE_LSM9DS0_IntMath.h"
+
+// Fails to compile if LSM9DS0_MOTION_WINDOW is out of range.
+typedef char lsm9ds0_motion_window_in_range[(LSM9DS0_MOTION_WINDOW >= 8 &&
+											 LSM9DS0_MOTION_WINDOW <= 128) ? 1 : -1];
+
+const LSM9DS0_motion_node LSM9DS0Motion::defaultModel[] = {
+	{LSM9DS0_FEATURE_PEAK, 1800, 1, LSM9DS0_MOTION_LEAF | LSM9DS0_MOTION_IMPACT},
+	{LSM9DS0_FEATURE_RMS, 40, LSM9DS0_MOTION_LEAF | LSM9DS0_MOTION_IDLE, 2},
+	{LSM9DS0_FEATURE_FREQUENCY, 40, LSM9DS0_MOTION_LEAF | LSM9DS0_MOTION_WALKING,
+	 LSM9DS0_MOTION_LEAF | LSM9DS0_MOTION_VIBRATING},
+};
+const uint8_t LSM9DS0Motion::defaultModelSize =
+	sizeof(defaultModel) / sizeof(defaultModel[0]);
+
+LSM9DS0Motion::LSM9DS0Motion()
+{
+	setModel(NULL, 0);
+	begin(100, 2.0 / 32768.0);
+}
+
+void LSM9DS0Motion::begin(float sampleRate, float res)
+{
+	scale = (uint16_t) (res * 1000 * 65536 + 0.5);
+	hertz10 = (uint16_t) (sampleRate * 10 + 0.5);
+	for (uint8_t k = 0; k < 3; k++)
+	{
+		ref[k] = 0;
+		sum[k] = 0;
+		sumSq[k] = 0;
+		crossings[k] = 0;
+		side[k] = 0;
+	}
+	peakSq = 0;
+	fill = 0;
+	primed = false;
+	current = pending = LSM9DS0_MOTION_IDLE;
+	pendingCount = 0;
+	memset(&out, 0, sizeof(out));
+}
+
+void LSM9DS0Motion::setModel(const LSM9DS0_motion_node * nodes, uint8_t count)
+{
+	if (!nodes)
+	{
+		nodes = defaultModel;
+		count = defaultModelSize;
+	}
+	model = nodes;
+	modelSize = count;
+}
+
+bool LSM9DS0Motion::addSample(int16_t x, int16_t y, int16_t z)
+{
+	int16_t a[3] = {x, y, z};
+	if (!primed && !fill)
+		for (uint8_t k = 0; k < 3; k++)
+			ref[k] = a[k];
+
+	uint32_t mag2 = 0;
+	for (uint8_t k = 0; k < 3; k++)
+	{
+		sum[k] += a[k];
+		// Clip the difference first, so the product stays within 32 bits.
+		int32_t d = (int32_t) a[k] - ref[k];
+		if (d > 32767)
+			d = 32767;
+		else if (d < -32767)
+			d = -32767;
+		d = (d * scale) >> 16;
+		if (d > LSM9DS0_MOTION_CLIP)
+			d = LSM9DS0_MOTION_CLIP;
+		else if (d < -LSM9DS0_MOTION_CLIP)
+			d = -LSM9DS0_MOTION_CLIP;
+		uint32_t d2 = d * d;
+		sumSq[k] += d2;
+		mag2 += d2;
+
+		// A crossing is leaving one side of the dead band for the other.
+		int8_t s = (d > LSM9DS0_MOTION_DEADBAND) ? 1 :
+				   (d < -LSM9DS0_MOTION_DEADBAND) ? -1 : 0;
+		if (s && s != side[k])
+		{
+			if (side[k])
+				crossings[k]++;
+			side[k] = s;
+		}
+	}
+	if (mag2 > peakSq)
+		peakSq = mag2;
+
+	if (++fill < LSM9DS0_MOTION_WINDOW)
+		return false;
+	return finishWindow();
+}
+
+bool LSM9DS0Motion::finishWindow()
+{
+	uint32_t meanSq = 0, ms = 0, busiest = 0;
+	uint8_t axis = 0;
+	for (uint8_t k = 0; k < 3; k++)
+	{
+		ref[k] = sum[k] / fill;
+		int32_t mg = ((int32_t) ref[k] * scale) >> 16;
+		meanSq += mg * mg;
+		// Each sumSq is at most LSM9DS0_MOTION_CLIP^2 * 128, under 2^31,
+		// but the three together might not be: divide first.
+		ms += sumSq[k] / fill;
+		if (sumSq[k] > busiest)
+		{
+			busiest = sumSq[k];
+			axis = k;
+		}
+	}
+	out.mean = lsm9ds0Isqrt(meanSq);
+	out.rms = lsm9ds0Isqrt(ms);
+	out.peak = lsm9ds0Isqrt(peakSq);
+	// Two crossings per swing.
+	out.frequency = (uint32_t) crossings[axis] * hertz10 / (2 * fill);
+
+	for (uint8_t k = 0; k < 3; k++)
+	{
+		sum[k] = 0;
+		sumSq[k] = 0;
+		crossings[k] = 0;
+	}
+	peakSq = 0;
+	fill = 0;
+
+	// The first window's dynamic acceleration was against its first sample,
+	// not gravity.
+	if (!primed)
+	{
+		primed = true;
+		return false;
+	}
+	return update(classify(out, model, modelSize));
+}
+
+bool LSM9DS0Motion::update(lsm9ds0_motion window)
+{
+	if (window == current)
+	{
+		pendingCount = 0;
+		return false;
+	}
+	if (window != pending)
+	{
+		pending = window;
+		pendingCount = 0;
+	}
+	if (++pendingCount < LSM9DS0_MOTION_CONFIRM && window != LSM9DS0_MOTION_IMPACT)
+		return false;
+	current = window;
+	pendingCount = 0;
+	return true;
+}
+
+uint8_t LSM9DS0Motion::wakeThreshold(uint16_t mg)
+{
+	// One threshold step is 256 raw ticks, so scale is also mg per step in
+	// Q8.
+	uint32_t steps = (((uint32_t) mg << 8) + scale / 2) / scale;
+	if (steps < 1)
+		steps = 1;
+	return (steps > 127) ? 127 : steps;
+}
+
+lsm9ds0_motion LSM9DS0Motion::classify(const LSM9DS0_motion_features & f,
+									   const LSM9DS0_motion_node * nodes,
+									   uint8_t count)
+{
+	uint8_t i = 0;
+	// A path visits each node at most once, so a tree with a loop still ends.
+	for (uint8_t steps = 0; steps < count && i < count; steps++)
+	{
+		const LSM9DS0_motion_node & node = nodes[i];
+		int16_t value;
+		switch (node.feature)
+		{
+		case LSM9DS0_FEATURE_MEAN:
+			value = f.mean;
+			break;
+		case LSM9DS0_FEATURE_RMS:
+			value = f.rms;
+			break;
+		case LSM9DS0_FEATURE_PEAK:
+			value = f.peak;
+			break;
+		case LSM9DS0_FEATURE_FREQUENCY:
+			value = f.frequency;
+			break;
+		default:
+			return LSM9DS0_MOTION_IDLE;
+		}
+		i = (value < node.threshold) ? node.below : node.above;
+		if (i & LSM9DS0_MOTION_LEAF)
+		{
+			i &= ~LSM9DS0_MOTION_LEAF;
+			return (i <= LSM9DS0_MOTION_IMPACT) ? (lsm9ds0_motion) i :
+				   LSM9DS0_MOTION_IDLE;
+		}
+	}
+	return LSM9DS0_MOTION_IDLE;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+SFE_LSM9DS0_Motion.h
+SFE_LSM9DS0 Library On-Device Motion Classification
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+LSM9DS0Motion sorts a stream of raw accelerometer samples into idle,
+walking, vibrating, and impact, and only speaks up when that changes, so a
+node sends a byte per change of state instead of every sample.
+
+For each window of LSM9DS0_MOTION_WINDOW samples it works out, in integer
+math, the dynamic acceleration -- each sample less the previous window's
+mean, which is gravity unless the board is turning fast -- and from it:
+	- mean: |mean|, in mg (1000 at rest, near 0 in free fall).
+	- rms: RMS of the dynamic acceleration, in mg.
+	- peak: Its largest magnitude, in mg.
+	- frequency: How often the axis moving most swings back and forth
+	  (half its zero crossings, with a dead band), in tenths of a Hz.
+A small decision tree on those picks the window's state. The default tree
+is: impact if peak >= 1.8 g, else idle if rms < 40 mg, else walking below
+4 Hz and vibrating above. setModel() takes another one, e.g. trained on
+features() logged from the real installation.
+
+A new state must win LSM9DS0_MOTION_CONFIRM windows in a row before it's
+reported; an impact is reported at once. Per sample, the cost is a few
+multiplies and no division; the state is about 80 bytes and nothing
+is allocated. Sample at 50 Hz or more (A_ODR_50 or A_ODR_100): the
+frequency can't tell walking from vibration above half the ODR.
+
+Between bouts of motion, the host needn't read anything at all: while the
+state is idle, let the accel's interrupt generator watch for a jolt
+(configAccelInt(), with wakeThreshold()) and sleep until INT1_XM rises.
+
+Typical use:
+	LSM9DS0Motion motion;
+	motion.begin(100, dof.calcAccel(1)); // Sample rate, g per tick
+	dof.setAccelFIFO(dof.FIFO_STREAM);
+	...
+	int16_t buf[32 * 3];
+	uint8_t n = dof.readAccelFIFO(buf, 32);
+	for (uint8_t i = 0; i < n; i++)
+		if (motion.addSample(buf[3 * i], buf[3 * i + 1], buf[3 * i + 2]))
+			send(motion.state());
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_MOTION_H__
+#define __SFE_LSM9DS0_MOTION_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Window length, in samples: 8 to 128, so a window's sums of squares fit
+// in 32 bits. 64 is 0.64 s at 100 Hz, time for at least one step.
+#ifndef LSM9DS0_MOTION_WINDOW
+#define LSM9DS0_MOTION_WINDOW	64
+#endif
+
+// Windows in a row a new state needs before it's reported.
+#ifndef LSM9DS0_MOTION_CONFIRM
+#define LSM9DS0_MOTION_CONFIRM	2
+#endif
+
+// Half-width of the dead band around 0 an axis must cross, in mg, for the
+// frequency. Above the noise, below the swing of a step.
+#ifndef LSM9DS0_MOTION_DEADBAND
+#define LSM9DS0_MOTION_DEADBAND	30
+#endif
+
+// Dynamic acceleration is clipped to this, in mg, on each axis.
+#define LSM9DS0_MOTION_CLIP		4000
+
+// lsm9ds0_motion -- What the board is doing.
+enum lsm9ds0_motion
+{
+	LSM9DS0_MOTION_IDLE,
+	LSM9DS0_MOTION_WALKING,
+	LSM9DS0_MOTION_VIBRATING,
+	LSM9DS0_MOTION_IMPACT,
+};
+
+// lsm9ds0_motion_feature -- The members of LSM9DS0_motion_features, for
+// LSM9DS0_motion_node.
+enum lsm9ds0_motion_feature
+{
+	LSM9DS0_FEATURE_MEAN,
+	LSM9DS0_FEATURE_RMS,
+	LSM9DS0_FEATURE_PEAK,
+	LSM9DS0_FEATURE_FREQUENCY,
+};
+
+// LSM9DS0_motion_features -- One window's statistics.
+struct LSM9DS0_motion_features
+{
+	int16_t mean;			// |mean acceleration|, in mg
+	int16_t rms;			// RMS dynamic acceleration, in mg
+	int16_t peak;			// Largest dynamic acceleration, in mg
+	int16_t frequency;		// Dominant swing rate, in tenths of a Hz
+};
+
+// A node's branch is another node's index, or this OR'd with a state.
+#define LSM9DS0_MOTION_LEAF		0x80
+
+// LSM9DS0_motion_node -- One test of a decision tree. The tree starts at
+// node 0.
+struct LSM9DS0_motion_node
+{
+	uint8_t feature;		// lsm9ds0_motion_feature
+	int16_t threshold;		// In the feature's units
+	uint8_t below;			// Where to go if feature < threshold
+	uint8_t above;			// Where to go otherwise
+};
+
+class LSM9DS0Motion
+{
+public:
+	// LSM9DS0Motion -- Constructor. Call begin() before adding samples.
+	LSM9DS0Motion();
+
+	// begin() -- Set the stream's parameters and start over, idle. The
+	// first window only sets the gravity reference, and isn't classified.
+	// Input:
+	//	- sampleRate = Accelerometer ODR, in Hz (e.g. 100).
+	//	- res = g's per raw tick, e.g. calcAccel(1).
+	void begin(float sampleRate, float res);
+
+	// setModel() -- Classify with another decision tree.
+	// Input:
+	//	- nodes = The tree, which must outlive this object. NULL puts the
+	//		default tree back.
+	//	- count = Nodes in it (at most 127).
+	void setModel(const LSM9DS0_motion_node * nodes, uint8_t count);
+
+	// addSample() -- Add one raw accelerometer sample to the stream. Every
+	// LSM9DS0_MOTION_WINDOW samples, the window is classified before
+	// returning.
+	// Input:
+	//	- x, y, z = Raw accelerometer readings, e.g. from readAccelFIFO().
+	// Output: true if state() has just changed.
+	bool addSample(int16_t x, int16_t y, int16_t z);
+
+	// state() -- The current, confirmed state.
+	lsm9ds0_motion state() { return current; }
+
+	// features() -- The most recent window's statistics.
+	const LSM9DS0_motion_features & features() { return out; }
+
+	// wakeThreshold() -- The configAccelInt() threshold for a jolt of mg
+	// milli-g's, at this stream's res. At least 1.
+	uint8_t wakeThreshold(uint16_t mg);
+
+	// classify() -- Run features through a decision tree.
+	// Output: The leaf's state, or LSM9DS0_MOTION_IDLE if the tree is
+	// malformed (a branch out of range, or a path longer than count).
+	static lsm9ds0_motion classify(const LSM9DS0_motion_features & f,
+								   const LSM9DS0_motion_node * nodes,
+								   uint8_t count);
+
+	// The default tree, as described above.
+	static const LSM9DS0_motion_node defaultModel[];
+	static const uint8_t defaultModelSize;
+
+private:
+	// finishWindow() -- Work out features() from the sums, classify them,
+	// and start the next window.
+	// Output: true if state() has just changed.
+	bool finishWindow();
+
+	// update() -- Debounce the window's state into current.
+	bool update(lsm9ds0_motion window);
+
+	const LSM9DS0_motion_node * model;
+	uint8_t modelSize;
+	uint16_t scale;			// mg per raw tick, in Q16 (up to 16 g)
+	uint16_t hertz10;		// Sample rate, in tenths of a Hz
+
+	// The running window: sums for each axis, and the gravity reference.
+	int16_t ref[3];			// Previous window's mean, in raw ticks
+	int32_t sum[3];			// Raw readings
+	uint32_t sumSq[3];		// Dynamic acceleration squared, in mg^2
+	uint32_t peakSq;		// Largest |dynamic acceleration|^2, in mg^2
+	uint8_t crossings[3];	// Dead-band zero crossings
+	int8_t side[3];			// -1, 0, or 1: last side of the dead band
+	uint8_t fill;			// Samples in this window
+	bool primed;			// ref holds a real window's mean
+
+	lsm9ds0_motion current, pending;
+	uint8_t pendingCount;
+	LSM9DS0_motion_features out;
+};
+
+#endif // __SFE_LSM9DS0_MOTION_H__ //
@@ -0,0 +1,243 @@
+/******************************************************************************
+SFE_LSM9DS0_Output.cpp
+SFE_LSM9DS0 Library Change-Driven, Compressed Output
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements LSM9DS0QuatOutput and LSM9DS0SampleOutput. Sample messages
+carry each channel as a zigzag varint (0, -1, 1, -2, ... as 0, 1, 2, 3,
+..., 7 bits per byte, high bit set on all but the last byte), so small
+changes of either sign take one byte. Quaternions are sent big-endian.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Output.h"
+
+// The smallest three components of a unit quaternion are within
+// +/-1/sqrt(2); they're scaled so that's +/-511.
+#define QUAT_SCALE	(511 * 1.41421356f)
+
+///////////////////////
+// LSM9DS0QuatOutput //
+///////////////////////
+LSM9DS0QuatOutput::LSM9DS0QuatOutput(float deadband, uint32_t maxIntervalMs)
+{
+	begin(deadband, maxIntervalMs);
+}
+
+void LSM9DS0QuatOutput::begin(float deadband, uint32_t maxIntervalMs)
+{
+	float c = cos(deadband * PI / 360); // Half the angle, in radians
+	cosSq = c * c;
+	interval = maxIntervalMs;
+	lastMs = 0;
+	seq = 0;
+	started = false;
+}
+
+uint32_t LSM9DS0QuatOutput::pack(const float * q)
+{
+	uint8_t big = 0;
+	for (uint8_t i = 1; i < 4; i++)
+		if (fabs(q[i]) > fabs(q[big]))
+			big = i;
+	// Make the largest positive, so its sign needn't be sent.
+	float scale = (q[big] < 0) ? -QUAT_SCALE : QUAT_SCALE;
+	uint32_t packed = big;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (i == big)
+			continue;
+		int16_t v = (int16_t) floor(q[i] * scale + 0.5f);
+		if (v > 511)
+			v = 511;
+		else if (v < -511)
+			v = -511;
+		packed = (packed << 10) | (uint16_t) (v + 511);
+	}
+	return packed;
+}
+
+void LSM9DS0QuatOutput::unpack(uint32_t packed, float * q)
+{
+	uint8_t big = packed >> 30;
+	uint8_t shift = 30;
+	float sumSq = 0;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (i == big)
+			continue;
+		shift -= 10;
+		q[i] = ((int16_t) ((packed >> shift) & 0x3FF) - 511) / QUAT_SCALE;
+		sumSq += q[i] * q[i];
+	}
+	q[big] = (sumSq < 1) ? sqrt(1 - sumSq) : 0;
+}
+
+uint8_t LSM9DS0QuatOutput::update(const float * q, uint32_t nowMs, uint8_t * out)
+{
+	if (started)
+	{
+		float dot = q[0] * sent[0] + q[1] * sent[1] + q[2] * sent[2] + q[3] * sent[3];
+		// Turned by more than the deadband: cos(angle / 2) = |dot|.
+		bool moved = dot * dot < cosSq;
+		if (!moved && !(interval && nowMs - lastMs >= interval))
+			return 0;
+	}
+	uint32_t packed = pack(q);
+	unpack(packed, sent);
+	started = true;
+	lastMs = nowMs;
+
+	out[0] = LSM9DS0_OUTPUT_KEY | (seq++ & LSM9DS0_OUTPUT_SEQ);
+	for (uint8_t i = 0; i < 4; i++)
+		out[1 + i] = packed >> (24 - 8 * i);
+	return 5;
+}
+
+bool LSM9DS0QuatOutput::decode(const uint8_t * in, uint8_t length, float * q)
+{
+	if (length != 5 || !(in[0] & LSM9DS0_OUTPUT_KEY))
+		return false;
+	uint32_t packed = 0;
+	for (uint8_t i = 1; i < 5; i++)
+		packed = (packed << 8) | in[i];
+	unpack(packed, q);
+	return true;
+}
+
+/////////////////////////
+// LSM9DS0SampleOutput //
+/////////////////////////
+
+// putVarint() -- A zigzag varint of v at out.
+// Output: Bytes written, 1 to 3 for 17-bit values.
+static uint8_t putVarint(int32_t v, uint8_t * out)
+{
+	uint32_t z = (v < 0) ? ((uint32_t) -v << 1) - 1 : (uint32_t) v << 1;
+	uint8_t n = 0;
+	while (z >= 0x80)
+	{
+		out[n++] = (z & 0x7F) | 0x80;
+		z >>= 7;
+	}
+	out[n++] = z;
+	return n;
+}
+
+// getVarint() -- Read one zigzag varint of at most 3 bytes.
+// Output: Bytes read, or 0 if it runs past end or is too long.
+static uint8_t getVarint(const uint8_t * in, const uint8_t * end, int32_t & v)
+{
+	uint32_t z = 0;
+	for (uint8_t n = 0; n < 3 && in + n < end; n++)
+	{
+		z |= (uint32_t) (in[n] & 0x7F) << (7 * n);
+		if (!(in[n] & 0x80))
+		{
+			v = (z & 1) ? -(int32_t) (z >> 1) - 1 : (int32_t) (z >> 1);
+			return n + 1;
+		}
+	}
+	return 0;
+}
+
+LSM9DS0SampleOutput::LSM9DS0SampleOutput()
+{
+	begin(3, 0, 0);
+}
+
+void LSM9DS0SampleOutput::begin(uint8_t channels, uint16_t band, uint32_t maxIntervalMs)
+{
+	if (channels < 1)
+		channels = 1;
+	count = (channels > LSM9DS0_OUTPUT_CHANNELS) ? LSM9DS0_OUTPUT_CHANNELS : channels;
+	for (uint8_t i = 0; i < LSM9DS0_OUTPUT_CHANNELS; i++)
+	{
+		deadband[i] = band;
+		last[i] = 0;
+	}
+	interval = maxIntervalMs;
+	keyMs = 0;
+	seq = 0;
+	started = false;
+}
+
+void LSM9DS0SampleOutput::setDeadband(uint8_t channel, uint16_t band)
+{
+	if (channel < LSM9DS0_OUTPUT_CHANNELS)
+		deadband[channel] = band;
+}
+
+int16_t LSM9DS0SampleOutput::value(uint8_t channel)
+{
+	int32_t v = (int32_t) last[channel] * (deadband[channel] ? deadband[channel] : 1);
+	if (v > 32767)
+		return 32767;
+	return (v < -32768) ? -32768 : v;
+}
+
+uint8_t LSM9DS0SampleOutput::update(const int16_t * values, uint32_t nowMs, uint8_t * out)
+{
+	bool key = !started || (interval && nowMs - keyMs >= interval);
+	bool moved = key;
+	for (uint8_t i = 0; i < count && !moved; i++)
+	{
+		int32_t d = (int32_t) values[i] - value(i);
+		moved = (d < 0 ? -d : d) > deadband[i];
+	}
+	if (!moved)
+		return 0;
+
+	out[0] = (key ? LSM9DS0_OUTPUT_KEY : 0) | (seq++ & LSM9DS0_OUTPUT_SEQ);
+	uint8_t n = 1;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		// Round to the nearest step, symmetrically about 0.
+		int32_t step = deadband[i] ? deadband[i] : 1, v = values[i];
+		int16_t steps = (v < 0) ? -((-v + step / 2) / step) : (v + step / 2) / step;
+		n += putVarint(key ? steps : (int32_t) steps - last[i], out + n);
+		last[i] = steps;
+	}
+	if (key)
+		keyMs = nowMs;
+	started = true;
+	return n;
+}
+
+bool LSM9DS0SampleOutput::decode(const uint8_t * in, uint8_t length, int16_t * values)
+{
+	if (!length)
+		return false;
+	bool key = in[0] & LSM9DS0_OUTPUT_KEY;
+	uint8_t s = in[0] & LSM9DS0_OUTPUT_SEQ;
+	if (!key && (!started || s != ((seq + 1) & LSM9DS0_OUTPUT_SEQ)))
+	{
+		started = false; // Out of step until the next key frame
+		return false;
+	}
+
+	// Read it all before changing anything, in case it's cut short.
+	int16_t steps[LSM9DS0_OUTPUT_CHANNELS];
+	const uint8_t * p = in + 1, * end = in + length;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		int32_t v;
+		uint8_t n = getVarint(p, end, v);
+		if (!n)
+			return false;
+		p += n;
+		steps[i] = key ? v : last[i] + v;
+	}
+	if (p != end)
+		return false;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		last[i] = steps[i];
+		values[i] = value(i);
+	}
+	seq = s;
+	started = true;
+	return true;
+}
@@ -0,0 +1,148 @@
+/******************************************************************************
+SFE_LSM9DS0_Output.h
+SFE_LSM9DS0 Library Change-Driven, Compressed Output
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The examples print every reading on a fixed delay, whether anything moved
+or not, as text. These stages decide when a reading is worth sending and
+pack it into a few bytes:
+
+	- LSM9DS0QuatOutput: an orientation quaternion, sent once it has turned
+	  more than a deadband angle from the last one sent. After the header
+	  byte, it's "smallest three" packed into 4 bytes: the index of the
+	  largest component in 2 bits and the other three in 10 bits each (the
+	  largest follows from |q| = 1), to within a quarter of a degree.
+	- LSM9DS0SampleOutput: up to LSM9DS0_OUTPUT_CHANNELS raw readings
+	  (e.g. the accel's x, y, z), sent once any channel has moved more than
+	  its deadband. Each channel is quantized to steps of its deadband and
+	  sent as the change since the last message, in 1 byte while that's
+	  within 63 steps (at most 3).
+
+The deadband is checked against what the receiver will decode, not what
+was read, so the receiver's copy is never further than the deadband from
+the latest reading it was offered. LSM9DS0QuatOutput also sends after
+maxIntervalMs without a message, so a receiver can tell a still board from
+a dead link. LSM9DS0SampleOutput sends a key frame, which carries whole
+values rather than changes, at least that often, even while the readings
+keep changing, so a receiver that missed a message picks up again.
+Every message starts with a header byte; a sequence number in it lets the
+receiver spot a gap.
+
+Typical use:
+	LSM9DS0QuatOutput quatOut(0.5, 1000);	// 0.5 degrees, 1 s
+	uint8_t msg[LSM9DS0_OUTPUT_MAX_BYTES];
+	...
+	ahrs.update(...);
+	uint8_t n = quatOut.update(ahrs.q, millis(), msg);
+	if (n)
+		radio.send(msg, n);
+and on the other end, quatIn.decode(msg, n, q).
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_OUTPUT_H__
+#define __SFE_LSM9DS0_OUTPUT_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Most channels an LSM9DS0SampleOutput carries: gyro, accel, and mag.
+#ifndef LSM9DS0_OUTPUT_CHANNELS
+#define LSM9DS0_OUTPUT_CHANNELS	9
+#endif
+
+// Longest message either stage writes: a header byte, and up to 3 bytes
+// per channel.
+#define LSM9DS0_OUTPUT_MAX_BYTES	(1 + 3 * LSM9DS0_OUTPUT_CHANNELS)
+
+// The header byte: a key frame flag and a 7-bit sequence number.
+#define LSM9DS0_OUTPUT_KEY		0x80
+#define LSM9DS0_OUTPUT_SEQ		0x7F
+
+class LSM9DS0QuatOutput
+{
+public:
+	// LSM9DS0QuatOutput -- Constructor. Same as begin().
+	LSM9DS0QuatOutput(float deadband = 0.5, uint32_t maxIntervalMs = 1000);
+
+	// begin() -- Set the thresholds and start over: the next update()
+	// always sends.
+	// Input:
+	//	- deadband = Degrees q must turn before it's sent again.
+	//	- maxIntervalMs = Send anyway after this long. 0: never.
+	void begin(float deadband, uint32_t maxIntervalMs);
+
+	// update() -- Offer the latest orientation.
+	// Input:
+	//	- q = Unit quaternion w, x, y, z, e.g. LSM9DS0Madgwick::q.
+	//	- nowMs = The time, e.g. millis().
+	//	- out = Room for 5 bytes: the message, if one is due.
+	// Output: The message's length, or 0 if there's nothing to send.
+	uint8_t update(const float * q, uint32_t nowMs, uint8_t * out);
+
+	// decode() -- The receiving end: the orientation in a message.
+	// Output: false if it isn't one of update()'s messages.
+	bool decode(const uint8_t * in, uint8_t length, float * q);
+
+	// pack(), unpack() -- Smallest-three encoding of a unit quaternion. q
+	// and -q are the same rotation, and may come back either way round.
+	static uint32_t pack(const float * q);
+	static void unpack(uint32_t packed, float * q);
+
+private:
+	float cosSq;		// cos^2(deadband / 2)
+	uint32_t interval;
+	uint32_t lastMs;
+	float sent[4];		// The last message, as the receiver decodes it
+	uint8_t seq;
+	bool started;
+};
+
+class LSM9DS0SampleOutput
+{
+public:
+	// LSM9DS0SampleOutput -- Constructor. Call begin() before update().
+	LSM9DS0SampleOutput();
+
+	// begin() -- Set up the channels and start over: the next update()
+	// always sends a key frame. Both ends need the same settings.
+	// Input:
+	//	- channels = Readings per update, 1 to LSM9DS0_OUTPUT_CHANNELS.
+	//	- deadband = Raw ticks each channel must move before it's sent
+	//		again, and its quantization step. 0 sends every change.
+	//	- maxIntervalMs = Send a key frame at least this often. 0: only
+	//		the first.
+	void begin(uint8_t channels, uint16_t deadband, uint32_t maxIntervalMs);
+
+	// setDeadband() -- Give one channel its own deadband, e.g. when one
+	// stage carries several sensors. Call it on both ends, after begin().
+	void setDeadband(uint8_t channel, uint16_t deadband);
+
+	// update() -- Offer the latest readings.
+	// Input:
+	//	- values = One raw reading per channel.
+	//	- nowMs = The time, e.g. millis().
+	//	- out = Room for LSM9DS0_OUTPUT_MAX_BYTES: the message, if one is
+	//		due.
+	// Output: The message's length, or 0 if there's nothing to send.
+	uint8_t update(const int16_t * values, uint32_t nowMs, uint8_t * out);
+
+	// decode() -- The receiving end: the readings in a message.
+	// Output: false, and values unchanged, if the message is malformed, or
+	// if it's a change and a message has been missed since the last one
+	// decoded; the next key frame gets back in step.
+	bool decode(const uint8_t * in, uint8_t length, int16_t * values);
+
+private:
+	// value() -- A channel's quantized value, as decoded.
+	int16_t value(uint8_t channel);
+
+	uint8_t count;
+	uint16_t deadband[LSM9DS0_OUTPUT_CHANNELS];	// Also the step, if not 0
+	int16_t last[LSM9DS0_OUTPUT_CHANNELS];		// Last sent, in steps
+	uint32_t interval;
+	uint32_t keyMs;		// When the last key frame was sent
+	uint8_t seq;
+	bool started;		// Sent (or decoded in step) since begin()
+};
+
+#endif // __SFE_LSM9DS0_OUTPUT_H__ //
@@ -0,0 +1,356 @@
+/******************************************************************************
+SFE_LSM9DS0_Registers.h
+SFE_LSM9DS0 Library Typed Register Map
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The control registers of the gyro (G) and accel/mag (XM) devices, described
+field by field, so register values can be built by name instead of by hand
+with shifts and masks:
+
+	- Each register is a struct (CtrlReg1G, CtrlReg2XM, ...) whose members
+	  are its fields, named as in the datasheet.
+	- A field's set() gives a register image with just that field set.
+	  Images of the same register combine with |; images of different
+	  registers don't compile.
+	- Everything is constexpr. Built at compile time (e.g. into a
+	  constexpr table), an image whose value doesn't fit its field, or that
+	  sets the same bits twice, is a compile error rather than a wrong
+	  register value.
+	- At run time, bits() and replace() mask the value into the field, and
+	  get() takes it back out. set() and | work at run time too, but
+	  can't fail there: an oversize value is masked as bits() would, and
+	  the right-hand image of | wins any bits both set.
+
+For example, the accel at 100 Hz with all axes on:
+
+	constexpr LSM9DS0_reg_write accelOn =
+		(CtrlReg1XM::AODR::set(6) | CtrlReg1XM::AZEN::set(1) |
+		 CtrlReg1XM::AYEN::set(1) | CtrlReg1XM::AXEN::set(1)).write();
+
+and setting the full-scale on a value read back:
+
+	temp = CtrlReg2XM::AFS::replace(temp, A_SCALE_8G);
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_REGISTERS_H__
+#define __SFE_LSM9DS0_REGISTERS_H__
+
+#include "SFE_LSM9DS0.h"
+
+// The two devices in the package, each with its own address and registers.
+enum lsm9ds0_device
+{
+	LSM9DS0_DEVICE_G,
+	LSM9DS0_DEVICE_XM,
+};
+
+// LSM9DS0_reg_write -- One entry of a register init table.
+struct LSM9DS0_reg_write
+{
+	uint8_t device;		// lsm9ds0_device
+	uint8_t address;
+	uint8_t value;
+};
+
+// lsm9ds0BadField() -- Deliberately not constexpr: when an image evaluated
+// at compile time reaches it, that's a compile error. At run time it passes
+// bits through, so set() and | fall back to masking (see above).
+inline uint8_t lsm9ds0BadField(uint8_t bits) { return bits; }
+
+// LSM9DS0RegImage -- A value for one register, and which of its bits have
+// been set by a field so far.
+template <uint8_t Device, uint8_t Address>
+struct LSM9DS0RegImage
+{
+	uint8_t bits;
+	uint8_t fields;
+
+	constexpr LSM9DS0RegImage(uint8_t b = 0, uint8_t f = 0) : bits(b), fields(f) {}
+
+	constexpr LSM9DS0RegImage operator|(LSM9DS0RegImage other) const
+	{
+		return (fields & other.fields) ?
+			   LSM9DS0RegImage(lsm9ds0BadField((bits & ~other.fields) | other.bits),
+							   fields | other.fields) :
+			   LSM9DS0RegImage(bits | other.bits, fields | other.fields);
+	}
+
+	// write() -- The image as an init table entry.
+	constexpr LSM9DS0_reg_write write() const
+	{
+		return LSM9DS0_reg_write{Device, Address, bits};
+	}
+};
+
+// LSM9DS0Field -- Width bits of a register, starting at bit Shift.
+template <uint8_t Device, uint8_t Address, uint8_t Shift, uint8_t Width>
+struct LSM9DS0Field
+{
+	static_assert(Width > 0 && Shift + Width <= 8, "field must fit in its register");
+	typedef LSM9DS0RegImage<Device, Address> Image;
+	enum
+	{
+		limit = (1 << Width) - 1,	// Largest value
+		mask = limit << Shift,		// Its bits in the register
+	};
+
+	// set() -- An image of the register with this field set to value, and
+	// every other field still unset.
+	static constexpr Image set(uint8_t value)
+	{
+		return value > limit ? Image(lsm9ds0BadField(bits(value)), mask) :
+			   Image(value << Shift, mask);
+	}
+
+	// bits() -- value, masked and shifted into place.
+	static constexpr uint8_t bits(uint8_t value)
+	{
+		return (value << Shift) & mask;
+	}
+
+	// get() -- This field's value in reg.
+	static constexpr uint8_t get(uint8_t reg)
+	{
+		return (reg >> Shift) & limit;
+	}
+
+	// replace() -- reg, with this field changed to value and every other bit
+	// left as it was.
+	static constexpr uint8_t replace(uint8_t reg, uint8_t value)
+	{
+		return (reg & ~mask) | bits(value);
+	}
+};
+
+// LSM9DS0Register -- Base of the register structs below.
+template <uint8_t Device, uint8_t Address>
+struct LSM9DS0Register
+{
+	typedef LSM9DS0RegImage<Device, Address> Image;
+	template <uint8_t Shift, uint8_t Width = 1>
+	using Field = LSM9DS0Field<Device, Address, Shift, Width>;
+};
+
+namespace LSM9DS0Reg
+{
+
+///////////////////
+// Gyro (G) side //
+///////////////////
+
+// CTRL_REG1_G: DR1 DR0 BW1 BW0 PD Zen Xen Yen
+struct CtrlReg1G : LSM9DS0Register<LSM9DS0_DEVICE_G, CTRL_REG1_G>
+{
+	typedef Field<6, 2> DR;		// ODR: 95, 190, 380, 760 Hz
+	typedef Field<4, 2> BW;		// Bandwidth; depends on DR (datasheet table 21)
+	typedef Field<4, 4> ODR;	// DR and BW together, as in gyro_odr
+	typedef Field<3> PD;		// 0: power-down, 1: normal or sleep
+	typedef Field<2> ZEN;
+	typedef Field<1> XEN;
+	typedef Field<0> YEN;
+};
+
+// CTRL_REG2_G: 0 0 HPM1 HPM0 HPCF3 HPCF2 HPCF1 HPCF0
+struct CtrlReg2G : LSM9DS0Register<LSM9DS0_DEVICE_G, CTRL_REG2_G>
+{
+	typedef Field<4, 2> HPM;	// HPF mode, as in gyro_hpf_mode
+	typedef Field<0, 4> HPCF;	// HPF cutoff; depends on ODR (table 26)
+};
+
+// CTRL_REG3_G: I1_Int1 I1_Boot H_Lactive PP_OD I2_DRDY I2_WTM I2_ORun I2_Empty
+struct CtrlReg3G : LSM9DS0Register<LSM9DS0_DEVICE_G, CTRL_REG3_G>
+{
+	typedef Field<7> I1_INT1;	// Interrupt generator on INT_G
+	typedef Field<6> I1_BOOT;	// Boot status on INT_G
+	typedef Field<5> H_LACTIVE;	// INT_G active low
+	typedef Field<4> PP_OD;		// Open drain
+	typedef Field<3> I2_DRDY;	// Data ready on DRDY_G
+	typedef Field<2> I2_WTM;	// FIFO watermark on DRDY_G
+	typedef Field<1> I2_ORUN;	// FIFO overrun on DRDY_G
+	typedef Field<0> I2_EMPTY;	// FIFO empty on DRDY_G
+};
+
+// CTRL_REG4_G: BDU BLE FS1 FS0 - ST1 ST0 SIM
+struct CtrlReg4G : LSM9DS0Register<LSM9DS0_DEVICE_G, CTRL_REG4_G>
+{
+	typedef Field<7> BDU;		// Block data update
+	typedef Field<6> BLE;		// Big endian
+	typedef Field<4, 2> FS;		// Full scale, as in gyro_scale
+	typedef Field<1, 2> ST;		// Self-test: 01 = x+ y- z-, 11 = x- y+ z+
+	typedef Field<0> SIM;		// 3-wire SPI
+};
+
+// CTRL_REG5_G: BOOT FIFO_EN - HPen INT1_Sel1 INT1_Sel0 Out_Sel1 Out_Sel0
+struct CtrlReg5G : LSM9DS0Register<LSM9DS0_DEVICE_G, CTRL_REG5_G>
+{
+	typedef Field<7> BOOT;		// Reboot memory content
+	typedef Field<6> FIFO_EN;
+	typedef Field<4> HPEN;		// HPF enable
+	typedef Field<2, 2> INT1_SEL;	// INT1 path, as in gyro_path
+	typedef Field<0, 2> OUT_SEL;	// Output and FIFO path, as in gyro_path
+};
+
+// FIFO_CTRL_REG_G: FM2 FM1 FM0 WTM4 WTM3 WTM2 WTM1 WTM0
+struct FifoCtrlRegG : LSM9DS0Register<LSM9DS0_DEVICE_G, FIFO_CTRL_REG_G>
+{
+	typedef Field<5, 3> FM;		// FIFO mode, as in fifo_mode
+	typedef Field<0, 5> WTM;	// Watermark
+};
+
+// INT1_CFG_G: AND/OR LIR ZHIE ZLIE YHIE YLIE XHIE XLIE
+struct Int1CfgG : LSM9DS0Register<LSM9DS0_DEVICE_G, INT1_CFG_G>
+{
+	typedef Field<7> AND_OR;	// AND (1) or OR (0) of the enabled events
+	typedef Field<6> LIR;		// Latch INT1_SRC_G until it's read
+	typedef Field<5> ZHIE;		// Interrupt on each axis going above...
+	typedef Field<4> ZLIE;		// ...or below its threshold
+	typedef Field<3> YHIE;
+	typedef Field<2> YLIE;
+	typedef Field<1> XHIE;
+	typedef Field<0> XLIE;
+};
+
+// INT1_THS_XH_G (and _YH_, _ZH_): - THS14 ... THS8. The _XL_ (etc.) byte
+// below each holds THS7 ... THS0.
+struct Int1ThsHG : LSM9DS0Register<LSM9DS0_DEVICE_G, INT1_THS_XH_G>
+{
+	typedef Field<0, 7> THS;	// Threshold bits 14-8
+};
+
+// INT1_DURATION_G: WAIT D6 D5 D4 D3 D2 D1 D0
+struct Int1DurationG : LSM9DS0Register<LSM9DS0_DEVICE_G, INT1_DURATION_G>
+{
+	typedef Field<7> WAIT;		// Hold the interrupt for D samples after
+	typedef Field<0, 7> D;		// the event ends, too
+};
+
+/////////////////////////
+// Accel/mag (XM) side //
+/////////////////////////
+
+// CTRL_REG0_XM: BOOT FIFO_EN WTM_EN 0 0 HP_CLICK HPIS1 HPIS2
+struct CtrlReg0XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG0_XM>
+{
+	typedef Field<7> BOOT;		// Reboot memory content
+	typedef Field<6> FIFO_EN;
+	typedef Field<5> WTM_EN;	// Stop the FIFO at the watermark
+	typedef Field<2> HP_CLICK;	// HPF for click
+	typedef Field<1> HPIS1;		// HPF for interrupt generator 1
+	typedef Field<0> HPIS2;		// HPF for interrupt generator 2
+};
+
+// CTRL_REG1_XM: AODR3 AODR2 AODR1 AODR0 BDU AZEN AYEN AXEN
+struct CtrlReg1XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG1_XM>
+{
+	typedef Field<4, 4> AODR;	// Accel ODR, as in accel_odr
+	typedef Field<3> BDU;		// Block data update, accel and mag
+	typedef Field<2> AZEN;
+	typedef Field<1> AYEN;
+	typedef Field<0> AXEN;
+};
+
+// CTRL_REG2_XM: ABW1 ABW0 AFS2 AFS1 AFS0 AST1 AST0 SIM
+struct CtrlReg2XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG2_XM>
+{
+	typedef Field<6, 2> ABW;	// Anti-alias bandwidth, as in accel_abw
+	typedef Field<3, 3> AFS;	// Full scale, as in accel_scale
+	typedef Field<1, 2> AST;	// Self-test: 01 positive, 10 negative
+	typedef Field<0> SIM;		// 3-wire SPI
+};
+
+// CTRL_REG3_XM: P1_BOOT P1_TAP P1_INT1 P1_INT2 P1_INTM P1_DRDYA P1_DRDYM P1_EMPTY
+struct CtrlReg3XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG3_XM>
+{
+	typedef Field<7> P1_BOOT;	// Signals on INT1_XM
+	typedef Field<6> P1_TAP;
+	typedef Field<5> P1_INT1;
+	typedef Field<4> P1_INT2;
+	typedef Field<3> P1_INTM;
+	typedef Field<2> P1_DRDYA;
+	typedef Field<1> P1_DRDYM;
+	typedef Field<0> P1_EMPTY;
+};
+
+// CTRL_REG4_XM: P2_TAP P2_INT1 P2_INT2 P2_INTM P2_DRDYA P2_DRDYM P2_Overrun P2_WTM
+struct CtrlReg4XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG4_XM>
+{
+	typedef Field<7> P2_TAP;	// Signals on INT2_XM
+	typedef Field<6> P2_INT1;
+	typedef Field<5> P2_INT2;
+	typedef Field<4> P2_INTM;
+	typedef Field<3> P2_DRDYA;
+	typedef Field<2> P2_DRDYM;
+	typedef Field<1> P2_OVERRUN;
+	typedef Field<0> P2_WTM;
+};
+
+// CTRL_REG5_XM: TEMP_EN M_RES1 M_RES0 M_ODR2 M_ODR1 M_ODR0 LIR2 LIR1
+struct CtrlReg5XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG5_XM>
+{
+	typedef Field<7> TEMP_EN;	// Temperature sensor
+	typedef Field<5, 2> M_RES;	// Mag resolution: 0 low, 3 high
+	typedef Field<2, 3> M_ODR;	// Mag ODR, as in mag_odr
+	typedef Field<1> LIR2;		// Latch INT2_SRC
+	typedef Field<0> LIR1;		// Latch INT1_SRC
+};
+
+// CTRL_REG6_XM: 0 MFS1 MFS0 0 0 0 0 0
+struct CtrlReg6XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG6_XM>
+{
+	typedef Field<5, 2> MFS;	// Mag full scale, as in mag_scale
+};
+
+// CTRL_REG7_XM: AHPM1 AHPM0 AFDS 0 0 MLP MD1 MD0
+struct CtrlReg7XM : LSM9DS0Register<LSM9DS0_DEVICE_XM, CTRL_REG7_XM>
+{
+	typedef Field<6, 2> AHPM;	// Accel HPF mode, as in accel_hpf_mode
+	typedef Field<5> AFDS;		// Filtered accel data to the outputs/FIFO
+	typedef Field<2> MLP;		// Mag low power: 3.125 Hz, whatever M_ODR
+	typedef Field<0, 2> MD;		// Mag mode: 00 continuous, 01 single,
+								// 1x power-down
+};
+
+// FIFO_CTRL_REG: FM2 FM1 FM0 FTH4 FTH3 FTH2 FTH1 FTH0
+struct FifoCtrlReg : LSM9DS0Register<LSM9DS0_DEVICE_XM, FIFO_CTRL_REG>
+{
+	typedef Field<5, 3> FM;		// FIFO mode, as in fifo_mode
+	typedef Field<0, 5> FTH;	// Watermark
+};
+
+// INT_GEN_1_REG: AOI 6D ZHIE ZLIE YHIE YLIE XHIE XLIE
+struct IntGen1Reg : LSM9DS0Register<LSM9DS0_DEVICE_XM, INT_GEN_1_REG>
+{
+	typedef Field<7> AOI;		// AND (1) or OR (0) of the enabled events
+	typedef Field<6> D6;		// 6D detection (with AOI: position or movement)
+	typedef Field<5> ZHIE;		// Interrupt on each axis going above...
+	typedef Field<4> ZLIE;		// ...or below the threshold
+	typedef Field<3> YHIE;
+	typedef Field<2> YLIE;
+	typedef Field<1> XHIE;
+	typedef Field<0> XLIE;
+};
+
+// INT_GEN_1_SRC: 0 IA ZH ZL YH YL XH XL (read-only; reading clears a latch)
+struct IntGen1Src : LSM9DS0Register<LSM9DS0_DEVICE_XM, INT_GEN_1_SRC>
+{
+	typedef Field<6> IA;		// One or more events active
+	typedef Field<0, 6> EVENTS;	// ZH ZL YH YL XH XL, as in IntGen1Reg
+};
+
+// INT_CTRL_REG_M: XMIEN YMIEN ZMIEN PP_OD IEA IEL 4D MIEN
+struct IntCtrlRegM : LSM9DS0Register<LSM9DS0_DEVICE_XM, INT_CTRL_REG_M>
+{
+	typedef Field<7> XMIEN;		// Mag interrupt recognition per axis
+	typedef Field<6> YMIEN;
+	typedef Field<5> ZMIEN;
+	typedef Field<4> PP_OD;		// Open drain
+	typedef Field<3> IEA;		// Accel and mag interrupts active high
+	typedef Field<2> IEL;		// Latch interrupt requests
+	typedef Field<1> D4;		// 4D (with 6D in INT_GEN_1_REG)
+	typedef Field<0> MIEN;		// Mag interrupt generation
+};
+
+} // namespace LSM9DS0Reg
+
+#endif // __SFE_LSM9DS0_REGISTERS_H__ //
@@ -0,0 +1,235 @@
+/******************************************************************************
+SFE_LSM9DS0_Spectrum.cpp
+SFE_LSM9DS0 Library Streaming Vibration Spectrum Analysis
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements LSM9DS0Spectrum. The real N-point FFT is computed as an N/2-point
+complex FFT of the samples packed in pairs, then unpacked bin by bin as the
+features are accumulated, so no separate spectrum buffer is needed.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Spectrum.h"
+
+#define N	LSM9DS0_FFT_SIZE
+#define M	(LSM9DS0_FFT_SIZE / 2)
+
+// Fails to compile if LSM9DS0_FFT_SIZE isn't a power of two.
+typedef char lsm9ds0_fft_size_is_power_of_two[((N & (N - 1)) == 0 && N >= 8) ? 1 : -1];
+
+float LSM9DS0Spectrum::work[N];
+float LSM9DS0Spectrum::sinTable[N / 4 + 1];
+bool LSM9DS0Spectrum::tableReady = false;
+
+LSM9DS0Spectrum::LSM9DS0Spectrum()
+{
+	begin(1600, 2.0 / 32768.0);
+}
+
+void LSM9DS0Spectrum::begin(float sampleRate, float resolution, bool computeMoments)
+{
+	fs = sampleRate;
+	res = resolution;
+	moments = computeMoments;
+	head = fill = sinceLast = 0;
+	memset(&out, 0, sizeof(out));
+
+	// Default bands: equal slices of bins 1 to N/2 (DC is always excluded).
+	for (uint8_t b = 0; b < LSM9DS0_SPECTRUM_BANDS; b++)
+	{
+		bandLo[b] = 1 + (uint32_t) b * M / LSM9DS0_SPECTRUM_BANDS;
+		bandHi[b] = 1 + (uint32_t) (b + 1) * M / LSM9DS0_SPECTRUM_BANDS;
+	}
+
+	if (!tableReady)
+	{
+		for (uint16_t k = 0; k <= N / 4; k++)
+			sinTable[k] = sin(2 * PI * k / N);
+		tableReady = true;
+	}
+}
+
+void LSM9DS0Spectrum::setBand(uint8_t band, float lo, float hi)
+{
+	if (band >= LSM9DS0_SPECTRUM_BANDS)
+		return;
+	float bin = binHz();
+	int32_t l = (int32_t) (lo / bin + 0.5);
+	int32_t h = (int32_t) (hi / bin + 0.5);
+	if (l < 1)
+		l = 1;
+	if (h > M + 1)
+		h = M + 1;
+	if (h < l)
+		h = l;
+	bandLo[band] = l;
+	bandHi[band] = h;
+}
+
+bool LSM9DS0Spectrum::addSample(int16_t x, int16_t y, int16_t z)
+{
+	history[0][head] = x;
+	history[1][head] = y;
+	history[2][head] = z;
+	head = (head + 1) % N;
+	if (fill < N)
+		fill++;
+	sinceLast++;
+
+	if (fill < N || sinceLast < LSM9DS0_FFT_HOP)
+		return false;
+	sinceLast = 0;
+	analyze();
+	return true;
+}
+
+void LSM9DS0Spectrum::analyze()
+{
+	// A Hann window's coherent gain is N/2 and its power gain 3N/8, so a
+	// sinusoid of amplitude A peaks at |X| = A*N/4, and the one-sided
+	// mean-square in a band is 2 * sum(|X|^2) / (N * 3N/8).
+	const float ampScale = 4.0 * res / N;
+	const float msScale = 16.0 * res * res / (3.0 * N * N);
+
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		loadWindow(axis);
+		fft();
+
+		for (uint8_t b = 0; b < LSM9DS0_SPECTRUM_BANDS; b++)
+			out.band[axis][b] = 0;
+
+		// One pass over the bins accumulates every band and finds the peak.
+		uint16_t peak = 1;
+		float peakPower = 0;
+		for (uint16_t k = 1; k <= M; k++)
+		{
+			float p = power(k);
+			for (uint8_t b = 0; b < LSM9DS0_SPECTRUM_BANDS; b++)
+				if (k >= bandLo[b] && k < bandHi[b])
+					out.band[axis][b] += p;
+			if (k < M && p > peakPower)
+			{
+				peakPower = p;
+				peak = k;
+			}
+		}
+		for (uint8_t b = 0; b < LSM9DS0_SPECTRUM_BANDS; b++)
+			out.band[axis][b] *= msScale;
+
+		// Parabolic interpolation over the peak and its neighbors' magnitudes
+		// refines the frequency to a fraction of a bin.
+		float alpha = sqrt(power(peak - 1));
+		float beta = sqrt(peakPower);
+		float gamma = sqrt(power(peak + 1));
+		float denom = alpha - 2 * beta + gamma;
+		float delta = (denom != 0) ? 0.5 * (alpha - gamma) / denom : 0;
+		out.peakHz[axis] = (peak + delta) * binHz();
+		out.peakAmp[axis] = beta * ampScale;
+	}
+	out.window++;
+}
+
+void LSM9DS0Spectrum::loadWindow(uint8_t axis)
+{
+	const int16_t * h = history[axis];
+	int32_t sum = 0;
+	for (uint16_t n = 0; n < N; n++)
+		sum += h[n];
+	float mean = (float) sum / N;
+
+	float m2 = 0, m4 = 0;
+	for (uint16_t n = 0; n < N; n++)
+	{
+		float d = h[(head + n) % N] - mean; // head is the oldest sample
+		if (moments)
+		{
+			float d2 = d * d;
+			m2 += d2;
+			m4 += d2 * d2;
+		}
+		work[n] = d * (0.5 - 0.5 * cosN(n));
+	}
+
+	if (moments)
+	{
+		m2 /= N;
+		m4 /= N;
+		out.rms[axis] = sqrt(m2) * res;
+		out.kurtosis[axis] = (m2 > 0) ? m4 / (m2 * m2) : 0;
+	}
+}
+
+void LSM9DS0Spectrum::fft()
+{
+	// Bit-reversal permutation of the M complex points.
+	for (uint16_t i = 1, j = 0; i < M; i++)
+	{
+		uint16_t bit = M >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j |= bit;
+		if (i < j)
+		{
+			float t = work[2 * i];
+			work[2 * i] = work[2 * j];
+			work[2 * j] = t;
+			t = work[2 * i + 1];
+			work[2 * i + 1] = work[2 * j + 1];
+			work[2 * j + 1] = t;
+		}
+	}
+
+	// Radix-2 butterflies. The twiddle for j in a span of len points is
+	// exp(-2*PI*i * j/len) = exp(-2*PI*i * j*(N/len) / N).
+	for (uint16_t len = 2; len <= M; len <<= 1)
+	{
+		uint16_t step = N / len;
+		uint16_t halfLen = len >> 1;
+		for (uint16_t j = 0; j < halfLen; j++)
+		{
+			float wr = cosN(j * step);
+			float wi = -sinN(j * step);
+			for (uint16_t i = j; i < M; i += len)
+			{
+				float * a = &work[2 * i];
+				float * b = &work[2 * (i + halfLen)];
+				float vr = b[0] * wr - b[1] * wi;
+				float vi = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - vr;
+				b[1] = a[1] - vi;
+				a[0] += vr;
+				a[1] += vi;
+			}
+		}
+	}
+}
+
+float LSM9DS0Spectrum::power(uint16_t k)
+{
+	// With Z the M-point FFT of z[n] = x[2n] + i*x[2n+1]:
+	//	X[k] = E[k] + W^k * O[k], where W = exp(-2*PI*i/N),
+	//	E[k] = (Z[k] + conj(Z[M-k])) / 2, O[k] = (Z[k] - conj(Z[M-k])) / 2i
+	uint16_t a = k % M, b = (M - a) % M;
+	float zr = work[2 * a], zi = work[2 * a + 1];
+	float cr = work[2 * b], ci = -work[2 * b + 1];
+	float er = (zr + cr) * 0.5, ei = (zi + ci) * 0.5;
+	float odr = (zi - ci) * 0.5, odi = -(zr - cr) * 0.5;
+	float c = cosN(k), s = sinN(k);
+	float xr = er + odr * c + odi * s;
+	float xi = ei + odi * c - odr * s;
+	return xr * xr + xi * xi;
+}
+
+float LSM9DS0Spectrum::sinN(uint16_t a)
+{
+	a %= N;
+	if (a <= N / 4)
+		return sinTable[a];
+	if (a <= N / 2)
+		return sinTable[N / 2 - a];
+	if (a <= 3 * N / 4)
+		return -sinTable[a - N / 2];
+	return -sinTable[N - a];
+}
@@ -0,0 +1,152 @@
+/******************************************************************************
+SFE_LSM9DS0_Spectrum.h
+SFE_LSM9DS0 Library Streaming Vibration Spectrum Analysis
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+LSM9DS0Spectrum turns a stream of raw accelerometer samples (typically
+FIFO batches at A_ODR_1600) into compact feature vectors, so only a few
+dozen numbers per window leave the node instead of every sample.
+
+For each axis and each window it computes:
+	- Mean-square acceleration in a set of frequency bands (g^2).
+	- The strongest spectral peak: frequency (interpolated) and amplitude.
+	- Optionally, time-domain RMS and kurtosis (3.0 for Gaussian noise,
+	  higher for impacts, e.g. bearing defects).
+
+Windows are LSM9DS0_FFT_SIZE samples, Hann-windowed, with a new window every
+LSM9DS0_FFT_HOP samples (50% overlap by default). The mean of each window is
+removed first, so gravity doesn't leak into the low bins.
+
+No memory is allocated at runtime. Each LSM9DS0Spectrum holds only its own
+sample history; the FFT's working buffer and twiddle table are a single
+static arena shared by every instance, so analyzing several sensors costs
+one arena, not several.
+
+Typical use:
+	LSM9DS0Spectrum spectrum;
+	spectrum.begin(1600, dof.calcAccel(1)); // Sample rate, g per tick
+	dof.setAccelFIFO(dof.FIFO_STREAM);
+	...
+	int16_t buf[32 * 3];
+	uint8_t n = dof.readAccelFIFO(buf, 32);
+	for (uint8_t i = 0; i < n; i++)
+		if (spectrum.addSample(buf[3 * i], buf[3 * i + 1], buf[3 * i + 2]))
+			send(spectrum.features());
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_SPECTRUM_H__
+#define __SFE_LSM9DS0_SPECTRUM_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Window length, in samples. Must be a power of two. The default keeps the
+// sample history and arena under 1 KB on an ATmega328.
+#ifndef LSM9DS0_FFT_SIZE
+#if defined(__AVR__)
+#define LSM9DS0_FFT_SIZE	64
+#else
+#define LSM9DS0_FFT_SIZE	256
+#endif
+#endif
+
+// Samples between the starts of consecutive windows.
+#ifndef LSM9DS0_FFT_HOP
+#define LSM9DS0_FFT_HOP		(LSM9DS0_FFT_SIZE / 2)
+#endif
+
+// Number of frequency bands reported per axis.
+#ifndef LSM9DS0_SPECTRUM_BANDS
+#if defined(__AVR__)
+#define LSM9DS0_SPECTRUM_BANDS	4
+#else
+#define LSM9DS0_SPECTRUM_BANDS	8
+#endif
+#endif
+
+// LSM9DS0_spectrum is the feature vector produced for each window.
+struct LSM9DS0_spectrum
+{
+	uint32_t window;		// Window sequence number, from 0
+	float rms[3];			// Time-domain RMS, in g's (mean removed)
+	float kurtosis[3];		// Time-domain kurtosis (not excess)
+	float peakHz[3];		// Frequency of the strongest bin, interpolated
+	float peakAmp[3];		// Amplitude of that peak, in g's
+	float band[3][LSM9DS0_SPECTRUM_BANDS];	// Mean-square per band, in g^2
+};
+
+class LSM9DS0Spectrum
+{
+public:
+	// LSM9DS0Spectrum -- Constructor. Call begin() before adding samples.
+	LSM9DS0Spectrum();
+
+	// begin() -- Set the stream's parameters and clear its history.
+	// Bands default to equal-width slices of 0 Hz to sampleRate / 2.
+	// Input:
+	//	- sampleRate = Accelerometer ODR, in Hz (e.g. 1600).
+	//	- res = g's per raw tick, e.g. calcAccel(1).
+	//	- moments = Also compute RMS and kurtosis. Leave it off to save a
+	//		few hundred cycles per window.
+	void begin(float sampleRate, float res, bool moments = true);
+
+	// setBand() -- Set the frequency range of one band.
+	// Edges are rounded to the nearest FFT bin (sampleRate / FFT size).
+	// Input:
+	//	- band = Band index, 0 to LSM9DS0_SPECTRUM_BANDS - 1.
+	//	- lo, hi = Lower (inclusive) and upper (exclusive) edge, in Hz.
+	void setBand(uint8_t band, float lo, float hi);
+
+	// addSample() -- Add one raw accelerometer sample to the stream.
+	// Every LSM9DS0_FFT_HOP samples (once the first window is full) the
+	// window is analyzed before returning.
+	// Input:
+	//	- x, y, z = Raw accelerometer readings, e.g. from readAccelFIFO().
+	// Output: true if features() now holds a new window's results.
+	bool addSample(int16_t x, int16_t y, int16_t z);
+
+	// features() -- The most recent window's feature vector.
+	const LSM9DS0_spectrum & features() { return out; }
+
+	// binHz() -- Width of one FFT bin, in Hz.
+	float binHz() { return fs / LSM9DS0_FFT_SIZE; }
+
+private:
+	// analyze() -- Compute every feature of the current window.
+	void analyze();
+
+	// loadWindow() -- Copy one axis of the history into the arena, oldest
+	// sample first, with the mean removed and the Hann window applied.
+	// Also computes the RMS and kurtosis, if enabled.
+	void loadWindow(uint8_t axis);
+
+	// fft() -- In-place complex FFT of the arena, as LSM9DS0_FFT_SIZE / 2
+	// complex points (the real window packed two samples per point).
+	static void fft();
+
+	// power() -- |X[k]|^2 of the real window, unpacked from the complex
+	// FFT in the arena, for 0 <= k <= LSM9DS0_FFT_SIZE / 2.
+	static float power(uint16_t k);
+
+	// sinN(), cosN() -- sin and cos of 2 * PI * a / LSM9DS0_FFT_SIZE,
+	// from the quarter-wave table.
+	static float sinN(uint16_t a);
+	static float cosN(uint16_t a) { return sinN(a + LSM9DS0_FFT_SIZE / 4); }
+
+	// Per-stream state: the last LSM9DS0_FFT_SIZE samples of each axis.
+	int16_t history[3][LSM9DS0_FFT_SIZE];
+	uint16_t head;		// Index of the oldest sample (and next write)
+	uint16_t fill;		// Samples in history, up to LSM9DS0_FFT_SIZE
+	uint16_t sinceLast;	// Samples since the last window was analyzed
+	uint16_t bandLo[LSM9DS0_SPECTRUM_BANDS], bandHi[LSM9DS0_SPECTRUM_BANDS];
+	float fs, res;
+	bool moments;
+	LSM9DS0_spectrum out;
+
+	// The shared arena: FFT working buffer and quarter-wave sine table.
+	static float work[LSM9DS0_FFT_SIZE];
+	static float sinTable[LSM9DS0_FFT_SIZE / 4 + 1];
+	static bool tableReady;
+};
+
+#endif // __SFE_LSM9DS0_SPECTRUM_H__ //
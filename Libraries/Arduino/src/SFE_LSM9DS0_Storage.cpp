@@ -0,0 +1,64 @@
+/******************************************************************************
+SFE_LSM9DS0_Storage.cpp
+SFE_LSM9DS0 Library Profile Save/Load Hooks
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the EEPROM (AVR) and file (Linux) hooks declared in
+SFE_LSM9DS0_Storage.h. Other platforms compile this file to nothing.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Storage.h"
+
+#if defined(ARDUINO_ARCH_AVR)
+#include <EEPROM.h>
+
+bool saveLSM9DS0Profile(const LSM9DS0_profile & profile, int address)
+{
+	if (address < 0 || address + sizeof(profile) > EEPROM.length())
+		return false;
+	EEPROM.put(address, profile); // put() uses update(), skipping equal bytes
+	return true;
+}
+
+bool loadLSM9DS0Profile(LSM9DS0_profile & profile, int address)
+{
+	if (address < 0 || address + sizeof(profile) > EEPROM.length())
+		return false;
+	EEPROM.get(address, profile);
+	return true;
+}
+#endif
+
+#if defined(__linux__)
+#include <stdio.h>
+
+bool saveLSM9DS0Profile(const LSM9DS0_profile & profile, const char * path)
+{
+	char temp[256];
+	if (snprintf(temp, sizeof(temp), "%s.tmp", path) >= (int) sizeof(temp))
+		return false;
+
+	FILE * f = fopen(temp, "wb");
+	if (!f)
+		return false;
+	bool ok = fwrite(&profile, sizeof(profile), 1, f) == 1;
+	ok = (fclose(f) == 0) && ok;
+	if (ok)
+		ok = rename(temp, path) == 0;
+	if (!ok)
+		remove(temp);
+	return ok;
+}
+
+bool loadLSM9DS0Profile(LSM9DS0_profile & profile, const char * path)
+{
+	FILE * f = fopen(path, "rb");
+	if (!f)
+		return false;
+	bool ok = fread(&profile, sizeof(profile), 1, f) == 1;
+	fclose(f);
+	return ok;
+}
+#endif
@@ -0,0 +1,79 @@
+/******************************************************************************
+SFE_LSM9DS0_Storage.h
+SFE_LSM9DS0 Library Profile Save/Load Hooks
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Save and load an LSM9DS0_profile (see SFE_LSM9DS0.h) to wherever the
+platform keeps non-volatile data: EEPROM on AVR Arduinos, a file on Linux.
+These hooks only move bytes around. The profile's checksum is verified by
+begin(profile), so a blank EEPROM or missing file just makes begin() return
+0, and the sketch falls back to a normal begin() and calibration:
+
+	LSM9DS0_profile profile;
+	if (!loadLSM9DS0Profile(profile) || !dof.begin(profile))
+	{
+		dof.begin();
+		dof.calLSM9DS0(dof.gbias, dof.abias);
+		dof.getProfile(profile);
+		saveLSM9DS0Profile(profile);
+	}
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_STORAGE_H__
+#define __SFE_LSM9DS0_STORAGE_H__
+
+#include "SFE_LSM9DS0.h"
+
+// Default EEPROM address of the profile. Override it with a build flag if
+// the sketch keeps something else there.
+#ifndef LSM9DS0_PROFILE_EEPROM_ADDR
+#define LSM9DS0_PROFILE_EEPROM_ADDR	0
+#endif
+
+// Default file used on Linux hosts.
+#ifndef LSM9DS0_PROFILE_PATH
+#define LSM9DS0_PROFILE_PATH	"lsm9ds0.profile"
+#endif
+
+#if defined(ARDUINO_ARCH_AVR)
+// saveLSM9DS0Profile() -- Write a profile to EEPROM.
+// Only bytes that changed are written, to spare EEPROM wear.
+// Input:
+//	- profile = The profile to save.
+//	- address = EEPROM address of the first byte.
+// Output: true if the profile fits in the EEPROM.
+bool saveLSM9DS0Profile(const LSM9DS0_profile & profile,
+						int address = LSM9DS0_PROFILE_EEPROM_ADDR);
+
+// loadLSM9DS0Profile() -- Read a profile back from EEPROM.
+// Input:
+//	- profile = Where the profile will be stored.
+//	- address = EEPROM address of the first byte.
+// Output: true if the profile fits in the EEPROM. The contents are only
+//	checked by begin(profile).
+bool loadLSM9DS0Profile(LSM9DS0_profile & profile,
+						int address = LSM9DS0_PROFILE_EEPROM_ADDR);
+#endif
+
+#if defined(__linux__)
+// saveLSM9DS0Profile() -- Write a profile to a file.
+// The file is written under a temporary name and renamed into place, so a
+// crash never leaves a half-written profile behind.
+// Input:
+//	- profile = The profile to save.
+//	- path = File to write.
+// Output: true on success.
+bool saveLSM9DS0Profile(const LSM9DS0_profile & profile,
+						const char * path = LSM9DS0_PROFILE_PATH);
+
+// loadLSM9DS0Profile() -- Read a profile back from a file.
+// Input:
+//	- profile = Where the profile will be stored.
+//	- path = File to read.
+// Output: true if a whole profile was read.
+bool loadLSM9DS0Profile(LSM9DS0_profile & profile,
+						const char * path = LSM9DS0_PROFILE_PATH);
+#endif
+
+#endif // __SFE_LSM9DS0_STORAGE_H__ //
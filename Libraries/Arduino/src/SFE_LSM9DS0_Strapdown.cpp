@@ -0,0 +1,151 @@
+/******************************************************************************
+SFE_LSM9DS0_Strapdown.cpp
+SFE_LSM9DS0 Library Strapdown Pre-Integration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the pre-integration stage declared in SFE_LSM9DS0_Strapdown.h.
+For sample m, with increments da (gyro) and dv (accel), and the sums a and
+v of the increments before it in this interval:
+
+	coning   += 1/2 (a + da' / 6) x da
+	sculling += 1/2 ((a + da' / 6) x dv + (v + dv' / 6) x da)
+
+where da' and dv' are the previous sample's. take() then outputs
+dTheta = a + coning and dV = v + 1/2 a x v + sculling.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Strapdown.h"
+#include <string.h>
+
+// cross() -- out += k * (u x v)
+static inline void cross(float * out, float k, const float * u, const float * v)
+{
+	out[0] += k * (u[1] * v[2] - u[2] * v[1]);
+	out[1] += k * (u[2] * v[0] - u[0] * v[2]);
+	out[2] += k * (u[0] * v[1] - u[1] * v[0]);
+}
+
+LSM9DS0Strapdown::LSM9DS0Strapdown()
+{
+	reset();
+}
+
+void LSM9DS0Strapdown::reset()
+{
+	memset(alpha, 0, sizeof(alpha));
+	memset(nu, 0, sizeof(nu));
+	memset(coning, 0, sizeof(coning));
+	memset(sculling, 0, sizeof(sculling));
+	memset(prevAlpha, 0, sizeof(prevAlpha));
+	memset(prevNu, 0, sizeof(prevNu));
+	time = 0;
+	count = 0;
+	flags = 0;
+	last = 0;
+	haveLast = false;
+}
+
+void LSM9DS0Strapdown::add(const float * g, const float * a, float dt)
+{
+	float da[3], dv[3], ca[3], cv[3];
+	for (int i = 0; i < 3; i++)
+	{
+		da[i] = g[i] * dt;
+		dv[i] = a[i] * LSM9DS0_GRAVITY * dt;
+		ca[i] = alpha[i] + prevAlpha[i] * (1.0f / 6);
+		cv[i] = nu[i] + prevNu[i] * (1.0f / 6);
+	}
+	cross(coning, 0.5f, ca, da);
+	cross(sculling, 0.5f, ca, dv);
+	cross(sculling, 0.5f, cv, da);
+	for (int i = 0; i < 3; i++)
+	{
+		alpha[i] += da[i];
+		nu[i] += dv[i];
+		prevAlpha[i] = da[i];
+		prevNu[i] = dv[i];
+	}
+	time += dt;
+	if (count < 0xFFFF)
+		count++;
+}
+
+void LSM9DS0Strapdown::addAligned(const LSM9DS0_aligned * s, uint8_t n,
+								  const LSM9DS0_frame_header & header)
+{
+	float period = header.gOdr > 0 ? 1.0f / header.gOdr : 0;
+	for (uint8_t k = 0; k < n; k++)
+	{
+		float g[3], a[3];
+		for (int i = 0; i < 3; i++)
+		{
+			g[i] = (s[k].g[i] * header.gRes - header.gbias[i]) * (PI / 180);
+			a[i] = s[k].a[i] * header.aRes - header.abias[i];
+		}
+		// Trust the timestamps unless they're off by more than a few
+		// periods (a restarted timeline, or the first sample).
+		float dt = haveLast ? (int32_t) (s[k].timestamp - last) * 1e-6f : 0;
+		if (dt <= 0 || dt > 4 * period)
+			dt = period;
+		last = s[k].timestamp;
+		haveLast = true;
+		add(g, a, dt);
+		flags |= s[k].flags;
+	}
+}
+
+bool LSM9DS0Strapdown::take(LSM9DS0_increment & out)
+{
+	if (!count)
+		return false;
+	out.timestamp = last;
+	out.dt = time;
+	out.samples = count;
+	out.flags = flags;
+	for (int i = 0; i < 3; i++)
+	{
+		out.dTheta[i] = alpha[i] + coning[i];
+		out.dV[i] = nu[i] + sculling[i];
+	}
+	cross(out.dV, 0.5f, alpha, nu);
+
+	memset(alpha, 0, sizeof(alpha));
+	memset(nu, 0, sizeof(nu));
+	memset(coning, 0, sizeof(coning));
+	memset(sculling, 0, sizeof(sculling));
+	time = 0;
+	count = 0;
+	flags = 0;
+	return true;
+}
+
+void LSM9DS0Strapdown::rotate(float * q, const float * dTheta)
+{
+	float angle = sqrt(dTheta[0] * dTheta[0] + dTheta[1] * dTheta[1] +
+					   dTheta[2] * dTheta[2]);
+	// Small angles: the series of sin(x/2)/x, which is exact to float
+	// precision there.
+	float w, k;
+	if (angle < 1e-3f)
+	{
+		w = 1.0f - angle * angle / 8;
+		k = 0.5f - angle * angle / 48;
+	}
+	else
+	{
+		w = cos(angle / 2);
+		k = sin(angle / 2) / angle;
+	}
+	float x = dTheta[0] * k, y = dTheta[1] * k, z = dTheta[2] * k;
+	float q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3];
+	q[0] = q1 * w - q2 * x - q3 * y - q4 * z;
+	q[1] = q1 * x + q2 * w + q3 * z - q4 * y;
+	q[2] = q1 * y - q2 * z + q3 * w + q4 * x;
+	q[3] = q1 * z + q2 * y - q3 * x + q4 * w;
+	float norm = 1.0f / sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] +
+							 q[3] * q[3]);
+	for (int i = 0; i < 4; i++)
+		q[i] *= norm;
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+SFE_LSM9DS0_Strapdown.h
+SFE_LSM9DS0 Library Strapdown Pre-Integration
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Running a fusion filter at the gyro's ODR (up to 760 Hz) is expensive, and
+running it once per loop() on the latest gyro reading throws away every
+sample in between. LSM9DS0Strapdown sits in between: it takes every gyro
+sample (with the accel at the same time, as LSM9DS0Align outputs them) and
+adds them up into one increment, which the slower loop then uses:
+
+	- dTheta, the rotation over the interval, as a rotation vector, with
+	  the coning correction: summing gyro samples alone misses the
+	  rotation that comes from the axis itself turning.
+	- dV, the velocity change from the specific force (what the accel
+	  measures, gravity included), in the body frame at the start of the
+	  interval, with the rotation and sculling corrections.
+
+Both use Savage's two-sample (current and previous sample) algorithms;
+see "Strapdown Inertial Navigation Integration Algorithm Design",
+Journal of Guidance, Control, and Dynamics 21(1), 1998.
+
+Typical use, with a filter running every 20 ms:
+	LSM9DS0Strapdown strap;
+	...
+	uint8_t n = align.addFrame(frame, out, LSM9DS0_FRAME_SAMPLES);
+	strap.addAligned(out, n, frame.header);
+	if (strap.elapsed() >= 0.02f && strap.take(inc))
+	{
+		// Mean rate and mean specific force over the increment
+		ahrs.update(inc.dV[0] / (inc.dt * LSM9DS0_GRAVITY), ...,
+					inc.dTheta[0] / inc.dt, ..., mx, my, mz, inc.dt);
+	}
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_STRAPDOWN_H__
+#define __SFE_LSM9DS0_STRAPDOWN_H__
+
+#include "SFE_LSM9DS0.h"
+#include "SFE_LSM9DS0_Align.h"
+
+#define LSM9DS0_GRAVITY		9.80665f	// m/s^2 per g
+
+// LSM9DS0_increment -- What take() hands over: everything that happened
+// since the last take().
+struct LSM9DS0_increment
+{
+	uint32_t timestamp;		// micros() of the newest sample in it
+	float dt;				// Time it covers, in seconds
+	float dTheta[3];		// Rotation vector, in radians
+	float dV[3];			// Velocity change from the specific force, in
+							// m/s, in the body frame at the start
+	uint16_t samples;		// Gyro samples in it
+	uint8_t flags;			// LSM9DS0_ALIGN_* flags of its samples, ORed
+};
+
+class LSM9DS0Strapdown
+{
+public:
+	// LSM9DS0Strapdown -- Constructor. Same as reset().
+	LSM9DS0Strapdown();
+
+	// reset() -- Start over, forgetting the increment so far and the
+	// previous sample.
+	void reset();
+
+	// add() -- Add one sample.
+	// Input:
+	//	- g = Rotation rate, in radians per second.
+	//	- a = Acceleration at the same time, in g's.
+	//	- dt = Time since the previous sample, in seconds.
+	void add(const float * g, const float * a, float dt);
+
+	// addAligned() -- Add samples from LSM9DS0Align::addFrame(). Raw ticks
+	// are scaled, and the biases removed, using the frame's header; the
+	// time between samples comes from their timestamps.
+	void addAligned(const LSM9DS0_aligned * s, uint8_t n,
+					const LSM9DS0_frame_header & header);
+
+	// samples() -- Samples in the increment so far.
+	uint16_t samples() { return count; }
+
+	// elapsed() -- Time the increment so far covers, in seconds.
+	float elapsed() { return time; }
+
+	// take() -- Hand over the increment so far, and start the next.
+	// Output: false if no sample was added since the last take().
+	bool take(LSM9DS0_increment & out);
+
+	// rotate() -- Turn an orientation quaternion (w, x, y, z) by a rotation
+	// vector in its body frame, such as dTheta.
+	static void rotate(float * q, const float * dTheta);
+
+private:
+	float alpha[3];		// Sum of the gyro increments
+	float nu[3];		// Sum of the accel increments
+	float coning[3];	// Coning correction so far
+	float sculling[3];	// Sculling correction so far
+	float prevAlpha[3];	// Gyro and accel increments of the previous
+	float prevNu[3];	// sample, which may be in the last increment
+	float time;
+	uint16_t count;
+	uint8_t flags;
+	uint32_t last;		// timestamp of the newest aligned sample
+	bool haveLast;
+};
+
+#endif // __SFE_LSM9DS0_STRAPDOWN_H__ //
@@ -0,0 +1,67 @@
+/******************************************************************************
+SFE_LSM9DS0_Watermark.cpp
+SFE_LSM9DS0 Library Adaptive FIFO Watermark
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements the watermark controller declared in SFE_LSM9DS0_Watermark.h.
+Lateness is kept in sixteenths of a sample, so the controller needs no
+floating point once begin() has converted the budget.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Watermark.h"
+
+// The FIFOs hold 32 samples; FIFO_SRC counts up to 31 of them.
+#define FIFO_DEPTH	32
+#define MAX_WTM		31
+// Lateness decays by 1/LATE_DECAY per drain: a spike is forgotten over a
+// few dozen drains.
+#define LATE_DECAY	16
+
+LSM9DS0Watermark::LSM9DS0Watermark(float odr, uint32_t budgetUs)
+{
+	begin(odr, budgetUs);
+}
+
+void LSM9DS0Watermark::begin(float odr, uint32_t budgetUs)
+{
+	float samples = odr * budgetUs / 1e6;
+	budget = (samples >= MAX_WTM) ? MAX_WTM : (uint8_t) samples;
+	late = 0;
+	wtm = target();
+}
+
+uint8_t LSM9DS0Watermark::target()
+{
+	uint8_t lateSamples = (late + 15) / 16;
+	// Room for the host's lateness, plus a sample, below the top...
+	int8_t t = FIFO_DEPTH - 1 - lateSamples;
+	// ...and no sample waits longer than the budget.
+	if (t > (int8_t) budget - lateSamples)
+		t = budget - lateSamples;
+	if (t < 1)
+		t = 1;
+	if (t > MAX_WTM)
+		t = MAX_WTM;
+	return t;
+}
+
+uint8_t LSM9DS0Watermark::update(uint8_t samples, bool overrun)
+{
+	// What came in past the watermark before the drain. A drain with fewer
+	// samples (e.g. woken by something else) says nothing about lateness.
+	uint16_t observed = (samples > wtm) ? (samples - wtm) * 16 : 0;
+	if (overrun)
+		observed = FIFO_DEPTH * 16;
+	late -= (late + LATE_DECAY - 1) / LATE_DECAY;
+	if (observed > late)
+		late = observed;
+
+	uint8_t t = target();
+	if (overrun || t < wtm)
+		wtm = t;
+	else if (t > wtm)
+		wtm++;
+	return wtm;
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+SFE_LSM9DS0_Watermark.h
+SFE_LSM9DS0 Library Adaptive FIFO Watermark
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+With setWatermarkInt(), a FIFO raises its interrupt pin once it holds
+watermark samples, and the host drains it in one burst. The watermark
+trades latency for overhead: a low one wakes the host, and costs a few bus
+transactions, for every handful of samples; a high one lets samples wait
+longer. LSM9DS0Watermark picks it for you, per FIFO:
+
+	- The latency budget caps how long a sample may wait in the FIFO, so
+	  watermark + lateness <= budget * ODR.
+	- The host's lateness -- samples that arrived between the watermark
+	  and the drain -- is tracked as a slowly decaying peak. The watermark
+	  leaves that much room (plus one sample) below the 32-sample top, so
+	  a busy host doesn't overrun the FIFO.
+	- Within those, the watermark is as high as it can be, to minimize
+	  wakeups and bus overhead. A small budget therefore means low
+	  latency, and a large one throughput.
+
+An overrun drops the watermark to the bottom right away. Otherwise it moves
+down at once and up one sample per drain, so it doesn't oscillate.
+
+Typical use:
+	LSM9DS0Watermark gWtm(190, 20000);	// 190 Hz, 20 ms budget
+	dof.setGyroFIFO(dof.FIFO_STREAM, gWtm.watermark());
+	dof.setWatermarkInt(true, false);
+	...
+	if (digitalRead(DRDYG))
+	{
+		dof.readFrame(frame);
+		uint8_t wtm = gWtm.watermark();
+		if (gWtm.update(frame.header.gCount + frame.header.gLater,
+						frame.header.flags & LSM9DS0_FRAME_G_OVERRUN) != wtm)
+			dof.setGyroWatermark(gWtm.watermark());
+	}
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_WATERMARK_H__
+#define __SFE_LSM9DS0_WATERMARK_H__
+
+#include "SFE_LSM9DS0.h"
+
+class LSM9DS0Watermark
+{
+public:
+	// LSM9DS0Watermark -- Constructor. Same as begin().
+	LSM9DS0Watermark(float odr = 0, uint32_t budgetUs = 0);
+
+	// begin() -- Start over for a FIFO.
+	// Input:
+	//	- odr = The FIFO's output data rate, in Hz.
+	//	- budgetUs = How long a sample may wait in the FIFO before it's
+	//	  read, in microseconds. 0 drains every sample as it arrives.
+	void begin(float odr, uint32_t budgetUs);
+
+	// update() -- Feed back one watermark-triggered drain.
+	// Input:
+	//	- samples = The FIFO's level at the drain: what it read plus what
+	//	  it left (a frame's gCount + gLater, or aCount + aLater).
+	//	- overrun = Whether the FIFO had overrun (e.g. the frame's
+	//	  LSM9DS0_FRAME_G_OVERRUN or LSM9DS0_FRAME_A_OVERRUN flag).
+	// Output: The watermark to use from now on (1-31).
+	uint8_t update(uint8_t samples, bool overrun);
+
+	// watermark() -- The current watermark, for setGyroFIFO(),
+	// setGyroWatermark(), or their accel counterparts.
+	uint8_t watermark() { return wtm; }
+
+	// lateness() -- The host's peak lateness, in samples.
+	float lateness() { return late / 16.0; }
+
+private:
+	uint8_t target();
+
+	uint8_t wtm;
+	uint8_t budget;		// The budget, in samples
+	uint16_t late;		// Peak lateness, in sixteenths of a sample
+};
+
+#endif // __SFE_LSM9DS0_WATERMARK_H__ //
@@ -0,0 +1,47 @@
+/******************************************************************************
+Arduino.h
+Host (Linux) stand-in for the Arduino core API
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Just enough of the Arduino core for the SFE_LSM9DS0 library to build and run
+on Linux: fixed-width types, timing, and pin I/O. Timing uses the monotonic
+clock. Pin reads and writes go to the current LSM9DS0HostBus (see
+SFE_LSM9DS0_HostBus.h), which uses them for SPI chip selects and interrupt
+lines.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH			0x1
+#define LOW				0x0
+#define INPUT			0x0
+#define OUTPUT			0x1
+#define INPUT_PULLUP	0x2
+#define LSBFIRST		0
+#define MSBFIRST		1
+
+#ifndef PI
+#define PI				3.1415926535897932384626433832795
+#endif
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+#endif // __HOST_ARDUINO_H__ //
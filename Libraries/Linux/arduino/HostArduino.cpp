@@ -0,0 +1,243 @@
+/******************************************************************************
+HostArduino.cpp
+Host (Linux) stand-in for the Arduino core, Wire, and SPI
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements Arduino.h, Wire.h, and SPI.h on top of the current
+LSM9DS0HostBus. With no bus selected, I2C transactions fail and reads
+return 0xFF, like a bus with nothing attached.
+
+The selected bus, Wire, and SPI are per thread, so threads driving
+devices on different buses (see SFE_LSM9DS0_Pipeline.h) don't interfere.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+#include "SFE_LSM9DS0_HostBus.h"
+
+#include <time.h>
+#include <errno.h>
+
+static thread_local LSM9DS0HostBus * hostBus = NULL;
+
+void setHostBus(LSM9DS0HostBus * bus)
+{
+	hostBus = bus;
+}
+
+LSM9DS0HostBus * getHostBus()
+{
+	return hostBus;
+}
+
+////////////
+// Timing //
+////////////
+static uint64_t monotonicMicros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Like an MCU's, these count from boot: CLOCK_MONOTONIC's zero. That makes
+// micros() timestamps (e.g. LSM9DS0_frame's) comparable across processes.
+unsigned long millis()
+{
+	return (unsigned long) (monotonicMicros() / 1000);
+}
+
+unsigned long micros()
+{
+	return (unsigned long) monotonicMicros();
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	struct timespec ts;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (long) (us % 1000000) * 1000;
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+		;
+}
+
+void delay(unsigned long ms)
+{
+	while (ms > 1000)
+	{
+		delayMicroseconds(1000000);
+		ms -= 1000;
+	}
+	delayMicroseconds(ms * 1000);
+}
+
+/////////
+// I/O //
+/////////
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	if (hostBus)
+		hostBus->pinWrite(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+	return hostBus ? hostBus->pinRead(pin) : LOW;
+}
+
+//////////
+// Wire //
+//////////
+thread_local TwoWire Wire;
+
+TwoWire::TwoWire() : txAddress(0), txLength(0), txPending(false),
+					 rxIndex(0), rxLength(0)
+{
+}
+
+void TwoWire::begin()
+{
+	txLength = rxIndex = rxLength = 0;
+	txPending = false;
+}
+
+void TwoWire::end()
+{
+	begin();
+}
+
+void TwoWire::setWireTimeout(uint32_t timeout, bool resetWithTimeout)
+{
+	// i2c-dev transfers are already bounded by the kernel's adapter timeout.
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+	if (hostBus)
+		hostBus->setI2CClock(clock);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	txAddress = address;
+	txLength = 0;
+	txPending = false;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+	if (txLength >= BUFFER_LENGTH)
+		return 0; // Same overflow behavior as the AVR library
+	txBuffer[txLength++] = data;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t * data, size_t quantity)
+{
+	size_t n = 0;
+	while (n < quantity && write(data[n]))
+		n++;
+	return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	if (!sendStop)
+	{
+		// Hold the write; requestFrom() sends it with a repeated start.
+		txPending = true;
+		return HOSTBUS_OK;
+	}
+	if (!hostBus)
+		return HOSTBUS_NACK_ADDRESS;
+	return hostBus->i2cTransfer(txAddress, txBuffer, txLength, NULL, 0);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop)
+{
+	rxIndex = rxLength = 0;
+	if (quantity > BUFFER_LENGTH)
+		quantity = BUFFER_LENGTH;
+
+	bool combined = txPending && txAddress == address;
+	txPending = false;
+	if (!hostBus)
+		return 0;
+	uint8_t status = hostBus->i2cTransfer(address, combined ? txBuffer : NULL,
+										  combined ? txLength : 0,
+										  rxBuffer, quantity);
+	if (status != HOSTBUS_OK)
+		return 0;
+	rxLength = quantity;
+	return quantity;
+}
+
+int TwoWire::available()
+{
+	return rxLength - rxIndex;
+}
+
+int TwoWire::read()
+{
+	if (rxIndex >= rxLength)
+		return -1;
+	return rxBuffer[rxIndex++];
+}
+
+/////////
+// SPI //
+/////////
+thread_local SPIClass SPI;
+
+void SPIClass::begin()
+{
+}
+
+void SPIClass::end()
+{
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+	if (hostBus)
+		hostBus->setSPIClock(settings.clock);
+}
+
+void SPIClass::endTransaction()
+{
+}
+
+void SPIClass::setClockDivider(uint8_t divider)
+{
+	// Report the clock a 16 MHz AVR would produce with this divider.
+	static const uint8_t shift[8] = {2, 4, 6, 7, 1, 3, 5, 7};
+	if (hostBus)
+		hostBus->setSPIClock(16000000UL >> shift[divider & 0x07]);
+}
+
+void SPIClass::setBitOrder(uint8_t bitOrder)
+{
+}
+
+void SPIClass::setDataMode(uint8_t dataMode)
+{
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+	return hostBus ? hostBus->spiTransfer(data) : 0xFF;
+}
+
+void SPIClass::transfer(void * buf, size_t count)
+{
+	uint8_t * p = (uint8_t *) buf;
+	for (size_t i = 0; i < count; i++)
+		p[i] = transfer(p[i]);
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+SPI.h
+Host (Linux) stand-in for the Arduino SPI library
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Mirrors the Arduino SPIClass API. Bytes are exchanged with the current
+LSM9DS0HostBus; chip selects are driven with digitalWrite(), as on an MCU.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+#include "Arduino.h"
+
+#define SPI_HAS_TRANSACTION 1
+
+#define SPI_CLOCK_DIV2		0x04
+#define SPI_CLOCK_DIV4		0x00
+#define SPI_CLOCK_DIV8		0x05
+#define SPI_CLOCK_DIV16		0x01
+#define SPI_CLOCK_DIV32		0x06
+#define SPI_CLOCK_DIV64		0x02
+#define SPI_CLOCK_DIV128	0x03
+
+#define SPI_MODE0	0x00
+#define SPI_MODE1	0x04
+#define SPI_MODE2	0x08
+#define SPI_MODE3	0x0C
+
+class SPISettings
+{
+public:
+	SPISettings() : clock(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+	SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+		: clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+	uint32_t clock;
+	uint8_t bitOrder;
+	uint8_t dataMode;
+};
+
+class SPIClass
+{
+public:
+	void begin();
+	void end();
+	void beginTransaction(SPISettings settings);
+	void endTransaction();
+	void setClockDivider(uint8_t divider);
+	void setBitOrder(uint8_t bitOrder);
+	void setDataMode(uint8_t dataMode);
+	uint8_t transfer(uint8_t data);
+	void transfer(void * buf, size_t count);
+};
+
+extern thread_local SPIClass SPI;
+
+#endif // __HOST_SPI_H__ //
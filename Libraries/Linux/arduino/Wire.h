@@ -0,0 +1,50 @@
+/******************************************************************************
+Wire.h
+Host (Linux) stand-in for the Arduino Wire (I2C) library
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Mirrors the Arduino TwoWire API, including its 32-byte buffers, so code
+that's correct here is correct on an AVR. Transactions are passed to the
+current LSM9DS0HostBus. A write ended with endTransmission(false) is held
+and sent together with the following requestFrom() as one repeated-start
+transaction, which is a single ioctl() on i2c-dev.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __HOST_WIRE_H__
+#define __HOST_WIRE_H__
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+// Like AVR Wire 1.8.13 and later: transactions can time out.
+#define WIRE_HAS_TIMEOUT
+
+class TwoWire
+{
+public:
+	TwoWire();
+	void begin();
+	void end();
+	void setClock(uint32_t clock);
+	void setWireTimeout(uint32_t timeout = 25000, bool resetWithTimeout = false);
+	void beginTransmission(uint8_t address);
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+	size_t write(uint8_t data);
+	size_t write(const uint8_t * data, size_t quantity);
+	int available();
+	int read();
+
+private:
+	uint8_t txAddress;
+	uint8_t txBuffer[BUFFER_LENGTH];
+	uint8_t txLength;
+	bool txPending;		// A write is being held for a repeated start
+	uint8_t rxBuffer[BUFFER_LENGTH];
+	uint8_t rxIndex, rxLength;
+};
+
+extern thread_local TwoWire Wire;
+
+#endif // __HOST_WIRE_H__ //
@@ -0,0 +1,61 @@
+/******************************************************************************
+SFE_LSM9DS0_HostBus.h
+SFE_LSM9DS0 Library Host Bus Interface
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+On Linux, the Wire, SPI, and pin functions of the Arduino stand-ins (see
+../arduino) all end up here. An LSM9DS0HostBus is either real hardware
+(LSM9DS0I2CDev, for /dev/i2c-N) or the simulated device (LSM9DS0Sim), so
+the same driver code runs against both.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_HOSTBUS_H__
+#define __SFE_LSM9DS0_HOSTBUS_H__
+
+#include <stdint.h>
+
+// Status codes returned by i2cTransfer(). These match the values of the
+// Arduino Wire library's endTransmission().
+#define HOSTBUS_OK				0
+#define HOSTBUS_NACK_ADDRESS	2
+#define HOSTBUS_NACK_DATA		3
+#define HOSTBUS_ERROR			4
+
+class LSM9DS0HostBus
+{
+public:
+	virtual ~LSM9DS0HostBus() {}
+
+	// i2cTransfer() -- One I2C transaction: an optional write followed,
+	// after a repeated start, by an optional read.
+	// Input:
+	//	- address = 7-bit slave address.
+	//	- wr, wrLen = Bytes to write (wrLen may be 0).
+	//	- rd, rdLen = Where to read bytes into (rdLen may be 0).
+	// Output: HOSTBUS_OK, or one of the HOSTBUS_* error codes.
+	virtual uint8_t i2cTransfer(uint8_t address, const uint8_t * wr,
+								uint8_t wrLen, uint8_t * rd, uint8_t rdLen) = 0;
+
+	// setI2CClock() -- Requested SCL frequency, in Hz.
+	virtual void setI2CClock(uint32_t hz) {}
+
+	// spiTransfer() -- Exchange one byte with the selected SPI device.
+	virtual uint8_t spiTransfer(uint8_t out) { return 0xFF; }
+
+	// setSPIClock() -- Requested SCK frequency, in Hz.
+	virtual void setSPIClock(uint32_t hz) {}
+
+	// pinWrite(), pinRead() -- digitalWrite() and digitalRead().
+	virtual void pinWrite(uint8_t pin, uint8_t value) {}
+	virtual int pinRead(uint8_t pin) { return 0; }
+};
+
+// setHostBus() -- Select the bus that Wire, SPI, and the pin functions use
+// on the calling thread. Each thread starts with none.
+void setHostBus(LSM9DS0HostBus * bus);
+
+// getHostBus() -- The calling thread's bus, or NULL.
+LSM9DS0HostBus * getHostBus();
+
+#endif // __SFE_LSM9DS0_HOSTBUS_H__ //
@@ -0,0 +1,75 @@
+/******************************************************************************
+SFE_LSM9DS0_I2CDev.cpp
+SFE_LSM9DS0 Library Linux i2c-dev Bus
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_I2CDev.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+LSM9DS0I2CDev::LSM9DS0I2CDev() : fd(-1)
+{
+}
+
+LSM9DS0I2CDev::~LSM9DS0I2CDev()
+{
+	close();
+}
+
+bool LSM9DS0I2CDev::open(const char * path)
+{
+	close();
+	fd = ::open(path, O_RDWR | O_CLOEXEC);
+	return fd >= 0;
+}
+
+void LSM9DS0I2CDev::close()
+{
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+uint8_t LSM9DS0I2CDev::i2cTransfer(uint8_t address, const uint8_t * wr,
+								   uint8_t wrLen, uint8_t * rd, uint8_t rdLen)
+{
+	struct i2c_msg msgs[2];
+	struct i2c_rdwr_ioctl_data xfer;
+	int n = 0;
+
+	if (fd < 0)
+		return HOSTBUS_ERROR;
+	if (wrLen || !rdLen) // A bare write (even empty) probes the address
+	{
+		msgs[n].addr = address;
+		msgs[n].flags = 0;
+		msgs[n].len = wrLen;
+		msgs[n].buf = (uint8_t *) wr;
+		n++;
+	}
+	if (rdLen)
+	{
+		msgs[n].addr = address;
+		msgs[n].flags = I2C_M_RD;
+		msgs[n].len = rdLen;
+		msgs[n].buf = rd;
+		n++;
+	}
+	xfer.msgs = msgs;
+	xfer.nmsgs = n;
+
+	if (ioctl(fd, I2C_RDWR, &xfer) == n)
+		return HOSTBUS_OK;
+	// Adapters report an address NACK as ENXIO or EREMOTEIO.
+	if (errno == ENXIO || errno == EREMOTEIO)
+		return HOSTBUS_NACK_ADDRESS;
+	return HOSTBUS_ERROR;
+}
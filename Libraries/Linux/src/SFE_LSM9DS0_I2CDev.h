@@ -0,0 +1,46 @@
+/******************************************************************************
+SFE_LSM9DS0_I2CDev.h
+SFE_LSM9DS0 Library Linux i2c-dev Bus
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+An LSM9DS0HostBus for real hardware on a Linux I2C adapter (/dev/i2c-N).
+Each Wire transaction becomes one I2C_RDWR ioctl(), so a register read is a
+single system call with a repeated start, as it is on an MCU.
+
+	LSM9DS0I2CDev bus;
+	if (!bus.open("/dev/i2c-1"))
+		...
+	setHostBus(&bus);
+	LSM9DS0 dof(MODE_I2C, 0x6B, 0x1D);
+	dof.begin();
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_I2CDEV_H__
+#define __SFE_LSM9DS0_I2CDEV_H__
+
+#include "SFE_LSM9DS0_HostBus.h"
+
+class LSM9DS0I2CDev : public LSM9DS0HostBus
+{
+public:
+	LSM9DS0I2CDev();
+	~LSM9DS0I2CDev();
+
+	// open() -- Open an I2C adapter.
+	// Input:
+	//	- path = Adapter device, e.g. "/dev/i2c-1".
+	// Output: true on success.
+	bool open(const char * path);
+
+	// close() -- Close the adapter. Also done by the destructor.
+	void close();
+
+	virtual uint8_t i2cTransfer(uint8_t address, const uint8_t * wr,
+								uint8_t wrLen, uint8_t * rd, uint8_t rdLen);
+
+private:
+	int fd;
+};
+
+#endif // __SFE_LSM9DS0_I2CDEV_H__ //
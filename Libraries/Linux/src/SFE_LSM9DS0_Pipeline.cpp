@@ -0,0 +1,444 @@
+/******************************************************************************
+SFE_LSM9DS0_Pipeline.cpp
+SFE_LSM9DS0 Library Multi-Threaded Acquisition/Conversion/Fusion Pipeline
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Pipeline.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <system_error>
+#include <time.h>
+
+static uint64_t monotonicNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleepUntilNs(uint64_t ns)
+{
+	struct timespec ts;
+	ts.tv_sec = ns / 1000000000ULL;
+	ts.tv_nsec = ns % 1000000000ULL;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
+
+//////////////////////
+// LSM9DS0Histogram //
+//////////////////////
+void LSM9DS0Histogram::reset()
+{
+	for (int i = 0; i < LSM9DS0_HISTOGRAM_BUCKETS; i++)
+		bucket[i].store(0, std::memory_order_relaxed);
+	n.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	lo.store(UINT64_MAX, std::memory_order_relaxed);
+	hi.store(0, std::memory_order_relaxed);
+}
+
+void LSM9DS0Histogram::add(uint64_t ns)
+{
+	// Bucket b holds [2^b, 2^(b+1)) ns; bucket 0 also holds 0.
+	int b = ns ? 63 - __builtin_clzll(ns) : 0;
+	if (b >= LSM9DS0_HISTOGRAM_BUCKETS)
+		b = LSM9DS0_HISTOGRAM_BUCKETS - 1;
+	// Single writer: plain read-modify-write, no locked instructions.
+	bucket[b].store(bucket[b].load(std::memory_order_relaxed) + 1,
+					std::memory_order_relaxed);
+	n.store(n.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	sum.store(sum.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+	if (ns < lo.load(std::memory_order_relaxed))
+		lo.store(ns, std::memory_order_relaxed);
+	if (ns > hi.load(std::memory_order_relaxed))
+		hi.store(ns, std::memory_order_relaxed);
+}
+
+uint64_t LSM9DS0Histogram::mean()
+{
+	uint64_t count = n.load(std::memory_order_relaxed);
+	return count ? sum.load(std::memory_order_relaxed) / count : 0;
+}
+
+uint64_t LSM9DS0Histogram::percentile(float p)
+{
+	uint64_t total = 0, counts[LSM9DS0_HISTOGRAM_BUCKETS];
+	for (int i = 0; i < LSM9DS0_HISTOGRAM_BUCKETS; i++)
+		total += counts[i] = bucket[i].load(std::memory_order_relaxed);
+	if (!total)
+		return 0;
+	uint64_t rank = (uint64_t) (total * p / 100.0f + 0.5f);
+	if (rank < 1)
+		rank = 1;
+	uint64_t seen = 0;
+	for (int i = 0; i < LSM9DS0_HISTOGRAM_BUCKETS; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			uint64_t upper = 2ULL << i;
+			return (upper < max()) ? upper : max();
+		}
+	}
+	return max();
+}
+
+void LSM9DS0Histogram::print(FILE * out, const char * name)
+{
+	uint64_t count = n.load(std::memory_order_relaxed);
+	fprintf(out, "%-8s %10llu  min %9.1f  mean %9.1f  p50 %9.1f  p99 %9.1f  max %9.1f us\n",
+			name, (unsigned long long) count, count ? min() / 1e3 : 0.0,
+			mean() / 1e3, percentile(50) / 1e3, percentile(99) / 1e3, max() / 1e3);
+}
+
+/////////////////////
+// LSM9DS0Pipeline //
+/////////////////////
+LSM9DS0Pipeline::LSM9DS0Pipeline() : deviceCount(0), busCount(0), threadCount(0),
+									 output(NULL),
+									 outputContext(NULL), running(false)
+{
+}
+
+LSM9DS0Pipeline::~LSM9DS0Pipeline()
+{
+	stop();
+}
+
+int LSM9DS0Pipeline::addDevice(LSM9DS0 & dof, LSM9DS0HostBus & bus)
+{
+	if (running || deviceCount >= LSM9DS0_PIPELINE_DEVICES)
+		return -1;
+	uint8_t b = 0;
+	while (b < busCount && buses[b] != &bus)
+		b++;
+	if (b == busCount)
+	{
+		buses[busCount++] = &bus;
+		if (threadCount < LSM9DS0_PIPELINE_THREADS)
+			threadCount++;
+	}
+
+	Device & dev = devices[deviceCount];
+	dev.dof = &dof;
+	dev.bus = &bus;
+	dev.busThread = b % LSM9DS0_PIPELINE_THREADS;
+	LSM9DS0HostBus * previous = getHostBus();
+	setHostBus(&bus);
+	dof.getProfile(dev.profile);
+	LSM9DS0_frame frame;
+	memset(&frame, 0, sizeof(frame));
+	dof.initFrame(frame);
+	dev.header = frame.header;
+	setHostBus(previous);
+	for (int i = 0; i < 3; i++)
+		dev.g[i] = dev.a[i] = dev.m[i] = 0.0f;
+	return deviceCount++;
+}
+
+void LSM9DS0Pipeline::setOutput(output_fn fn, void * context)
+{
+	output = fn;
+	outputContext = context;
+}
+
+bool LSM9DS0Pipeline::start(const Config & config)
+{
+	if (running || !deviceCount)
+		return false;
+	cfg = config;
+	for (uint8_t d = 0; d < deviceCount; d++)
+	{
+		devices[d].ahrs.beta = cfg.beta;
+		devices[d].ahrs.reset();
+		devices[d].align.begin(cfg.alignUs);
+	}
+
+	running = true;
+	try
+	{
+		fuseThread = std::thread(&LSM9DS0Pipeline::fuseLoop, this);
+		convertThread = std::thread(&LSM9DS0Pipeline::convertLoop, this);
+		for (uint8_t t = 0; t < threadCount; t++)
+			busThreads[t] = std::thread(&LSM9DS0Pipeline::busLoop, this, t);
+	}
+	catch (const std::system_error &)
+	{
+		stop();
+		return false;
+	}
+	return true;
+}
+
+void LSM9DS0Pipeline::stop()
+{
+	running = false;
+	for (uint8_t t = 0; t < threadCount; t++)
+	{
+		if (busThreads[t].joinable())
+			busThreads[t].join();
+	}
+	if (convertThread.joinable())
+		convertThread.join();
+	if (fuseThread.joinable())
+		fuseThread.join();
+}
+
+void LSM9DS0Pipeline::printStats(FILE * out)
+{
+	fprintf(out, "frames %llu, FIFO overruns %llu, attitudes %llu\n",
+			(unsigned long long) counters.frames.load(),
+			(unsigned long long) counters.fifoOverruns.load(),
+			(unsigned long long) counters.attitudes.load());
+	fprintf(out, "bus->convert: %llu dropped, %llu stalls; "
+			"convert->fuse: %llu dropped, %llu stalls\n",
+			(unsigned long long) counters.busDrops.load(),
+			(unsigned long long) counters.busStalls.load(),
+			(unsigned long long) counters.convertDrops.load(),
+			(unsigned long long) counters.convertStalls.load());
+	for (uint8_t t = 0; t < threadCount; t++)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "read%u", t);
+		counters.busRead[t].print(out, name);
+	}
+	counters.convert.print(out, "convert");
+	counters.fuse.print(out, "fuse");
+	counters.total.print(out, "total");
+}
+
+void LSM9DS0Pipeline::pin(int cpu)
+{
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+void LSM9DS0Pipeline::idle()
+{
+	if (cfg.idleUs)
+		sleepUntilNs(monotonicNs() + cfg.idleUs * 1000ULL);
+	else
+		sched_yield();
+}
+
+/////////////////////
+// Pipeline stages //
+/////////////////////
+void LSM9DS0Pipeline::busLoop(uint8_t thread)
+{
+	pin(cfg.busCpu < 0 ? -1 : cfg.busCpu + thread);
+	LSM9DS0Queue<BusItem, LSM9DS0_PIPELINE_DEPTH> & queue = busQueue[thread];
+	BusItem scratch; // Where dropped frames are read, to keep the FIFOs drained
+
+	uint64_t drainNs = cfg.drainUs * 1000ULL;
+	uint64_t next[LSM9DS0_PIPELINE_DEVICES];
+	uint64_t now = monotonicNs();
+	for (uint8_t d = 0; d < deviceCount; d++)
+		next[d] = now;
+
+	while (running)
+	{
+		now = monotonicNs();
+		uint64_t wake = now + drainNs;
+		for (uint8_t d = 0; d < deviceCount && running; d++)
+		{
+			Device & dev = devices[d];
+			if (dev.busThread != thread)
+				continue;
+			if (now < next[d])
+			{
+				if (next[d] < wake)
+					wake = next[d];
+				continue;
+			}
+			// Stay on the schedule, unless we've fallen a whole period behind.
+			next[d] += drainNs;
+			if (next[d] <= now)
+				next[d] = now + drainNs;
+			if (next[d] < wake)
+				wake = next[d];
+
+			BusItem * item = queue.reserve();
+			if (!item && cfg.busPolicy == BLOCK)
+			{
+				counters.busStalls++;
+				while (running && !(item = queue.reserve()))
+					idle();
+				if (!item)
+					break;
+			}
+			bool dropped = !item;
+			if (dropped)
+				item = &scratch;
+
+			setHostBus(dev.bus);
+			item->frame.header = dev.header;
+			item->device = d;
+			item->startNs = monotonicNs();
+			dev.dof->readFrame(item->frame);
+			item->readNs = monotonicNs();
+			dev.header = item->frame.header;
+
+			counters.busRead[thread].add(item->readNs - item->startNs);
+			counters.frames++;
+			if (item->frame.header.flags &
+				(LSM9DS0_FRAME_G_OVERRUN | LSM9DS0_FRAME_A_OVERRUN))
+				counters.fifoOverruns++;
+			if (dropped)
+				counters.busDrops++;
+			else
+				queue.commit();
+		}
+		if (running)
+			sleepUntilNs(wake);
+	}
+}
+
+void LSM9DS0Pipeline::convertLoop()
+{
+	pin(cfg.convertCpu);
+	while (running)
+	{
+		bool busy = false;
+		for (uint8_t t = 0; t < threadCount; t++)
+		{
+			BusItem * in = busQueue[t].front();
+			if (!in)
+				continue;
+			busy = true;
+			Converted * out = fuseQueue.reserve();
+			if (!out && cfg.convertPolicy == BLOCK)
+			{
+				counters.convertStalls++;
+				while (running && !(out = fuseQueue.reserve()))
+					idle();
+				if (!out)
+					return;
+			}
+			if (!out)
+			{
+				counters.convertDrops++;
+				busQueue[t].pop();
+				continue;
+			}
+			convertFrame(*in, *out);
+			uint64_t readNs = in->readNs;
+			busQueue[t].pop();
+			out->convertedNs = monotonicNs();
+			counters.convert.add(out->convertedNs - readNs);
+			fuseQueue.commit();
+		}
+		if (!busy)
+			idle();
+	}
+}
+
+void LSM9DS0Pipeline::fuseLoop()
+{
+	pin(cfg.fuseCpu);
+	while (running)
+	{
+		Converted * in = fuseQueue.front();
+		if (!in)
+		{
+			idle();
+			continue;
+		}
+		fuseFrame(*in);
+		fuseQueue.pop();
+	}
+}
+
+void LSM9DS0Pipeline::convertFrame(const BusItem & in, Converted & out)
+{
+	const LSM9DS0_frame & f = in.frame;
+	const LSM9DS0_frame_header & h = f.header;
+	Device & dev = devices[in.device];
+	out.device = in.device;
+	out.sequence = h.sequence;
+	out.timestamp = h.timestamp;
+	out.startNs = in.startNs;
+	out.gDt = (h.gOdr > 0) ? 1.0f / h.gOdr : 0.0f;
+
+	LSM9DS0_aligned aligned[LSM9DS0_FRAME_SAMPLES];
+	out.count = dev.align.addFrame(f, aligned, LSM9DS0_FRAME_SAMPLES);
+
+	// As calcAccelCal(): abias holds the calibration's offsets when it's in use.
+	const LSM9DS0_accel_cal & c = dev.profile.aCal;
+	bool cal = h.flags & LSM9DS0_FRAME_A_CAL;
+	for (uint8_t i = 0; i < out.count; i++)
+	{
+		const LSM9DS0_aligned & s = aligned[i];
+		float d[3];
+		for (int k = 0; k < 3; k++)
+		{
+			out.g[i][k] = h.gRes * s.g[k] - h.gbias[k];
+			out.m[i][k] = h.mRes * s.m[k];
+			d[k] = h.aRes * s.a[k] - h.abias[k];
+		}
+		if (cal)
+		{
+			out.a[i][0] = c.scale[0] * d[0] + c.cross[0] * d[1] + c.cross[1] * d[2];
+			out.a[i][1] = c.scale[1] * d[1] + c.cross[2] * d[2];
+			out.a[i][2] = c.scale[2] * d[2];
+		}
+		else
+		{
+			for (int k = 0; k < 3; k++)
+				out.a[i][k] = d[k];
+		}
+	}
+}
+
+void LSM9DS0Pipeline::fuseFrame(const Converted & in)
+{
+	Device & dev = devices[in.device];
+	LSM9DS0Attitude att;
+	for (uint8_t i = 0; i < in.count; i++)
+	{
+		const float * g = in.g[i];
+		const float * a = in.a[i];
+		const float * m = in.m[i];
+		dev.ahrs.update(a[0], a[1], a[2], g[0] * PI / 180.0f, g[1] * PI / 180.0f,
+						g[2] * PI / 180.0f, m[0], m[1], m[2], in.gDt);
+	}
+	if (in.count)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			dev.g[k] = in.g[in.count - 1][k];
+			dev.a[k] = in.a[in.count - 1][k];
+			dev.m[k] = in.m[in.count - 1][k];
+		}
+	}
+
+	att.device = in.device;
+	att.sequence = in.sequence;
+	att.timestamp = in.timestamp;
+	for (int k = 0; k < 4; k++)
+		att.q[k] = dev.ahrs.q[k];
+	for (int k = 0; k < 3; k++)
+	{
+		att.g[k] = dev.g[k];
+		att.a[k] = dev.a[k];
+		att.m[k] = dev.m[k];
+	}
+	uint64_t now = monotonicNs();
+	att.latencyNs = now - in.startNs;
+	counters.fuse.add(now - in.convertedNs);
+	counters.total.add(att.latencyNs);
+	counters.attitudes++;
+	if (output)
+		output(outputContext, att);
+}
@@ -0,0 +1,241 @@
+/******************************************************************************
+SFE_LSM9DS0_Pipeline.h
+SFE_LSM9DS0 Library Multi-Threaded Acquisition/Conversion/Fusion Pipeline
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+The examples read, convert, and fuse in one loop. LSM9DS0Pipeline splits
+that into stages, each on its own (optionally pinned) thread, connected by
+lock-free single-producer single-consumer queues (SFE_LSM9DS0_Queue.h):
+
+	bus threads --> conversion thread --> fusion thread --> output callback
+	(buses split    (calibration, units)  (one filter per device)
+	 among them)
+
+	- A bus thread drains the FIFOs of every device on its buses with
+	  readFrame(), straight into the conversion queue.
+	- The conversion thread resamples the accel and mag onto the gyro's
+	  timeline (LSM9DS0Align), then applies the resolution, biases, and
+	  the accel calibration, giving one 9-DoF vector per gyro sample.
+	- The fusion thread runs a Madgwick filter per device over those
+	  vectors, and hands an LSM9DS0Attitude per frame to the output.
+
+When a queue is full, its producer either waits (BLOCK: the backpressure
+reaches the device, whose FIFOs absorb up to 32 samples and then overrun)
+or drops the new item (DROP_NEWEST: a bus thread still drains the device,
+so its FIFOs never overrun). Each stage keeps a latency histogram.
+
+Typical use:
+	LSM9DS0Pipeline pipe;
+	pipe.addDevice(dof0, bus0);
+	pipe.addDevice(dof1, bus1);
+	pipe.setOutput(onAttitude, NULL);
+	pipe.start(config);
+	...
+	pipe.stop();
+	pipe.printStats(stdout);
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_PIPELINE_H__
+#define __SFE_LSM9DS0_PIPELINE_H__
+
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AHRS.h>
+#include <SFE_LSM9DS0_Align.h>
+#include "SFE_LSM9DS0_HostBus.h"
+#include "SFE_LSM9DS0_Queue.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+
+#define LSM9DS0_PIPELINE_DEVICES	16	// Devices per pipeline
+#define LSM9DS0_PIPELINE_THREADS	4	// Bus threads per pipeline
+#define LSM9DS0_PIPELINE_DEPTH		16	// Items per queue (power of two)
+#define LSM9DS0_HISTOGRAM_BUCKETS	32	// Powers of two of nanoseconds
+
+// LSM9DS0Histogram -- Log2 histogram of durations. One thread adds; any
+// thread may read (the counters are relaxed atomics).
+class LSM9DS0Histogram
+{
+public:
+	LSM9DS0Histogram() { reset(); }
+
+	void reset();
+
+	// add() -- Record one duration, in nanoseconds.
+	void add(uint64_t ns);
+
+	uint64_t count() { return n.load(std::memory_order_relaxed); }
+	uint64_t min() { return lo.load(std::memory_order_relaxed); }
+	uint64_t max() { return hi.load(std::memory_order_relaxed); }
+	uint64_t mean();
+
+	// percentile() -- Upper bound of the bucket holding the p-th
+	// percentile (0 < p <= 100), in nanoseconds.
+	uint64_t percentile(float p);
+
+	// print() -- One line: count, min, mean, p50, p99, max, in microseconds.
+	void print(FILE * out, const char * name);
+
+private:
+	std::atomic<uint64_t> bucket[LSM9DS0_HISTOGRAM_BUCKETS];
+	std::atomic<uint64_t> n, sum, lo, hi;
+};
+
+// LSM9DS0Attitude -- What the fusion stage outputs, once per frame.
+struct LSM9DS0Attitude
+{
+	uint8_t device;			// Index from addDevice()
+	uint32_t sequence;		// Sequence of the frame it came from
+	uint64_t timestamp;		// micros() of the frame
+	float q[4];				// Orientation quaternion: w, x, y, z
+	float g[3];				// Last gyro sample, in DPS, bias removed
+	float a[3];				// Accel at its time, in g's, calibrated
+	float m[3];				// Mag at its time, in Gs
+	uint64_t latencyNs;		// From the start of the bus read to now
+};
+
+class LSM9DS0Pipeline
+{
+public:
+	// backpressure -- What a stage does when the next stage's queue is full.
+	enum backpressure
+	{
+		BLOCK,			// Wait for room
+		DROP_NEWEST,	// Discard the new item, and count it
+	};
+
+	struct Config
+	{
+		uint32_t drainUs;		// Time between FIFO drains of each device
+		backpressure busPolicy;		// Bus -> conversion queue
+		backpressure convertPolicy;	// Conversion -> fusion queue
+		int busCpu;				// CPU of the first bus thread (the others
+								// follow), or -1 for no pinning. Pinning
+								// is best-effort.
+		int convertCpu;			// CPU of the conversion thread, or -1
+		int fuseCpu;			// CPU of the fusion thread, or -1
+		uint32_t idleUs;		// Sleep when a queue is empty; 0 spins
+		float beta;				// Madgwick gain
+		uint32_t alignUs;		// Longest a gyro sample waits for the
+								// accel and mag (LSM9DS0Align)
+
+		Config() : drainUs(20000), busPolicy(DROP_NEWEST),
+				   convertPolicy(DROP_NEWEST), busCpu(-1), convertCpu(-1),
+				   fuseCpu(-1), idleUs(100), beta(LSM9DS0_MADGWICK_BETA),
+				   alignUs(50000) {}
+	};
+
+	// Counters, readable while running.
+	struct Stats
+	{
+		std::atomic<uint64_t> frames;		// Frames read by bus threads
+		std::atomic<uint64_t> busDrops;		// Dropped: conversion queue full
+		std::atomic<uint64_t> convertDrops;	// Dropped: fusion queue full
+		std::atomic<uint64_t> busStalls;	// Waits for room (BLOCK)
+		std::atomic<uint64_t> convertStalls;
+		std::atomic<uint64_t> fifoOverruns;	// Frames with a FIFO overrun
+		std::atomic<uint64_t> attitudes;	// Outputs delivered
+		LSM9DS0Histogram busRead[LSM9DS0_PIPELINE_THREADS];	// readFrame(), per thread
+		LSM9DS0Histogram convert;	// Bus read done -> converted
+		LSM9DS0Histogram fuse;		// Converted -> fused
+		LSM9DS0Histogram total;		// Bus read start -> output
+
+		Stats() : frames(0), busDrops(0), convertDrops(0), busStalls(0),
+				  convertStalls(0), fifoOverruns(0), attitudes(0) {}
+	};
+
+	typedef void (* output_fn)(void * context, const LSM9DS0Attitude & attitude);
+
+	LSM9DS0Pipeline();
+	~LSM9DS0Pipeline();
+
+	// addDevice() -- Add a device, before start().
+	// The device must be set up (begin(), calibration, setAccelCal()) with
+	// both FIFOs in stream mode; its profile and frame header are taken
+	// now, on the calling thread's bus. Each bus object is served by one
+	// bus thread; with more buses than LSM9DS0_PIPELINE_THREADS, threads
+	// serve several.
+	// Input:
+	//	- dof = The device.
+	//	- bus = The bus it's on.
+	// Output: The device's index, or -1 if there's no room.
+	int addDevice(LSM9DS0 & dof, LSM9DS0HostBus & bus);
+
+	// setOutput() -- Function the fusion thread calls for every attitude.
+	void setOutput(output_fn fn, void * context);
+
+	// start() -- Start the threads.
+	// Output: false if there are no devices, or a thread couldn't start.
+	bool start(const Config & config = Config());
+
+	// stop() -- Stop and join the threads. Also done by the destructor.
+	void stop();
+
+	Stats & stats() { return counters; }
+
+	// printStats() -- Counters and histograms, one per line.
+	void printStats(FILE * out);
+
+private:
+	// BusItem -- A frame on its way from a bus thread to conversion.
+	struct BusItem
+	{
+		LSM9DS0_frame frame;
+		uint8_t device;
+		uint64_t startNs, readNs;
+	};
+
+	// Converted -- A frame's aligned samples in physical units, on their
+	// way to fusion.
+	struct Converted
+	{
+		uint8_t device, count;
+		uint32_t sequence;
+		float gDt;				// Gyro sample period, in seconds
+		uint64_t timestamp;
+		uint64_t startNs, convertedNs;
+		float g[LSM9DS0_FRAME_SAMPLES][3];	// DPS
+		float a[LSM9DS0_FRAME_SAMPLES][3];	// g's
+		float m[LSM9DS0_FRAME_SAMPLES][3];	// Gs
+	};
+
+	struct Device
+	{
+		LSM9DS0 * dof;
+		LSM9DS0HostBus * bus;
+		uint8_t busThread;
+		LSM9DS0_frame_header header;	// Carried from frame to frame
+		LSM9DS0_profile profile;		// For the accel calibration
+		LSM9DS0Align align;				// Used by the conversion thread
+		LSM9DS0Madgwick ahrs;
+		float g[3], a[3], m[3];			// Latest aligned sample
+	};
+
+	void busLoop(uint8_t thread);
+	void convertLoop();
+	void fuseLoop();
+	void convertFrame(const BusItem & in, Converted & out);
+	void fuseFrame(const Converted & in);
+	void idle();
+	static void pin(int cpu);
+
+	Device devices[LSM9DS0_PIPELINE_DEVICES];
+	uint8_t deviceCount;
+	LSM9DS0HostBus * buses[LSM9DS0_PIPELINE_DEVICES];
+	uint8_t busCount, threadCount;
+
+	LSM9DS0Queue<BusItem, LSM9DS0_PIPELINE_DEPTH> busQueue[LSM9DS0_PIPELINE_THREADS];
+	LSM9DS0Queue<Converted, LSM9DS0_PIPELINE_DEPTH> fuseQueue;
+
+	Config cfg;
+	output_fn output;
+	void * outputContext;
+	Stats counters;
+	std::atomic<bool> running;
+	std::thread busThreads[LSM9DS0_PIPELINE_THREADS];
+	std::thread convertThread, fuseThread;
+};
+
+#endif // __SFE_LSM9DS0_PIPELINE_H__ //
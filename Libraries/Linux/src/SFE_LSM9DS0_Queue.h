@@ -0,0 +1,86 @@
+/******************************************************************************
+SFE_LSM9DS0_Queue.h
+SFE_LSM9DS0 Library Lock-Free Single-Producer Single-Consumer Queue
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+LSM9DS0Queue connects two pipeline stages, each on its own thread. Items
+are filled and consumed in place (reserve()/commit() and front()/pop()), so
+a stage can read the device straight into the next stage's queue. The
+producer and consumer indices live on separate cache lines, and each side
+caches the other's index, so a push or pop normally touches no line the
+other thread is writing.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_QUEUE_H__
+#define __SFE_LSM9DS0_QUEUE_H__
+
+#include <atomic>
+#include <stdint.h>
+
+// N must be a power of two. One slot is always left empty, so at most
+// N - 1 items are queued.
+template <typename T, uint32_t N>
+class LSM9DS0Queue
+{
+public:
+	LSM9DS0Queue() : head(0), tail(0), cachedTail(0), cachedHead(0) {}
+
+	// reserve() -- Producer: the slot to fill next, or NULL if full.
+	T * reserve()
+	{
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if (((h + 1) & (N - 1)) == cachedTail)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (((h + 1) & (N - 1)) == cachedTail)
+				return 0;
+		}
+		return &slot[h];
+	}
+
+	// commit() -- Producer: publish the slot from reserve().
+	void commit()
+	{
+		uint32_t h = head.load(std::memory_order_relaxed);
+		head.store((h + 1) & (N - 1), std::memory_order_release);
+	}
+
+	// front() -- Consumer: the oldest item, or NULL if empty.
+	T * front()
+	{
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t == cachedHead)
+		{
+			cachedHead = head.load(std::memory_order_acquire);
+			if (t == cachedHead)
+				return 0;
+		}
+		return &slot[t];
+	}
+
+	// pop() -- Consumer: release the item from front().
+	void pop()
+	{
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		tail.store((t + 1) & (N - 1), std::memory_order_release);
+	}
+
+	// size() -- Items queued. Exact only on the producer or consumer.
+	uint32_t size()
+	{
+		return (head.load(std::memory_order_acquire) -
+				tail.load(std::memory_order_acquire)) & (N - 1);
+	}
+
+private:
+	typedef char capacity_is_power_of_two[(N >= 2 && (N & (N - 1)) == 0) ? 1 : -1];
+
+	alignas(64) std::atomic<uint32_t> head;	// Written by the producer
+	alignas(64) std::atomic<uint32_t> tail;	// Written by the consumer
+	alignas(64) uint32_t cachedTail;		// Producer's copy of tail
+	alignas(64) uint32_t cachedHead;		// Consumer's copy of head
+	alignas(64) T slot[N];
+};
+
+#endif // __SFE_LSM9DS0_QUEUE_H__ //
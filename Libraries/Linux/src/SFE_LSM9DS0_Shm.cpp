@@ -0,0 +1,488 @@
+/******************************************************************************
+SFE_LSM9DS0_Shm.cpp
+SFE_LSM9DS0 Library Shared-Memory Sample Ring
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Implements LSM9DS0ShmWriter and LSM9DS0ShmReader. The slot payload is held
+in atomic words (relaxed loads and stores, ordered by the sequence word), so
+a reader racing the writer is well-defined, not just usually harmless.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Shm.h"
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <linux/futex.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef char lsm9ds0_shm_sample_is_16_bytes[sizeof(LSM9DS0ShmSample) == 16 ? 1 : -1];
+
+struct LSM9DS0ShmSlot
+{
+	std::atomic<uint64_t> seq;		// Sample index + 1, or 0 while writing
+	std::atomic<uint64_t> word[2];	// The LSM9DS0ShmSample
+};
+
+// The header is padded so the writer's hot words (head, futex) don't share
+// a cache line with the read-mostly fields.
+struct LSM9DS0ShmRing
+{
+	std::atomic<uint32_t> magic;	// Set last, once the ring is ready
+	uint32_t version;
+	uint32_t capacity;				// Slots; a power of two
+	uint32_t reserved;
+	std::atomic<float> scale[3];	// Units per tick, by LSM9DS0_SENSOR_*
+	uint8_t pad0[64 - 28];
+	std::atomic<uint64_t> head;		// Index of the next sample to write
+	std::atomic<uint32_t> futex;	// Bumped once per published batch
+	std::atomic<uint32_t> waiters;	// Readers sleeping on futex
+	uint8_t pad1[64 - 16];
+	LSM9DS0ShmSlot slot[1];			// capacity slots
+};
+
+// The frame ring has the same header, with frames in place of slots.
+struct LSM9DS0ShmFrameRing
+{
+	std::atomic<uint32_t> magic;	// Set last, once the ring is ready
+	uint32_t version;
+	uint32_t capacity;				// Frames; a power of two
+	uint16_t frameSize;				// sizeof(LSM9DS0_frame)
+	uint16_t frameVersion;			// LSM9DS0_FRAME_VERSION
+	uint8_t pad0[64 - 16];
+	std::atomic<uint64_t> head;		// Index of the next frame to write
+	std::atomic<uint32_t> futex;
+	std::atomic<uint32_t> waiters;
+	uint8_t pad1[64 - 16];
+	LSM9DS0_frame frame[1];			// capacity frames
+};
+
+#define LSM9DS0_SHM_FRAMES_MAGIC	0x524D534C	// "LSMR"
+
+static uint32_t ringBytes(uint32_t capacity)
+{
+	return offsetof(LSM9DS0ShmRing, slot) + capacity * sizeof(LSM9DS0ShmSlot);
+}
+
+static uint32_t frameRingBytes(uint32_t capacity)
+{
+	return offsetof(LSM9DS0ShmFrameRing, frame) + capacity * sizeof(LSM9DS0_frame);
+}
+
+static uint32_t ringCapacity(uint32_t requested)
+{
+	uint32_t capacity = 16;
+	while (capacity < requested && capacity < (1UL << 24))
+		capacity <<= 1;
+	return capacity;
+}
+
+// createShm() -- Create, size, and map a zero-filled shared memory object.
+// Any old one of that name is unlinked first, so readers still mapping it
+// keep it, and anyone opening from now on gets the new one.
+static void * createShm(const char * name, uint32_t size)
+{
+	shm_unlink(name);
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+	if (fd < 0)
+		return NULL;
+	void * p = MAP_FAILED;
+	if (ftruncate(fd, size) == 0)
+		p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED)
+	{
+		shm_unlink(name);
+		return NULL;
+	}
+	return p;
+}
+
+// openShm() -- Map an existing shared memory object of at least minSize.
+// It's mapped read-write only because futex waits and the waiters count
+// need it; readers never write the data.
+static void * openShm(const char * name, uint32_t minSize, uint32_t & size)
+{
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0)
+		return NULL;
+	// The size comes from the object itself, so a reader that opens it
+	// between the writer's ftruncate() and its setting magic just fails.
+	struct stat st;
+	void * p = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t) minSize)
+		p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED)
+		return NULL;
+	size = st.st_size;
+	return p;
+}
+
+static long futex(std::atomic<uint32_t> * addr, int op, uint32_t val,
+				  const struct timespec * timeout)
+{
+	// The futex word is shared between processes, so no FUTEX_PRIVATE_FLAG.
+	return syscall(SYS_futex, (uint32_t *) addr, op, val, timeout, NULL, 0);
+}
+
+// waitFor() -- Sleep on a ring's futex until head passes next.
+// Sequentially consistent, paired with the writers' publish(): either the
+// reader sees the new futex value, or the writer sees the waiters count.
+static bool waitFor(std::atomic<uint32_t> & word, std::atomic<uint32_t> & waiters,
+					std::atomic<uint64_t> & head, uint64_t next, int timeoutMs)
+{
+	uint32_t seen = word.load();
+	if (head.load(std::memory_order_acquire) > next)
+		return true;
+
+	struct timespec ts, * timeout = NULL;
+	if (timeoutMs >= 0)
+	{
+		ts.tv_sec = timeoutMs / 1000;
+		ts.tv_nsec = (long) (timeoutMs % 1000) * 1000000;
+		timeout = &ts;
+	}
+	waiters.fetch_add(1);
+	// Returns at once (EAGAIN) if a batch was published since 'seen'.
+	futex(&word, FUTEX_WAIT, seen, timeout);
+	waiters.fetch_sub(1);
+	return head.load(std::memory_order_acquire) > next;
+}
+
+//////////////////////
+// LSM9DS0ShmWriter //
+//////////////////////
+LSM9DS0ShmWriter::LSM9DS0ShmWriter() : ring(NULL), size(0), name(NULL)
+{
+}
+
+LSM9DS0ShmWriter::~LSM9DS0ShmWriter()
+{
+	close();
+}
+
+bool LSM9DS0ShmWriter::create(const char * shmName, uint32_t slots)
+{
+	close();
+	uint32_t capacity = ringCapacity(slots);
+	size = ringBytes(capacity);
+	ring = (LSM9DS0ShmRing *) createShm(shmName, size);
+	if (!ring)
+		return false;
+
+	// ftruncate() zero-filled it, so every slot's seq is already 0.
+	name = strdup(shmName);
+	ring->version = LSM9DS0_SHM_VERSION;
+	ring->capacity = capacity;
+	for (int i = 0; i < 3; i++)
+		ring->scale[i].store(0, std::memory_order_relaxed);
+	ring->head.store(0, std::memory_order_relaxed);
+	ring->magic.store(LSM9DS0_SHM_MAGIC, std::memory_order_release);
+	return true;
+}
+
+void LSM9DS0ShmWriter::close()
+{
+	if (ring)
+	{
+		// Wake any sleepers, so they notice the ring has gone quiet.
+		ring->futex.fetch_add(1);
+		futex(&ring->futex, FUTEX_WAKE, INT_MAX, NULL);
+		munmap(ring, size);
+		ring = NULL;
+	}
+	if (name)
+	{
+		shm_unlink(name);
+		free(name);
+		name = NULL;
+	}
+}
+
+void LSM9DS0ShmWriter::setScales(float gyro, float accel, float mag)
+{
+	if (!ring)
+		return;
+	ring->scale[LSM9DS0_SENSOR_GYRO].store(gyro);
+	ring->scale[LSM9DS0_SENSOR_ACCEL].store(accel);
+	ring->scale[LSM9DS0_SENSOR_MAG].store(mag);
+}
+
+void LSM9DS0ShmWriter::publish(const LSM9DS0ShmSample * samples, uint32_t count)
+{
+	if (!ring || !count)
+		return;
+	uint32_t mask = ring->capacity - 1;
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+
+	for (uint32_t i = 0; i < count; i++, head++)
+	{
+		LSM9DS0ShmSlot & s = ring->slot[head & mask];
+		uint64_t w[2];
+		memcpy(w, &samples[i], sizeof(w));
+		s.seq.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		s.word[0].store(w[0], std::memory_order_relaxed);
+		s.word[1].store(w[1], std::memory_order_relaxed);
+		s.seq.store(head + 1, std::memory_order_release);
+	}
+	ring->head.store(head, std::memory_order_release);
+
+	// Sequentially consistent, paired with wait(): either the reader sees
+	// the new futex value, or this sees its waiters count.
+	ring->futex.fetch_add(1);
+	if (ring->waiters.load())
+		futex(&ring->futex, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+//////////////////////
+// LSM9DS0ShmReader //
+//////////////////////
+LSM9DS0ShmReader::LSM9DS0ShmReader() : ring(NULL), size(0), next(0), lost(0)
+{
+}
+
+LSM9DS0ShmReader::~LSM9DS0ShmReader()
+{
+	close();
+}
+
+bool LSM9DS0ShmReader::open(const char * name)
+{
+	close();
+	ring = (LSM9DS0ShmRing *) openShm(name, ringBytes(16), size);
+	if (!ring)
+		return false;
+	if (ring->magic.load(std::memory_order_acquire) != LSM9DS0_SHM_MAGIC ||
+		ring->version != LSM9DS0_SHM_VERSION ||
+		ringBytes(ring->capacity) > size)
+	{
+		close();
+		return false;
+	}
+	next = ring->head.load(std::memory_order_acquire);
+	lost = 0;
+	return true;
+}
+
+void LSM9DS0ShmReader::close()
+{
+	if (ring)
+	{
+		munmap(ring, size);
+		ring = NULL;
+	}
+}
+
+float LSM9DS0ShmReader::scale(uint8_t sensor)
+{
+	if (!ring || sensor > LSM9DS0_SENSOR_MAG)
+		return 0;
+	return ring->scale[sensor].load();
+}
+
+uint32_t LSM9DS0ShmReader::read(LSM9DS0ShmSample * dest, uint32_t maxSamples)
+{
+	if (!ring)
+		return 0;
+	uint32_t capacity = ring->capacity;
+	uint32_t n = 0;
+
+	while (n < maxSamples)
+	{
+		uint64_t head = ring->head.load(std::memory_order_acquire);
+		if (next >= head)
+			break;
+		if (head - next > capacity) // Lapped: skip to the oldest sample left
+		{
+			lost += head - capacity - next;
+			next = head - capacity;
+		}
+
+		LSM9DS0ShmSlot & s = ring->slot[next & (capacity - 1)];
+		uint64_t seq = s.seq.load(std::memory_order_acquire);
+		uint64_t w[2];
+		w[0] = s.word[0].load(std::memory_order_relaxed);
+		w[1] = s.word[1].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (seq != next + 1 || s.seq.load(std::memory_order_relaxed) != seq)
+		{
+			// The writer overwrote this slot while we were copying it, so
+			// it's already at least a ring ahead: resynchronize.
+			lost++;
+			next++;
+			continue;
+		}
+		memcpy(&dest[n++], w, sizeof(w));
+		next++;
+	}
+	return n;
+}
+
+bool LSM9DS0ShmReader::wait(int timeoutMs)
+{
+	if (!ring)
+		return false;
+	return waitFor(ring->futex, ring->waiters, ring->head, next, timeoutMs);
+}
+
+///////////////////////////
+// LSM9DS0ShmFrameWriter //
+///////////////////////////
+LSM9DS0ShmFrameWriter::LSM9DS0ShmFrameWriter() : ring(NULL), size(0), name(NULL)
+{
+}
+
+LSM9DS0ShmFrameWriter::~LSM9DS0ShmFrameWriter()
+{
+	close();
+}
+
+bool LSM9DS0ShmFrameWriter::create(const char * shmName, uint32_t frames,
+								   const LSM9DS0_frame & init)
+{
+	close();
+	uint32_t capacity = ringCapacity(frames);
+	size = frameRingBytes(capacity);
+	ring = (LSM9DS0ShmFrameRing *) createShm(shmName, size);
+	if (!ring)
+		return false;
+
+	name = strdup(shmName);
+	ring->version = LSM9DS0_SHM_VERSION;
+	ring->capacity = capacity;
+	ring->frameSize = sizeof(LSM9DS0_frame);
+	ring->frameVersion = LSM9DS0_FRAME_VERSION;
+	for (uint32_t i = 0; i < capacity; i++)
+	{
+		memcpy(&ring->frame[i], &init, sizeof(init));
+		ring->frame[i].header.generation = 0;
+		ring->frame[i].header.sequence = 0;
+	}
+	ring->head.store(0, std::memory_order_relaxed);
+	ring->magic.store(LSM9DS0_SHM_FRAMES_MAGIC, std::memory_order_release);
+	return true;
+}
+
+void LSM9DS0ShmFrameWriter::close()
+{
+	if (ring)
+	{
+		ring->futex.fetch_add(1);
+		futex(&ring->futex, FUTEX_WAKE, INT_MAX, NULL);
+		munmap(ring, size);
+		ring = NULL;
+	}
+	if (name)
+	{
+		shm_unlink(name);
+		free(name);
+		name = NULL;
+	}
+}
+
+LSM9DS0_frame * LSM9DS0ShmFrameWriter::next()
+{
+	if (!ring)
+		return NULL;
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	LSM9DS0_frame & f = ring->frame[head & (ring->capacity - 1)];
+	startLSM9DS0FrameWrite(f);
+	f.header.sequence = head; // readFrame() adds one
+	return &f;
+}
+
+void LSM9DS0ShmFrameWriter::publish()
+{
+	if (!ring)
+		return;
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	LSM9DS0_frame & f = ring->frame[head & (ring->capacity - 1)];
+	if (getLSM9DS0FrameGeneration(f) & 1)
+	{
+		f.header.sequence = head + 1;
+		finishLSM9DS0FrameWrite(f);
+	}
+	ring->head.store(head + 1, std::memory_order_release);
+	ring->futex.fetch_add(1);
+	if (ring->waiters.load())
+		futex(&ring->futex, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+///////////////////////////
+// LSM9DS0ShmFrameReader //
+///////////////////////////
+LSM9DS0ShmFrameReader::LSM9DS0ShmFrameReader()
+	: ring(NULL), size(0), nextIndex(0), lost(0)
+{
+}
+
+LSM9DS0ShmFrameReader::~LSM9DS0ShmFrameReader()
+{
+	close();
+}
+
+bool LSM9DS0ShmFrameReader::open(const char * name)
+{
+	close();
+	ring = (LSM9DS0ShmFrameRing *) openShm(name, frameRingBytes(16), size);
+	if (!ring)
+		return false;
+	if (ring->magic.load(std::memory_order_acquire) != LSM9DS0_SHM_FRAMES_MAGIC ||
+		ring->version != LSM9DS0_SHM_VERSION ||
+		ring->frameSize != sizeof(LSM9DS0_frame) ||
+		ring->frameVersion != LSM9DS0_FRAME_VERSION ||
+		frameRingBytes(ring->capacity) > size)
+	{
+		close();
+		return false;
+	}
+	nextIndex = ring->head.load(std::memory_order_acquire);
+	lost = 0;
+	return true;
+}
+
+void LSM9DS0ShmFrameReader::close()
+{
+	if (ring)
+	{
+		munmap(ring, size);
+		ring = NULL;
+	}
+}
+
+const LSM9DS0_frame * LSM9DS0ShmFrameReader::next()
+{
+	if (!ring)
+		return NULL;
+	uint64_t head = ring->head.load(std::memory_order_acquire);
+	if (nextIndex >= head)
+		return NULL;
+	// The writer may already be filling the oldest frame, so a reader more
+	// than capacity - 1 behind skips ahead.
+	uint32_t capacity = ring->capacity;
+	if (head - nextIndex > capacity - 1)
+	{
+		lost += head - (capacity - 1) - nextIndex;
+		nextIndex = head - (capacity - 1);
+	}
+	return &ring->frame[nextIndex++ & (capacity - 1)];
+}
+
+bool LSM9DS0ShmFrameReader::wait(int timeoutMs)
+{
+	if (!ring)
+		return false;
+	return waitFor(ring->futex, ring->waiters, ring->head, nextIndex, timeoutMs);
+}
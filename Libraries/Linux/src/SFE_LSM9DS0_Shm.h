@@ -0,0 +1,220 @@
+/******************************************************************************
+SFE_LSM9DS0_Shm.h
+SFE_LSM9DS0 Library Shared-Memory Sample Ring
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+One writer (lsm9ds0d) publishes samples into a ring in POSIX shared memory.
+Any number of readers map the same ring and consume it at their own pace.
+Readers never block the writer, and never need a system call per sample:
+
+	- Every slot carries a sequence word. The writer zeroes it, fills the
+	  slot, then sets it to the sample's index + 1 (a per-slot seqlock). A
+	  reader copies the slot and checks that word before and after, so a
+	  slot overwritten mid-copy is detected rather than returned torn.
+	- A reader that falls more than a ring's length behind skips ahead to
+	  the oldest sample still in the ring, and counts what it missed.
+	- A reader with nothing to read can sleep on a futex. The writer bumps
+	  it once per batch, and only makes the wake-up system call if a reader
+	  is actually waiting.
+
+Writer:
+	LSM9DS0ShmWriter ring;
+	ring.create("/lsm9ds0", 4096);
+	ring.setScales(dof.calcGyro(1), dof.calcAccel(1), dof.calcMag(1));
+	ring.publish(samples, n);
+
+Reader:
+	LSM9DS0ShmReader ring;
+	ring.open("/lsm9ds0");
+	LSM9DS0ShmSample buf[64];
+	while (ring.wait(1000))
+		for (uint32_t n; (n = ring.read(buf, 64)) > 0; )
+			...
+
+LSM9DS0ShmFrameWriter and LSM9DS0ShmFrameReader do the same for whole
+LSM9DS0_frames (SFE_LSM9DS0_Frame.h), which readers use in place rather than
+copy out: LSM9DS0::readFrame() drains the device straight into the ring,
+and a reader works on the frame where it lies, then checks its generation.
+
+	LSM9DS0ShmFrameReader frames;
+	frames.open(LSM9DS0_SHM_FRAMES_NAME);
+	while (frames.wait(1000))
+		for (const LSM9DS0_frame * f; (f = frames.next()) != NULL; )
+		{
+			uint32_t gen = getLSM9DS0FrameGeneration(*f);
+			...
+			if (!checkLSM9DS0FrameGeneration(*f, gen))
+				... it was overwritten: discard ...
+		}
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_SHM_H__
+#define __SFE_LSM9DS0_SHM_H__
+
+#include <stdint.h>
+#include "SFE_LSM9DS0_Frame.h"
+
+#define LSM9DS0_SHM_MAGIC		0x394D534C	// "LSM9"
+#define LSM9DS0_SHM_VERSION		1
+#define LSM9DS0_SHM_NAME		"/lsm9ds0"
+#define LSM9DS0_SHM_FRAMES_NAME	"/lsm9ds0.frames"
+
+// Values of LSM9DS0ShmSample::sensor.
+#define LSM9DS0_SENSOR_GYRO		0
+#define LSM9DS0_SENSOR_ACCEL	1
+#define LSM9DS0_SENSOR_MAG		2
+
+// One raw sample, 16 bytes.
+struct LSM9DS0ShmSample
+{
+	uint64_t timestamp;		// CLOCK_MONOTONIC, in nanoseconds
+	int16_t data[3];		// Raw x, y, z readings
+	uint8_t sensor;			// LSM9DS0_SENSOR_*
+	uint8_t reserved;
+};
+
+struct LSM9DS0ShmRing; // The shared layout, private to SFE_LSM9DS0_Shm.cpp
+
+class LSM9DS0ShmWriter
+{
+public:
+	LSM9DS0ShmWriter();
+	~LSM9DS0ShmWriter();
+
+	// create() -- Create (or replace) the shared-memory ring.
+	// Input:
+	//	- name = POSIX shared memory name, e.g. LSM9DS0_SHM_NAME.
+	//	- slots = Ring length in samples. Rounded up to a power of two.
+	// Output: true on success.
+	bool create(const char * name, uint32_t slots);
+
+	// close() -- Unmap and unlink the ring. Also done by the destructor.
+	// Readers that still have it mapped keep working, but see no new data.
+	void close();
+
+	// setScales() -- Units per raw tick, published for readers.
+	// Input:
+	//	- gyro = DPS per tick, e.g. calcGyro(1).
+	//	- accel = g's per tick, e.g. calcAccel(1).
+	//	- mag = Gs per tick, e.g. calcMag(1).
+	void setScales(float gyro, float accel, float mag);
+
+	// publish() -- Append samples and wake any waiting readers.
+	// Input:
+	//	- samples, count = The samples, oldest first.
+	void publish(const LSM9DS0ShmSample * samples, uint32_t count);
+
+private:
+	LSM9DS0ShmRing * ring;
+	uint32_t size;
+	char * name;
+};
+
+class LSM9DS0ShmReader
+{
+public:
+	LSM9DS0ShmReader();
+	~LSM9DS0ShmReader();
+
+	// open() -- Map an existing ring. Reading starts with the next sample
+	// published.
+	// Output: false if it doesn't exist or has the wrong version.
+	bool open(const char * name);
+
+	// close() -- Unmap the ring. Also done by the destructor.
+	void close();
+
+	// read() -- Copy out the samples published since the last read().
+	// Input:
+	//	- dest, maxSamples = Where to store them, and how many fit.
+	// Output: The number of samples stored, oldest first.
+	uint32_t read(LSM9DS0ShmSample * dest, uint32_t maxSamples);
+
+	// wait() -- Sleep until there's something to read().
+	// Input:
+	//	- timeoutMs = Longest wait, in milliseconds. Negative waits forever.
+	// Output: true if there's something to read(), false on a timeout.
+	bool wait(int timeoutMs);
+
+	// dropped() -- Samples overwritten before this reader got to them.
+	uint64_t dropped() { return lost; }
+
+	// scale() -- Units per raw tick of one sensor (LSM9DS0_SENSOR_*).
+	float scale(uint8_t sensor);
+
+private:
+	LSM9DS0ShmRing * ring;
+	uint32_t size;
+	uint64_t next;		// Index of the next sample to read
+	uint64_t lost;
+};
+
+struct LSM9DS0ShmFrameRing; // Private to SFE_LSM9DS0_Shm.cpp
+
+class LSM9DS0ShmFrameWriter
+{
+public:
+	LSM9DS0ShmFrameWriter();
+	~LSM9DS0ShmFrameWriter();
+
+	// create() -- Create (or replace) the shared-memory frame ring.
+	// Input:
+	//	- name = POSIX shared memory name, e.g. LSM9DS0_SHM_FRAMES_NAME.
+	//	- frames = Ring length in frames. Rounded up to a power of two.
+	//	- init = Copied into every frame, e.g. one set up by initFrame().
+	// Output: true on success.
+	bool create(const char * name, uint32_t frames, const LSM9DS0_frame & init);
+
+	// close() -- Unmap and unlink the ring. Also done by the destructor.
+	void close();
+
+	// next() -- The frame to fill next, in place, e.g. with readFrame().
+	// It's the oldest in the ring. It's marked as being written, and its
+	// sequence set so readFrame() numbers it by its place in the ring.
+	LSM9DS0_frame * next();
+
+	// publish() -- Make the frame from next() visible and wake readers.
+	// Marks it written, if the caller didn't.
+	void publish();
+
+private:
+	LSM9DS0ShmFrameRing * ring;
+	uint32_t size;
+	char * name;
+};
+
+class LSM9DS0ShmFrameReader
+{
+public:
+	LSM9DS0ShmFrameReader();
+	~LSM9DS0ShmFrameReader();
+
+	// open() -- Map an existing frame ring. Reading starts with the next
+	// frame published.
+	// Output: false if it doesn't exist, or its ring or frame layout
+	//	version or size differs from this build's.
+	bool open(const char * name);
+
+	// close() -- Unmap the ring. Also done by the destructor.
+	void close();
+
+	// next() -- The next unread frame, in place, or NULL if there's none.
+	// It stays valid (though it may be overwritten) until the ring is
+	// closed; check its generation after using it.
+	const LSM9DS0_frame * next();
+
+	// wait() -- Sleep until next() has a frame, as LSM9DS0ShmReader::wait().
+	bool wait(int timeoutMs);
+
+	// dropped() -- Frames overwritten before this reader got to them.
+	uint64_t dropped() { return lost; }
+
+private:
+	LSM9DS0ShmFrameRing * ring;
+	uint32_t size;
+	uint64_t nextIndex;
+	uint64_t lost;
+};
+
+#endif // __SFE_LSM9DS0_SHM_H__ //
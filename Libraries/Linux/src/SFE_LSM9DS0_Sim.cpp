@@ -0,0 +1,464 @@
+/******************************************************************************
+SFE_LSM9DS0_Sim.cpp
+SFE_LSM9DS0 Library Simulated LSM9DS0
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Sim.h"
+#include "SFE_LSM9DS0.h" // For the register addresses
+
+#define CHIP_G		0
+#define CHIP_XM		1
+#define SENSOR_G	0
+#define SENSOR_A	1
+#define SENSOR_M	2
+#define NO_PIN		0xFF
+
+// Sample rates, in Hz, indexed by the ODR bits of each sensor.
+static const double gyroODR[4] = {95, 190, 380, 760};
+static const double accelODR[16] = {0, 3.125, 6.25, 12.5, 25, 50, 100, 200,
+									400, 800, 1600, 0, 0, 0, 0, 0};
+static const double magODR[8] = {3.125, 6.25, 12.5, 25, 50, 100, 0, 0};
+
+// Full scales, indexed by FS, AFS, and MFS. These match the driver's
+// calcgRes(), calcaRes(), and calcmRes().
+static const double gyroFS[4] = {245, 500, 2000, 2000};
+static const double accelFS[8] = {2, 4, 6, 8, 16, 16, 16, 16};
+static const double magFS[4] = {2, 4, 8, 12};
+
+LSM9DS0Sim::LSM9DS0Sim(uint8_t gAddr, uint8_t xmAddr)
+	: transactions(0), bytes(0), payload(0), spiClock(0), i2cClock(0),
+	  faultEvery(0), gAddress(gAddr), xmAddress(xmAddr),
+	  csG(NO_PIN), csXM(NO_PIN), pinDrdyG(NO_PIN), pinInt1XM(NO_PIN),
+	  pinInt2XM(NO_PIN), spiChip(-1), spiCount(0), spiRead(false),
+	  spiIncrement(false), rng(0x2545F491), faultCount(0)
+{
+	memset(sensors, 0, sizeof(sensors));
+	reset(CHIP_G);
+	reset(CHIP_XM);
+}
+
+void LSM9DS0Sim::setChipSelects(uint8_t g, uint8_t xm)
+{
+	csG = g;
+	csXM = xm;
+}
+
+void LSM9DS0Sim::setInterruptPins(uint8_t drdyG, uint8_t int1XM, uint8_t int2XM)
+{
+	pinDrdyG = drdyG;
+	pinInt1XM = int1XM;
+	pinInt2XM = int2XM;
+}
+
+void LSM9DS0Sim::reset(uint8_t chip)
+{
+	Chip & c = chips[chip];
+	memset(c.reg, 0, sizeof(c.reg));
+	c.ptr = 0;
+	if (chip == CHIP_G)
+	{
+		c.reg[WHO_AM_I_G] = 0xD4;
+		c.reg[CTRL_REG1_G] = 0x07; // Powered down, all axes enabled
+		memset(&sensors[SENSOR_G], 0, sizeof(Sensor));
+	}
+	else
+	{
+		c.reg[WHO_AM_I_XM] = 0x49;
+		c.reg[CTRL_REG1_XM] = 0x07; // Powered down, all axes enabled
+		c.reg[CTRL_REG5_XM] = 0x18;
+		c.reg[CTRL_REG6_XM] = 0x20;
+		c.reg[CTRL_REG7_XM] = 0x02; // Mag powered down
+		c.reg[INT_CTRL_REG_M] = 0xE8;
+		memset(&sensors[SENSOR_A], 0, sizeof(Sensor));
+		memset(&sensors[SENSOR_M], 0, sizeof(Sensor));
+	}
+	rescheduleAll();
+}
+
+float LSM9DS0Sim::noise(float sigma)
+{
+	// Sum of four uniforms: close enough to Gaussian, and cheap.
+	float sum = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		sum += (rng & 0xFFFF) / 65535.0f - 0.5f;
+	}
+	return sum * sigma * 1.7320508f; // Variance of the sum is 4/12
+}
+
+static int16_t toRaw(double value, double fullScale)
+{
+	double raw = value * 32768.0 / fullScale;
+	if (raw > 32767)
+		return 32767;
+	if (raw < -32768)
+		return -32768;
+	return (int16_t) lround(raw);
+}
+
+void LSM9DS0Sim::generate(uint8_t sensor, double t, int16_t * out)
+{
+	// The board yaws back and forth: rate 20 sin(2 PI 0.1 t) DPS about z.
+	const double w = 2 * PI * 0.1;
+	double yaw = 20.0 / w * (1 - cos(w * t)) * PI / 180; // Integral of rate
+	const uint8_t * g = chips[CHIP_G].reg;
+	const uint8_t * xm = chips[CHIP_XM].reg;
+
+	if (sensor == SENSOR_G)
+	{
+		double v[3] = {0.8, -0.5, 0.3 + 20 * sin(w * t)}; // Bias + rate
+		uint8_t st = (g[CTRL_REG4_G] >> 1) & 0x3;
+		double stSign = (st == 1) ? 1 : (st == 3) ? -1 : 0;
+		v[0] += 100 * stSign; // Self-test 0: x+, y-, z-
+		v[1] -= 100 * stSign;
+		v[2] -= 100 * stSign;
+		double fs = gyroFS[(g[CTRL_REG4_G] >> 4) & 0x3];
+		for (int i = 0; i < 3; i++)
+			out[i] = toRaw(v[i] + noise(0.1), fs);
+	}
+	else if (sensor == SENSOR_A)
+	{
+		double v[3] = {0.02 * sin(2 * PI * 120 * t), 0, 1};
+		uint8_t ast = (xm[CTRL_REG2_XM] >> 1) & 0x3;
+		double stSign = (ast == 1) ? 1 : (ast == 2) ? -1 : 0;
+		double fs = accelFS[(xm[CTRL_REG2_XM] >> 3) & 0x7];
+		for (int i = 0; i < 3; i++)
+			out[i] = toRaw(v[i] + 0.5 * stSign + noise(0.002), fs);
+	}
+	else
+	{
+		// A 0.25 Gs horizontal, -0.4 Gs vertical field, seen from the board.
+		double v[3] = {0.25 * cos(yaw), -0.25 * sin(yaw), -0.4};
+		double fs = magFS[(xm[CTRL_REG6_XM] >> 5) & 0x3];
+		for (int i = 0; i < 3; i++)
+			out[i] = toRaw(v[i] + noise(0.002), fs);
+	}
+}
+
+bool LSM9DS0Sim::fifoActive(uint8_t sensor)
+{
+	if (sensor == SENSOR_G)
+		return (chips[CHIP_G].reg[CTRL_REG5_G] & 0x40) &&
+			   (chips[CHIP_G].reg[FIFO_CTRL_REG_G] >> 5);
+	if (sensor == SENSOR_A)
+		return (chips[CHIP_XM].reg[CTRL_REG0_XM] & 0x40) &&
+			   (chips[CHIP_XM].reg[FIFO_CTRL_REG] >> 5);
+	return false;
+}
+
+void LSM9DS0Sim::push(uint8_t sensor, const int16_t * sample)
+{
+	Sensor & s = sensors[sensor];
+	if (s.newData)
+		s.dataOverrun = true;
+	s.newData = true;
+	memcpy(s.latest, sample, sizeof(s.latest));
+	if (!fifoActive(sensor))
+		return;
+
+	uint8_t mode = (sensor == SENSOR_G ? chips[CHIP_G].reg[FIFO_CTRL_REG_G]
+									   : chips[CHIP_XM].reg[FIFO_CTRL_REG]) >> 5;
+	if (s.count == 32)
+	{
+		s.overrun = true;
+		if (mode == 1) // FIFO mode stops collecting when full
+			return;
+		s.head = (s.head + 1) % 32; // Stream modes drop the oldest sample
+		s.count--;
+	}
+	memcpy(s.fifo[(s.head + s.count) % 32], sample, sizeof(s.latest));
+	s.count++;
+}
+
+void LSM9DS0Sim::rescheduleAll()
+{
+	uint64_t now = micros();
+	for (int i = 0; i < 3; i++)
+		sensors[i].next = now;
+}
+
+void LSM9DS0Sim::update()
+{
+	uint64_t now = micros();
+	const uint8_t * g = chips[CHIP_G].reg;
+	const uint8_t * xm = chips[CHIP_XM].reg;
+	double odr[3];
+
+	odr[SENSOR_G] = (g[CTRL_REG1_G] & 0x08) ? gyroODR[g[CTRL_REG1_G] >> 6] : 0;
+	odr[SENSOR_A] = accelODR[xm[CTRL_REG1_XM] >> 4];
+	odr[SENSOR_M] = 0;
+	if ((xm[CTRL_REG7_XM] & 0x03) == 0) // Continuous conversion
+		odr[SENSOR_M] = (xm[CTRL_REG7_XM] & 0x04) ? 3.125 :
+						magODR[(xm[CTRL_REG5_XM] >> 2) & 0x7];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		Sensor & s = sensors[i];
+		if (odr[i] <= 0)
+		{
+			s.next = now;
+			continue;
+		}
+		double period = 1e6 / odr[i];
+		// After a long idle, only the last FIFO's worth of samples matters.
+		if (now > s.next + (uint64_t) (40 * period))
+			s.next = now - (uint64_t) (40 * period);
+		while (s.next <= now)
+		{
+			int16_t sample[3];
+			generate(i, s.next / 1e6, sample);
+			push(i, sample);
+			s.next += (uint64_t) period;
+		}
+	}
+
+	// Temperature: 8 LSB per degree, 12-bit, enabled by TEMP_EN.
+	if (xm[CTRL_REG5_XM] & 0x80)
+	{
+		int16_t temp = 32 + (int16_t) noise(1);
+		chips[CHIP_XM].reg[OUT_TEMP_L_XM] = temp & 0xFF;
+		chips[CHIP_XM].reg[OUT_TEMP_H_XM] = (temp >> 8) & 0x0F;
+	}
+}
+
+uint8_t LSM9DS0Sim::fifoSource(uint8_t sensor)
+{
+	const Sensor & s = sensors[sensor];
+	uint8_t wtm = (sensor == SENSOR_G ? chips[CHIP_G].reg[FIFO_CTRL_REG_G]
+									  : chips[CHIP_XM].reg[FIFO_CTRL_REG]) & 0x1F;
+	uint8_t src = s.count > 31 ? 31 : s.count;
+	if (s.count >= wtm && fifoActive(sensor))
+		src |= 0x80;
+	if (s.overrun)
+		src |= 0x40;
+	if (s.count == 0)
+		src |= 0x20;
+	return src;
+}
+
+uint8_t LSM9DS0Sim::readReg(uint8_t chip)
+{
+	Chip & c = chips[chip];
+	uint8_t addr = c.ptr;
+	uint8_t value = c.reg[addr];
+	uint8_t sensor = (chip == CHIP_G) ? SENSOR_G : SENSOR_A;
+
+	if (addr >= OUT_X_L_G && addr <= OUT_Z_H_G) // Same for OUT_*_A
+	{
+		Sensor & s = sensors[sensor];
+		const int16_t * sample = s.latest;
+		bool fifo = fifoActive(sensor);
+		if (fifo && s.count)
+			sample = s.fifo[s.head];
+		uint8_t i = addr - OUT_X_L_G;
+		value = (i & 1) ? (sample[i / 2] >> 8) & 0xFF : sample[i / 2] & 0xFF;
+		if (addr == OUT_Z_H_G)
+		{
+			s.newData = s.dataOverrun = false;
+			if (fifo && s.count)
+			{
+				s.head = (s.head + 1) % 32;
+				s.count--;
+				s.overrun = false;
+			}
+		}
+	}
+	else if (chip == CHIP_XM && addr >= OUT_X_L_M && addr <= OUT_Z_H_M)
+	{
+		Sensor & s = sensors[SENSOR_M];
+		uint8_t i = addr - OUT_X_L_M;
+		value = (i & 1) ? (s.latest[i / 2] >> 8) & 0xFF : s.latest[i / 2] & 0xFF;
+		if (addr == OUT_Z_H_M)
+			s.newData = s.dataOverrun = false;
+	}
+	else if (addr == STATUS_REG_G) // Same address as STATUS_REG_A
+	{
+		Sensor & s = sensors[sensor];
+		value = (s.newData ? 0x0F : 0) | (s.dataOverrun ? 0xF0 : 0);
+	}
+	else if (chip == CHIP_XM && addr == STATUS_REG_M)
+	{
+		Sensor & s = sensors[SENSOR_M];
+		value = (s.newData ? 0x0F : 0) | (s.dataOverrun ? 0xF0 : 0);
+	}
+	else if (addr == FIFO_SRC_REG_G) // Same address as FIFO_SRC_REG
+		value = fifoSource(sensor);
+	return value;
+}
+
+void LSM9DS0Sim::advance(uint8_t chip)
+{
+	// While a FIFO is enabled, reads wrap from OUT_Z_H back to OUT_X_L, so
+	// a burst can drain several samples.
+	Chip & c = chips[chip];
+	uint8_t sensor = (chip == CHIP_G) ? SENSOR_G : SENSOR_A;
+	if (c.ptr == OUT_Z_H_G && fifoActive(sensor))
+		c.ptr = OUT_X_L_G;
+	else
+		c.ptr = (c.ptr + 1) & 0x3F;
+}
+
+void LSM9DS0Sim::writeReg(uint8_t chip, uint8_t value)
+{
+	Chip & c = chips[chip];
+	uint8_t addr = c.ptr;
+
+	// Read-only registers ignore writes.
+	if (addr == WHO_AM_I_G || addr == STATUS_REG_G || addr == FIFO_SRC_REG_G ||
+		(addr >= OUT_X_L_G && addr <= OUT_Z_H_G))
+		return;
+	if (chip == CHIP_XM && addr <= OUT_Z_H_M)
+		return;
+	c.reg[addr] = value;
+
+	if (chip == CHIP_G)
+	{
+		Sensor & s = sensors[SENSOR_G];
+		if (addr == CTRL_REG5_G && (value & 0x80)) // BOOT
+			reset(CHIP_G);
+		else if ((addr == FIFO_CTRL_REG_G && (value >> 5) == 0) ||
+				 (addr == CTRL_REG5_G && !(value & 0x40)))
+			s.count = s.head = 0, s.overrun = false; // Bypass empties it
+		else if (addr == CTRL_REG1_G)
+			rescheduleAll();
+	}
+	else
+	{
+		Sensor & s = sensors[SENSOR_A];
+		if (addr == CTRL_REG0_XM && (value & 0x80)) // BOOT
+			reset(CHIP_XM);
+		else if ((addr == FIFO_CTRL_REG && (value >> 5) == 0) ||
+				 (addr == CTRL_REG0_XM && !(value & 0x40)))
+			s.count = s.head = 0, s.overrun = false;
+		else if (addr == CTRL_REG1_XM || addr == CTRL_REG5_XM ||
+				 addr == CTRL_REG7_XM)
+			rescheduleAll();
+	}
+}
+
+uint8_t LSM9DS0Sim::i2cTransfer(uint8_t address, const uint8_t * wr,
+								uint8_t wrLen, uint8_t * rd, uint8_t rdLen)
+{
+	uint8_t chip;
+	if (address == gAddress)
+		chip = CHIP_G;
+	else if (address == xmAddress)
+		chip = CHIP_XM;
+	else
+		return HOSTBUS_NACK_ADDRESS;
+	if (faultEvery && ++faultCount % faultEvery == 0)
+		return HOSTBUS_NACK_ADDRESS;
+
+	transactions++;
+	// Plus the device address, sent again after a repeated start.
+	bytes += wrLen + rdLen + ((wrLen && rdLen) ? 2 : 1);
+	payload += rdLen + (wrLen ? wrLen - 1 : 0);
+	update();
+
+	Chip & c = chips[chip];
+	bool increment = true;
+	if (wrLen)
+	{
+		// The first byte is the sub-address; bit 7 enables auto-increment.
+		c.ptr = wr[0] & 0x3F;
+		increment = wr[0] & 0x80;
+		for (uint8_t i = 1; i < wrLen; i++)
+		{
+			writeReg(chip, wr[i]);
+			if (increment)
+				c.ptr = (c.ptr + 1) & 0x3F;
+		}
+	}
+	for (uint8_t i = 0; i < rdLen; i++)
+	{
+		rd[i] = readReg(chip);
+		if (increment)
+			advance(chip);
+	}
+	return HOSTBUS_OK;
+}
+
+uint8_t LSM9DS0Sim::spiTransfer(uint8_t out)
+{
+	if (spiChip < 0)
+		return 0xFF; // Nothing selected: MISO floats high
+	bytes++;
+
+	Chip & c = chips[spiChip];
+	if (spiCount++ == 0)
+	{
+		// Command byte: RW (bit 7), MS auto-increment (bit 6), address.
+		update();
+		spiRead = out & 0x80;
+		spiIncrement = out & 0x40;
+		c.ptr = out & 0x3F;
+		return 0xFF;
+	}
+	payload++;
+	uint8_t in = 0xFF;
+	if (spiRead)
+		in = readReg(spiChip);
+	else
+		writeReg(spiChip, out);
+	if (spiIncrement)
+		advance(spiChip);
+	return in;
+}
+
+void LSM9DS0Sim::pinWrite(uint8_t pin, uint8_t value)
+{
+	int8_t chip = (pin == csG) ? CHIP_G : (pin == csXM) ? CHIP_XM : -1;
+	if (chip < 0)
+		return;
+	if (value == LOW)
+	{
+		spiChip = chip;
+		spiCount = 0;
+		transactions++;
+	}
+	else if (spiChip == chip)
+		spiChip = -1;
+}
+
+int LSM9DS0Sim::pinRead(uint8_t pin)
+{
+	if (pin == NO_PIN)
+		return LOW;
+	update();
+	const uint8_t * g = chips[CHIP_G].reg;
+	const uint8_t * xm = chips[CHIP_XM].reg;
+	const Sensor & sg = sensors[SENSOR_G];
+	const Sensor & sa = sensors[SENSOR_A];
+	const Sensor & sm = sensors[SENSOR_M];
+	bool level = false;
+
+	if (pin == pinDrdyG) // CTRL_REG3_G: I2_DRDY I2_WTM I2_ORUN I2_EMPTY
+	{
+		uint8_t src = fifoSource(SENSOR_G);
+		level = ((g[CTRL_REG3_G] & 0x08) && sg.newData) ||
+				((g[CTRL_REG3_G] & 0x04) && (src & 0x80)) ||
+				((g[CTRL_REG3_G] & 0x02) && (src & 0x40)) ||
+				((g[CTRL_REG3_G] & 0x01) && (src & 0x20));
+	}
+	else if (pin == pinInt1XM) // CTRL_REG3_XM: ... P1_DRDYA P1_DRDYM P1_EMPTY
+	{
+		level = ((xm[CTRL_REG3_XM] & 0x04) && sa.newData) ||
+				((xm[CTRL_REG3_XM] & 0x02) && sm.newData) ||
+				((xm[CTRL_REG3_XM] & 0x01) && (fifoSource(SENSOR_A) & 0x20));
+	}
+	else if (pin == pinInt2XM) // CTRL_REG4_XM: ... P2_DRDYA P2_DRDYM P2_Overrun P2_WTM
+	{
+		uint8_t src = fifoSource(SENSOR_A);
+		level = ((xm[CTRL_REG4_XM] & 0x08) && sa.newData) ||
+				((xm[CTRL_REG4_XM] & 0x04) && sm.newData) ||
+				((xm[CTRL_REG4_XM] & 0x02) && (src & 0x40)) ||
+				((xm[CTRL_REG4_XM] & 0x01) && (src & 0x80));
+	}
+	return level ? HIGH : LOW;
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+SFE_LSM9DS0_Sim.h
+SFE_LSM9DS0 Library Simulated LSM9DS0
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+LSM9DS0Sim is an LSM9DS0HostBus that behaves like an LSM9DS0 on the bus,
+so the driver, the daemon, and anything built on them can be run and tested
+without hardware. It models, over both I2C and SPI:
+	- Both register files, WHO_AM_I values, and register auto-increment.
+	- Sample generation at the configured ODRs, in real time.
+	- Full-scale settings, the gyro/accel self-test actuation, and the
+	  temperature sensor.
+	- The 32-sample gyro and accel FIFOs: bypass, FIFO, and stream modes
+	  (the trigger modes behave like stream), watermark and overrun flags,
+	  and the OUT_Z_H -> OUT_X_L address wrap while a FIFO is enabled.
+	- Data-ready, watermark, and overrun signals on DRDY_G, INT1_XM, and
+	  INT2_XM, read back with digitalRead().
+
+The simulated board turns slowly about its z-axis: the gyro reports that
+rate (plus a fixed bias and noise), the magnetometer sees a fixed field
+turning with it, and the accelerometer sees 1 g on z plus a small 120 Hz
+vibration on x.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __SFE_LSM9DS0_SIM_H__
+#define __SFE_LSM9DS0_SIM_H__
+
+#include "SFE_LSM9DS0_HostBus.h"
+
+class LSM9DS0Sim : public LSM9DS0HostBus
+{
+public:
+	// LSM9DS0Sim -- Constructor.
+	// Input:
+	//	- gAddr, xmAddr = I2C addresses of the gyro and accel/mag.
+	LSM9DS0Sim(uint8_t gAddr = 0x6B, uint8_t xmAddr = 0x1D);
+
+	// setChipSelects() -- SPI chip-select pins of the gyro and accel/mag.
+	void setChipSelects(uint8_t csG, uint8_t csXM);
+
+	// setInterruptPins() -- Pins digitalRead() sees DRDY_G, INT1_XM, and
+	// INT2_XM on. 0xFF leaves a line unconnected.
+	void setInterruptPins(uint8_t drdyG, uint8_t int1XM, uint8_t int2XM);
+
+	// Bus traffic counters, for benchmarks and tests.
+	uint32_t transactions;	// I2C transactions or SPI chip selects
+	uint32_t bytes;			// Bytes transferred, including addresses and
+							// sub-addresses
+	uint32_t payload;		// Register data bytes only
+	uint32_t spiClock;		// Last SCK frequency requested, in Hz
+	uint32_t i2cClock;		// Last SCL frequency requested, in Hz
+	// Fault injection: NACK every faultEvery-th I2C transaction (0: never).
+	uint32_t faultEvery;
+
+	virtual uint8_t i2cTransfer(uint8_t address, const uint8_t * wr,
+								uint8_t wrLen, uint8_t * rd, uint8_t rdLen);
+	virtual uint8_t spiTransfer(uint8_t out);
+	virtual void setI2CClock(uint32_t hz) { i2cClock = hz; }
+	virtual void setSPIClock(uint32_t hz) { spiClock = hz; }
+	virtual void pinWrite(uint8_t pin, uint8_t value);
+	virtual int pinRead(uint8_t pin);
+
+private:
+	// One 3-axis sensor's data path: latest sample and a 32-level FIFO.
+	struct Sensor
+	{
+		int16_t latest[3];
+		int16_t fifo[32][3];
+		uint8_t head, count;
+		bool overrun;
+		bool newData;		// ZYXDA
+		bool dataOverrun;	// ZYXOR
+		uint64_t next;		// Time of the next sample, in microseconds
+	};
+
+	// One die (gyro, or accel/mag) on the bus.
+	struct Chip
+	{
+		uint8_t reg[64];
+		uint8_t ptr;		// Current register address
+	};
+
+	void reset(uint8_t chip);
+	void update();
+	void generate(uint8_t sensor, double t, int16_t * out);
+	void push(uint8_t sensor, const int16_t * sample);
+	bool fifoActive(uint8_t sensor);
+	uint8_t fifoSource(uint8_t sensor);
+	uint8_t readReg(uint8_t chip);
+	void advance(uint8_t chip);
+	void writeReg(uint8_t chip, uint8_t value);
+	void rescheduleAll();
+	float noise(float sigma);
+
+	uint8_t gAddress, xmAddress;
+	uint8_t csG, csXM;
+	uint8_t pinDrdyG, pinInt1XM, pinInt2XM;
+	Chip chips[2];			// CHIP_G, CHIP_XM
+	Sensor sensors[3];		// SENSOR_G, SENSOR_A, SENSOR_M
+	int8_t spiChip;			// Selected chip, or -1
+	uint8_t spiCount;		// Bytes exchanged since chip select
+	bool spiRead, spiIncrement;
+	uint32_t rng;
+	uint32_t faultCount;	// I2C transactions seen, for faultEvery
+};
+
+#endif // __SFE_LSM9DS0_SIM_H__ //
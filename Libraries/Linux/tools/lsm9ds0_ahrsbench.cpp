@@ -0,0 +1,202 @@
+/******************************************************************************
+lsm9ds0_ahrsbench.cpp
+Compares the cost per update of the orientation filters on replayed data
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_ahrsbench [--replay FILE | --seconds S] [--passes N]
+
+Without --replay, records S seconds (5 by default) of a simulated LSM9DS0
+with the gyro at 760 Hz, the accel at 200 Hz, and the mag at 100 Hz. With
+--replay, reads lines in lsm9ds0_cat's format instead ("-" is stdin):
+
+	time(s) G|A|M x y z		(DPS, g's, Gs)
+
+Every gyro sample becomes one update, with the latest accel and mag. The
+whole recording is run through LSM9DS0Madgwick, LSM9DS0Mahony, and
+LSM9DS0ESKF (without and with the accel bias) --passes times (20 by
+default), each from its initial state, and for each it prints the mean
+time per update, the updates per second that is, and the final yaw, pitch,
+and roll. Last, the gyro bias the ESKF found; the simulator's is 0.8, -0.5,
+0.3 DPS.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AHRS.h>
+#include "SFE_LSM9DS0_Sim.h"
+#include "lsm9ds0_replay.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define DRAIN_US	20000
+
+static void usage()
+{
+	fprintf(stderr, "usage: lsm9ds0_ahrsbench [--replay FILE | --seconds S] [--passes N]\n");
+}
+
+// record() -- Drain a simulated device for a while, timing each sample
+// from its frame's timestamp and the ODR.
+static void record(unsigned long seconds, std::vector<Sample> & out)
+{
+	LSM9DS0Sim sim;
+	setHostBus(&sim);
+	LSM9DS0 dof(MODE_I2C, 0x6B, 0x1D);
+	dof.begin(LSM9DS0::G_SCALE_245DPS, LSM9DS0::A_SCALE_2G, LSM9DS0::M_SCALE_2GS,
+			  LSM9DS0::G_ODR_760_BW_100, LSM9DS0::A_ODR_200, LSM9DS0::M_ODR_100);
+	dof.setGyroFIFO(LSM9DS0::FIFO_STREAM);
+	dof.setAccelFIFO(LSM9DS0::FIFO_STREAM);
+
+	static LSM9DS0_frame frame;
+	dof.initFrame(frame);
+	dof.readFrame(frame); // Start from empty FIFOs
+	unsigned long start = millis();
+	while (millis() - start < seconds * 1000)
+	{
+		delayMicroseconds(DRAIN_US);
+		dof.readFrame(frame);
+		const LSM9DS0_frame_header & h = frame.header;
+		double t = h.timestamp / 1e6;
+		const struct
+		{
+			char sensor;
+			uint8_t count, later;
+			float odr, res;
+			const int16_t * axis[3];
+			int stride;
+		} sensors[3] = {
+			{'G', h.gCount, h.gLater, h.gOdr, h.gRes,
+			 {frame.g[0], frame.g[1], frame.g[2]}, LSM9DS0_FRAME_SAMPLES},
+			{'A', h.aCount, h.aLater, h.aOdr, h.aRes,
+			 {frame.a[0], frame.a[1], frame.a[2]}, LSM9DS0_FRAME_SAMPLES},
+			{'M', h.mCount, 0, h.mOdr, h.mRes,
+			 {frame.m[0], frame.m[1], frame.m[2]}, LSM9DS0_FRAME_MAG_SAMPLES},
+		};
+		for (int s = 0; s < 3; s++)
+			for (uint8_t i = 0; i < sensors[s].count && i < sensors[s].stride; i++)
+			{
+				Sample sample;
+				sample.t = t - (sensors[s].count - 1 - i + sensors[s].later) /
+						   sensors[s].odr;
+				sample.sensor = sensors[s].sensor;
+				for (int axis = 0; axis < 3; axis++)
+					sample.v[axis] = sensors[s].axis[axis][i] * sensors[s].res;
+				out.push_back(sample);
+			}
+	}
+	setHostBus(NULL);
+	std::stable_sort(out.begin(), out.end());
+}
+
+static double nowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// run() -- Time passes runs of filter F over the updates, each from a fresh
+// filter, and print the result of the last.
+template <class F>
+static void run(const char * name, const F & initial,
+				const std::vector<Update> & updates, int passes, F & last)
+{
+	double ns = 0;
+	for (int p = 0; p < passes; p++)
+	{
+		last = initial;
+		double start = nowNs();
+		for (size_t i = 0; i < updates.size(); i++)
+		{
+			const Update & u = updates[i];
+			last.update(u.a[0], u.a[1], u.a[2], u.g[0], u.g[1], u.g[2],
+						u.m[0], u.m[1], u.m[2], u.dt);
+		}
+		ns += nowNs() - start;
+	}
+	double perUpdate = ns / ((double) passes * updates.size());
+	float yaw, pitch, roll;
+	last.getEuler(yaw, pitch, roll);
+	printf("%-14s %10.1f %12.0f %8.2f %8.2f %8.2f\n", name, perUpdate,
+		   1e9 / perUpdate, yaw, pitch, roll);
+}
+
+int main(int argc, char ** argv)
+{
+	const char * replay = NULL;
+	unsigned long seconds = 5;
+	int passes = 20;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--replay"))
+			replay = val;
+		else if (!strcmp(arg, "--seconds"))
+			seconds = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--passes"))
+			passes = atoi(val);
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+	if (passes < 1)
+		passes = 1;
+
+	std::vector<Sample> samples;
+	if (replay && !load(replay, samples))
+	{
+		perror(replay);
+		return 1;
+	}
+	if (!replay)
+		record(seconds, samples);
+	std::vector<Update> updates;
+	toUpdates(samples, updates);
+	if (updates.empty())
+	{
+		fprintf(stderr, "lsm9ds0_ahrsbench: no gyro samples with an accel and mag\n");
+		return 1;
+	}
+	double span = 0;
+	for (size_t i = 0; i < updates.size(); i++)
+		span += updates[i].dt;
+	printf("%lu updates over %.2f s (%.0f Hz), %d passes\n",
+		   (unsigned long) updates.size(), span, updates.size() / span, passes);
+
+	printf("%-14s %10s %12s %8s %8s %8s\n", "filter", "ns/update", "updates/s",
+		   "yaw", "pitch", "roll");
+	LSM9DS0Madgwick madgwick;
+	run("madgwick", LSM9DS0Madgwick(), updates, passes, madgwick);
+	LSM9DS0Mahony mahony;
+	run("mahony", LSM9DS0Mahony(), updates, passes, mahony);
+	LSM9DS0ESKF eskf;
+	run("eskf", LSM9DS0ESKF(), updates, passes, eskf);
+	LSM9DS0ESKF eskfAccel(true);
+	run("eskf+abias", LSM9DS0ESKF(true), updates, passes, eskfAccel);
+
+	printf("eskf gyro bias (DPS): %.3f %.3f %.3f  +/- %.3f %.3f %.3f\n",
+		   eskf.gBias[0] * 180 / PI, eskf.gBias[1] * 180 / PI,
+		   eskf.gBias[2] * 180 / PI, sqrt(eskf.variance(3)) * 180 / PI,
+		   sqrt(eskf.variance(4)) * 180 / PI, sqrt(eskf.variance(5)) * 180 / PI);
+	printf("eskf+abias accel bias (g): %.4f %.4f %.4f\n", eskfAccel.aBias[0],
+		   eskfAccel.aBias[1], eskfAccel.aBias[2]);
+	return 0;
+}
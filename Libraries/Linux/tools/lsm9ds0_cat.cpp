@@ -0,0 +1,150 @@
+/******************************************************************************
+lsm9ds0_cat.cpp
+Example lsm9ds0d consumer: prints the samples it publishes
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_cat [--shm /lsm9ds0] [--raw] [--count N] [--frames]
+
+Prints one line per sample: time (s), sensor (G, A, or M), and x, y, z in
+DPS, g's, or Gs (raw ticks with --raw). Run as many as you like at once;
+each one reads the ring independently.
+
+With --frames, it reads the frame ring instead, in place, and prints one
+line per frame: time, sequence, sample counts, and the mean of each gyro
+and accel axis over the frame.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "SFE_LSM9DS0_Shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// catFrames() -- The --frames loop: use each frame where it lies, and only
+// print what was computed if the frame wasn't overwritten meanwhile.
+static int catFrames(const char * name, unsigned long count)
+{
+	LSM9DS0ShmFrameReader frames;
+	if (!frames.open(name))
+	{
+		fprintf(stderr, "lsm9ds0_cat: can't open %s; is lsm9ds0d running?\n", name);
+		return 1;
+	}
+	unsigned long printed = 0;
+	uint64_t torn = 0;
+	while (!count || printed < count)
+	{
+		if (!frames.wait(2000))
+		{
+			fprintf(stderr, "lsm9ds0_cat: no frames for 2 s\n");
+			continue;
+		}
+		for (const LSM9DS0_frame * f; (!count || printed < count) &&
+			 (f = frames.next()) != NULL; )
+		{
+			uint32_t gen = getLSM9DS0FrameGeneration(*f);
+			const LSM9DS0_frame_header & h = f->header;
+			float mean[6] = {0, 0, 0, 0, 0, 0};
+			uint8_t gCount = h.gCount, aCount = h.aCount;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				for (uint8_t i = 0; i < gCount && i < LSM9DS0_FRAME_SAMPLES; i++)
+					mean[axis] += f->g[axis][i];
+				for (uint8_t i = 0; i < aCount && i < LSM9DS0_FRAME_SAMPLES; i++)
+					mean[3 + axis] += f->a[axis][i];
+				mean[axis] *= gCount ? h.gRes / gCount : 0;
+				mean[3 + axis] *= aCount ? h.aRes / aCount : 0;
+			}
+			double t = h.timestamp / 1e6;
+			uint32_t seq = h.sequence;
+			uint8_t mCount = h.mCount;
+			if (!checkLSM9DS0FrameGeneration(*f, gen))
+			{
+				torn++;
+				continue;
+			}
+			printf("%.6f #%u G%u A%u M%u  %8.3f %8.3f %8.3f  %7.4f %7.4f %7.4f\n",
+				   t, seq, gCount, aCount, mCount, mean[0], mean[1], mean[2],
+				   mean[3], mean[4], mean[5]);
+			printed++;
+		}
+		fflush(stdout);
+	}
+	if (frames.dropped() || torn)
+		fprintf(stderr, "lsm9ds0_cat: %llu frames dropped, %llu overwritten while read\n",
+				(unsigned long long) frames.dropped(), (unsigned long long) torn);
+	return 0;
+}
+
+int main(int argc, char ** argv)
+{
+	const char * shmName = LSM9DS0_SHM_NAME;
+	bool raw = false, useFrames = false;
+	unsigned long count = 0; // 0: forever
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--raw"))
+			raw = true;
+		else if (!strcmp(argv[i], "--frames"))
+			useFrames = true;
+		else if (!strcmp(argv[i], "--shm") && i + 1 < argc)
+			shmName = argv[++i];
+		else if (!strcmp(argv[i], "--count") && i + 1 < argc)
+			count = strtoul(argv[++i], NULL, 0);
+		else
+		{
+			fprintf(stderr, "usage: lsm9ds0_cat [--shm NAME] [--raw] [--count N] [--frames]\n");
+			return 2;
+		}
+	}
+	if (useFrames)
+	{
+		char framesName[256];
+		snprintf(framesName, sizeof(framesName), "%s.frames", shmName);
+		return catFrames(framesName, count);
+	}
+
+	LSM9DS0ShmReader ring;
+	if (!ring.open(shmName))
+	{
+		fprintf(stderr, "lsm9ds0_cat: can't open %s; is lsm9ds0d running?\n", shmName);
+		return 1;
+	}
+
+	static const char sensorName[3] = {'G', 'A', 'M'};
+	LSM9DS0ShmSample buf[64];
+	unsigned long printed = 0;
+	uint64_t lastDropped = 0;
+	while (!count || printed < count)
+	{
+		if (!ring.wait(2000))
+		{
+			fprintf(stderr, "lsm9ds0_cat: no data for 2 s\n");
+			continue;
+		}
+		uint32_t n;
+		while ((n = ring.read(buf, 64)) > 0)
+		{
+			for (uint32_t i = 0; i < n && (!count || printed < count); i++, printed++)
+			{
+				const LSM9DS0ShmSample & s = buf[i];
+				float k = raw ? 1 : ring.scale(s.sensor);
+				printf("%.6f %c %9.4f %9.4f %9.4f\n", s.timestamp / 1e9,
+					   s.sensor < 3 ? sensorName[s.sensor] : '?',
+					   s.data[0] * k, s.data[1] * k, s.data[2] * k);
+			}
+		}
+		if (ring.dropped() != lastDropped)
+		{
+			fprintf(stderr, "lsm9ds0_cat: %llu samples dropped\n",
+					(unsigned long long) (ring.dropped() - lastDropped));
+			lastDropped = ring.dropped();
+		}
+		fflush(stdout);
+	}
+	return 0;
+}
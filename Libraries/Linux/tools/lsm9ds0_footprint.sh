@@ -0,0 +1,74 @@
+#!/bin/sh
+###############################################################################
+# lsm9ds0_footprint.sh
+# Reports what each SFE_LSM9DS0_Config.h feature costs in flash and RAM
+# https://github.com/sparkfun/LSM9DS0_Breakout
+#
+# Usage (normally through `make footprint`):
+#	CXX=g++ SIZE=size CPPFLAGS=... FOOTPRINT_FLAGS=-Os sh lsm9ds0_footprint.sh
+#
+# Compiles SFE_LSM9DS0.cpp once with everything in, once with each feature
+# out, and once with everything that can go out, and prints per build:
+#
+#	text	Code and constants (flash)
+#	data	Initialized statics (flash, and copied to RAM)
+#	bss	Zeroed statics (RAM)
+#	object	sizeof(LSM9DS0): the RAM each instance takes
+#
+# with each column's change from the full build. The object size comes from
+# the bss of a probe file holding one char[sizeof(LSM9DS0)], so it works
+# with cross compilers too, e.g. for an Uno:
+#
+#	make footprint CXX=avr-g++ SIZE=avr-size \
+#		FOOTPRINT_FLAGS="-Os -mmcu=atmega328p -DF_CPU=16000000L" \
+#		CPPFLAGS="-DARDUINO=10800 -I<core> -I<variant> -I<Wire> -I<SPI> -I../Arduino/src"
+#
+# Distributed as-is; no warranty is given.
+###############################################################################
+
+CXX=${CXX:-g++}
+SIZE=${SIZE:-size}
+SRC=${SRC:-../Arduino/src}
+FOOTPRINT_FLAGS=${FOOTPRINT_FLAGS:--Os}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+printf '#include "SFE_LSM9DS0.h"\nchar lsm9ds0_object[sizeof(LSM9DS0)];\n' > "$TMP/probe.cpp"
+
+# measure NAME DEFINES -- Prints one row; the first call is the baseline.
+measure()
+{
+	name=$1
+	shift
+	for f in "$SRC/SFE_LSM9DS0.cpp" "$TMP/probe.cpp"; do
+		if ! $CXX -std=gnu++11 $CPPFLAGS $FOOTPRINT_FLAGS "$@" \
+				-c "$f" -o "$TMP/$(basename "$f" .cpp).o"; then
+			echo "$name: doesn't compile" >&2
+			return 1
+		fi
+	done
+	set -- $($SIZE "$TMP/SFE_LSM9DS0.o" | awk 'NR == 2 { print $1, $2, $3 }') \
+		   $($SIZE "$TMP/probe.o" | awk 'NR == 2 { print $3 }')
+	if [ -z "$base" ]; then
+		base="$1 $2 $3 $4"
+		printf '%-10s %12s %12s %12s %12s\n' build text data bss object
+	fi
+	echo "$name $1 $2 $3 $4 $base" | awk '{
+		printf "%-10s", $1
+		for (i = 2; i <= 5; i++)
+			printf " %12s", ($1 == "all") ? $i : sprintf("%d(%+d)", $i, $i - $(i + 4))
+		printf "\n"
+	}'
+}
+
+base=
+measure all || exit 1
+measure -i2c	-DLSM9DS0_USE_I2C=0
+measure -spi	-DLSM9DS0_USE_SPI=0
+measure -float	-DLSM9DS0_USE_FLOAT=0 -DLSM9DS0_USE_CAL=0
+measure -cal	-DLSM9DS0_USE_CAL=0
+measure -temp	-DLSM9DS0_USE_TEMP=0
+measure -frame	-DLSM9DS0_USE_FRAME=0
+measure +stats	-DLSM9DS0_STATS=1
+measure minimal	-DLSM9DS0_USE_SPI=0 -DLSM9DS0_USE_FLOAT=0 -DLSM9DS0_USE_CAL=0 \
+				-DLSM9DS0_USE_TEMP=0 -DLSM9DS0_USE_FRAME=0
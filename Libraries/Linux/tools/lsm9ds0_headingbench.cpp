@@ -0,0 +1,231 @@
+/******************************************************************************
+lsm9ds0_headingbench.cpp
+Checks the error and cost of the fast heading functions against libm
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_headingbench [--poses N] [--passes N]
+
+Builds N random poses (100000 by default): a heading, a pitch within 85
+degrees of level, and a roll, with the accel and mag readings a board in
+that pose would give (1 g and a 0.5 Gs field, dipping 60 degrees, as raw
+ticks at 2 g and 2 Gs, plus a few ticks of noise). Then, for each way of
+working out the attitude:
+
+	libm		The same formulas with atan2() and sqrt() in double
+	float		LSM9DS0Heading::attitude(), on floats in g's and Gs
+	fixed		LSM9DS0Heading::attitude(), on the raw ticks
+
+it prints the time per call over --passes (20 by default) runs through
+the poses, and the worst heading, pitch, and roll error against libm.
+Last, the worst error of fastAtan2(), fastAsin(), and fixedAtan2() alone,
+over a sweep of their inputs.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0_Heading.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define G_TICKS		16384.0		// 1 g at 2 g full scale
+#define GS_TICKS	16384.0		// 1 Gs at 2 Gs full scale
+
+static void usage()
+{
+	fprintf(stderr, "usage: lsm9ds0_headingbench [--poses N] [--passes N]\n");
+}
+
+// Pose -- A true attitude and the readings it gives, in ticks.
+struct Pose
+{
+	double heading, pitch, roll;	// Degrees
+	int16_t a[3], m[3];
+};
+
+static double uniform(double lo, double hi)
+{
+	return lo + (hi - lo) * (rand() / (double) RAND_MAX);
+}
+
+static int16_t ticks(double v)
+{
+	return (int16_t) lround(v + uniform(-2, 2));
+}
+
+// makePose() -- Readings for a board, x forward and z up, at a heading,
+// pitch, and roll. In NED, the specific force is (0, 0, -g) and the field
+// (cos(dip), 0, sin(dip)); turn both into the body's NED axes (x forward,
+// y right, z down), then flip y and z.
+static void makePose(Pose & p)
+{
+	p.heading = uniform(0, 360);
+	p.pitch = uniform(-85, 85);
+	p.roll = uniform(-180, 180);
+	double psi = p.heading * PI / 180, theta = p.pitch * PI / 180;
+	double phi = p.roll * PI / 180;
+	double cps = cos(psi), sps = sin(psi), ct = cos(theta), st = sin(theta);
+	double cph = cos(phi), sph = sin(phi);
+	// Body-to-NED rotation Rz(psi) Ry(theta) Rx(phi); body = R^T NED.
+	double R[3][3] = {
+		{ct * cps, sph * st * cps - cph * sps, cph * st * cps + sph * sps},
+		{ct * sps, sph * st * sps + cph * cps, cph * st * sps - sph * cps},
+		{-st, sph * ct, cph * ct}};
+	double f[3] = {0, 0, -1}, dip = 60 * PI / 180;
+	double b[3] = {0.5 * cos(dip), 0, 0.5 * sin(dip)};
+	for (int i = 0; i < 3; i++)
+	{
+		double fb = R[0][i] * f[0] + R[1][i] * f[1] + R[2][i] * f[2];
+		double bb = R[0][i] * b[0] + R[1][i] * b[1] + R[2][i] * b[2];
+		double sign = i ? -1 : 1;
+		p.a[i] = ticks(sign * fb * G_TICKS);
+		p.m[i] = ticks(sign * bb * GS_TICKS);
+	}
+}
+
+// reference() -- The formulas in SFE_LSM9DS0_Heading.cpp, in double.
+static void reference(const int16_t * a, const int16_t * m, double * out)
+{
+	double ax = a[0], ay = a[1], az = a[2], mx = m[0], my = m[1], mz = m[2];
+	double phi = atan2(ay, az), theta = atan2(ax, sqrt(ay * ay + az * az));
+	double psi = atan2(my * cos(phi) - mz * sin(phi),
+					   mx * cos(theta) - (my * sin(phi) + mz * cos(phi)) * sin(theta));
+	out[0] = psi * 180 / PI;
+	if (out[0] < 0)
+		out[0] += 360;
+	out[1] = theta * 180 / PI;
+	out[2] = phi * 180 / PI;
+}
+
+// angleError() -- |a - b| in degrees, the short way around.
+static double angleError(double a, double b)
+{
+	double d = fmod(fabs(a - b), 360);
+	return (d > 180) ? 360 - d : d;
+}
+
+static double nowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile float sink; // Keeps the timed calls from being optimized out
+
+int main(int argc, char ** argv)
+{
+	unsigned long poses = 100000;
+	int passes = 20;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--poses"))
+			poses = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--passes"))
+			passes = atoi(val);
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+	if (passes < 1)
+		passes = 1;
+	if (poses < 1)
+		poses = 1;
+
+	srand(1);
+	std::vector<Pose> set(poses);
+	std::vector<double> expect(3 * poses);
+	for (unsigned long i = 0; i < poses; i++)
+	{
+		makePose(set[i]);
+		reference(set[i].a, set[i].m, &expect[3 * i]);
+	}
+
+	printf("%lu poses, %d passes\n", poses, passes);
+	printf("%-8s %10s %12s %12s %12s\n", "method", "ns/call", "heading err",
+		   "pitch err", "roll err");
+	for (int method = 0; method < 3; method++)
+	{
+		double err[3] = {0, 0, 0};
+		double start = nowNs();
+		for (int pass = 0; pass < passes; pass++)
+			for (unsigned long i = 0; i < poses; i++)
+			{
+				const Pose & p = set[i];
+				double got[3];
+				if (method == 0)
+					reference(p.a, p.m, got);
+				else if (method == 1)
+				{
+					LSM9DS0_attitude att;
+					LSM9DS0Heading::attitude(p.a[0] / G_TICKS, p.a[1] / G_TICKS,
+											 p.a[2] / G_TICKS, p.m[0] / GS_TICKS,
+											 p.m[1] / GS_TICKS, p.m[2] / GS_TICKS, att);
+					got[0] = att.heading;
+					got[1] = att.pitch;
+					got[2] = att.roll;
+				}
+				else
+				{
+					LSM9DS0_attitude_cd att;
+					LSM9DS0Heading::attitude(p.a[0], p.a[1], p.a[2], p.m[0],
+											 p.m[1], p.m[2], att);
+					got[0] = att.heading / 100.0;
+					got[1] = att.pitch / 100.0;
+					got[2] = att.roll / 100.0;
+				}
+				sink = got[0];
+				if (pass)
+					continue;
+				for (int k = 0; k < 3; k++)
+				{
+					double e = angleError(got[k], expect[3 * i + k]);
+					if (e > err[k])
+						err[k] = e;
+				}
+			}
+		double ns = (nowNs() - start) / ((double) passes * poses);
+		static const char * names[3] = {"libm", "float", "fixed"};
+		printf("%-8s %10.1f %12.5f %12.5f %12.5f\n", names[method], ns, err[0],
+			   err[1], err[2]);
+	}
+
+	// The primitives alone, over a fine sweep (in steps that don't line up
+	// with hundredths of a degree).
+	double atanErr = 0, asinErr = 0, fixedErr = 0;
+	for (int i = 0; i <= 100000; i++)
+	{
+		double angle = i * 0.0036 * PI / 180;
+		float y = sin(angle), x = cos(angle);
+		atanErr = fmax(atanErr, angleError(LSM9DS0Heading::fastAtan2(y, x),
+										   atan2((double) y, (double) x) * 180 / PI));
+		int32_t yi = lround(y * 1e6), xi = lround(x * 1e6);
+		fixedErr = fmax(fixedErr, angleError(LSM9DS0Heading::fixedAtan2(yi, xi) / 100.0,
+											 atan2((double) yi, (double) xi) * 180 / PI));
+	}
+	for (int i = -10000; i <= 10000; i++)
+	{
+		float x = i / 10000.0f;
+		asinErr = fmax(asinErr, fabs(LSM9DS0Heading::fastAsin(x) -
+									 asin((double) x) * 180 / PI));
+	}
+	printf("fastAtan2 err %.5f, fastAsin err %.5f, fixedAtan2 err %.5f (degrees)\n",
+		   atanErr, asinErr, fixedErr);
+	return 0;
+}
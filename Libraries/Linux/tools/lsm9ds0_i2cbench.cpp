@@ -0,0 +1,143 @@
+/******************************************************************************
+lsm9ds0_i2cbench.cpp
+Reports I2C per-transaction overhead and samples/sec versus I2C clock
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_i2cbench [--clocks HZ,HZ,...] [--ms MS] [--drain US] [--sw NS]
+
+For each clock, runs the driver over I2C against a simulated LSM9DS0 with
+the gyro at 760 Hz, the accel at 1600 Hz, and the mag at 100 Hz, draining
+both FIFOs with readFrame() every --drain microseconds for --ms
+milliseconds. The simulator counts transactions, bytes on the wire, and
+register data bytes; the time they would take on a real bus is modeled as
+
+	(bytes * 9 + transactions * 3) / clock + transactions * sw
+
+Each byte is 9 bits with its acknowledge; start, repeated start, and stop
+add about 3 bit times per transaction. --sw is the software cost of one
+transaction (Wire's interrupt handling, or an ioctl() on Linux), 0 by
+default; measure yours and pass it.
+
+Per clock, it prints the clock the driver asked for, transactions and
+data bytes per sample, the fixed cost of one transaction (everything but
+its data), the share of bus time that carries data, the samples/sec the
+bus could carry, and how busy these ODRs keep it. Above 100%, the bus
+can't keep up and the FIFOs will overrun.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include "SFE_LSM9DS0_Sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CLOCKS	16
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: lsm9ds0_i2cbench [--clocks HZ,HZ,...] [--ms MS] [--drain US]\n"
+		"                        [--sw NS]\n");
+}
+
+int main(int argc, char ** argv)
+{
+	uint32_t clocks[MAX_CLOCKS] = {LSM9DS0_I2C_STANDARD, LSM9DS0_I2C_FAST,
+								   LSM9DS0_I2C_FAST_PLUS};
+	int clockCount = 3;
+	unsigned long ms = 500, drainUs = 5000;
+	double swNs = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--clocks"))
+		{
+			char * end = (char *) val;
+			clockCount = 0;
+			while (*end && clockCount < MAX_CLOCKS)
+			{
+				clocks[clockCount++] = strtoul(end, &end, 0);
+				if (*end == ',')
+					end++;
+			}
+		}
+		else if (!strcmp(arg, "--ms"))
+			ms = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--drain"))
+			drainUs = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--sw"))
+			swNs = atof(val);
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	printf("%10s %10s %8s %8s %10s %8s %10s %14s %8s\n", "clock Hz", "applied Hz",
+		   "txn/smp", "B/smp", "us/txn", "data %", "us/sample", "max samples/s",
+		   "busy %");
+	for (int c = 0; c < clockCount; c++)
+	{
+		LSM9DS0Sim sim;
+		setHostBus(&sim);
+
+		LSM9DS0 dof(MODE_I2C, 0x6B, 0x1D);
+		uint16_t whoAmI = dof.begin(LSM9DS0::G_SCALE_245DPS, LSM9DS0::A_SCALE_2G,
+									LSM9DS0::M_SCALE_2GS, LSM9DS0::G_ODR_760_BW_100,
+									LSM9DS0::A_ODR_1600, LSM9DS0::M_ODR_100);
+		if (whoAmI != LSM9DS0_WHO_AM_I)
+		{
+			fprintf(stderr, "lsm9ds0_i2cbench: bad WHO_AM_I 0x%04X\n", whoAmI);
+			return 1;
+		}
+		dof.setI2CClock(clocks[c]);
+		dof.setGyroFIFO(LSM9DS0::FIFO_STREAM);
+		dof.setAccelFIFO(LSM9DS0::FIFO_STREAM);
+
+		static LSM9DS0_frame frame;
+		dof.initFrame(frame);
+		dof.readFrame(frame); // Start from empty FIFOs
+		sim.transactions = sim.bytes = sim.payload = 0;
+
+		unsigned long samples = 0;
+		unsigned long start = micros();
+		while (micros() - start < ms * 1000)
+		{
+			delayMicroseconds(drainUs);
+			dof.readFrame(frame);
+			samples += frame.header.gCount + frame.header.aCount +
+					   frame.header.mCount;
+		}
+		double elapsedNs = (micros() - start) * 1e3;
+		setHostBus(NULL);
+
+		double clock = sim.i2cClock ? sim.i2cClock : clocks[c];
+		double bitNs = 1e9 / clock;
+		double dataNs = sim.payload * 9 * bitNs;
+		double busNs = (sim.bytes * 9.0 + sim.transactions * 3.0) * bitNs +
+					   sim.transactions * swNs;
+		double perTxn = sim.transactions ? (busNs - dataNs) / sim.transactions : 0;
+		double perSample = samples ? busNs / samples : 0;
+		printf("%10lu %10u %8.2f %8.2f %10.2f %8.1f %10.2f %14.0f %8.1f\n",
+			   (unsigned long) clocks[c], sim.i2cClock,
+			   samples ? (double) sim.transactions / samples : 0,
+			   samples ? (double) sim.payload / samples : 0,
+			   perTxn / 1e3, busNs ? 100 * dataNs / busNs : 0,
+			   perSample / 1e3, perSample ? 1e9 / perSample : 0,
+			   100 * busNs / elapsedNs);
+	}
+	return 0;
+}
@@ -0,0 +1,201 @@
+/******************************************************************************
+lsm9ds0_pipeline.cpp
+Runs LSM9DS0Pipeline on one or more devices and reports how it keeps up
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_pipeline [--i2c /dev/i2c-1 ... | --sim N] [--seconds S]
+					 [--drain US] [--block] [--cpus BUS,CONVERT,FUSE]
+					 [--idle US] [--align US] [--quiet]
+
+Every --i2c adds the device at the default addresses on that bus; --sim N
+adds N simulated devices, each on its own bus. Once a second, it prints
+each device's yaw, pitch, and roll; at the end, the pipeline's counters
+and per-stage latency histograms.
+
+--block makes both queues wait for room instead of dropping. --cpus pins
+the first bus thread, the conversion thread, and the fusion thread (further
+bus threads follow the first). --idle 0 makes idle stages spin. --align
+bounds how long a gyro sample waits for the accel and mag to catch up.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include "SFE_LSM9DS0_I2CDev.h"
+#include "SFE_LSM9DS0_Pipeline.h"
+#include "SFE_LSM9DS0_Sim.h"
+
+#include <mutex>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DEVICES		LSM9DS0_PIPELINE_DEVICES
+#define DRAIN_US		20000	// 4 samples at the accel's 200 Hz
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+	running = 0;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: lsm9ds0_pipeline [--i2c DEV ... | --sim N] [--seconds S]\n"
+		"                        [--drain US] [--block] [--cpus BUS,CONVERT,FUSE]\n"
+		"                        [--idle US] [--align US] [--quiet]\n");
+}
+
+// The latest attitude of each device, written by the fusion thread.
+struct Latest
+{
+	std::mutex lock;
+	LSM9DS0Attitude attitude[MAX_DEVICES];
+	bool valid[MAX_DEVICES];
+};
+
+static void onAttitude(void * context, const LSM9DS0Attitude & att)
+{
+	Latest * latest = (Latest *) context;
+	std::lock_guard<std::mutex> guard(latest->lock);
+	latest->attitude[att.device] = att;
+	latest->valid[att.device] = true;
+}
+
+int main(int argc, char ** argv)
+{
+	const char * i2cDevices[MAX_DEVICES];
+	int i2cCount = 0, simCount = 0;
+	unsigned long seconds = 10;
+	bool quiet = false;
+	LSM9DS0Pipeline::Config config;
+	config.drainUs = DRAIN_US;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!strcmp(arg, "--block"))
+		{
+			config.busPolicy = config.convertPolicy = LSM9DS0Pipeline::BLOCK;
+			continue;
+		}
+		if (!strcmp(arg, "--quiet"))
+		{
+			quiet = true;
+			continue;
+		}
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--i2c") && i2cCount < MAX_DEVICES)
+			i2cDevices[i2cCount++] = val;
+		else if (!strcmp(arg, "--sim"))
+			simCount = atoi(val);
+		else if (!strcmp(arg, "--seconds"))
+			seconds = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--drain"))
+			config.drainUs = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--idle"))
+			config.idleUs = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--align"))
+			config.alignUs = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--cpus") &&
+				 sscanf(val, "%d,%d,%d", &config.busCpu, &config.convertCpu,
+						&config.fuseCpu) == 3)
+			;
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+	if (simCount < 0 || simCount + i2cCount > MAX_DEVICES)
+	{
+		fprintf(stderr, "lsm9ds0_pipeline: at most %d devices\n", MAX_DEVICES);
+		return 2;
+	}
+	if (!simCount && !i2cCount)
+		simCount = 1;
+
+	static LSM9DS0Sim sims[MAX_DEVICES];
+	static LSM9DS0I2CDev i2cBuses[MAX_DEVICES];
+	LSM9DS0HostBus * buses[MAX_DEVICES];
+	int count = 0;
+	for (int i = 0; i < i2cCount; i++)
+	{
+		if (!i2cBuses[i].open(i2cDevices[i]))
+		{
+			perror(i2cDevices[i]);
+			return 1;
+		}
+		buses[count++] = &i2cBuses[i];
+	}
+	for (int i = 0; i < simCount; i++)
+		buses[count++] = &sims[i];
+
+	static LSM9DS0Pipeline pipe;
+	LSM9DS0 * dofs[MAX_DEVICES];
+	for (int d = 0; d < count; d++)
+	{
+		setHostBus(buses[d]);
+		dofs[d] = new LSM9DS0(MODE_I2C, 0x6B, 0x1D);
+		uint16_t whoAmI = dofs[d]->begin(LSM9DS0::G_SCALE_245DPS, LSM9DS0::A_SCALE_2G,
+										 LSM9DS0::M_SCALE_2GS, LSM9DS0::G_ODR_190_BW_50,
+										 LSM9DS0::A_ODR_200, LSM9DS0::M_ODR_50);
+		if (whoAmI != LSM9DS0_WHO_AM_I)
+		{
+			fprintf(stderr, "lsm9ds0_pipeline: no LSM9DS0 on device %d (WHO_AM_I 0x%04X)\n",
+					d, whoAmI);
+			return 1;
+		}
+		dofs[d]->setGyroFIFO(LSM9DS0::FIFO_STREAM);
+		dofs[d]->setAccelFIFO(LSM9DS0::FIFO_STREAM);
+		pipe.addDevice(*dofs[d], *buses[d]);
+	}
+	setHostBus(NULL);
+
+	static Latest latest;
+	pipe.setOutput(onAttitude, &latest);
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = onSignal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	if (!pipe.start(config))
+	{
+		fprintf(stderr, "lsm9ds0_pipeline: can't start the pipeline\n");
+		return 1;
+	}
+	for (unsigned long s = 0; running && (!seconds || s < seconds); s++)
+	{
+		delay(1000);
+		if (quiet)
+			continue;
+		std::lock_guard<std::mutex> guard(latest.lock);
+		for (int d = 0; d < count; d++)
+		{
+			if (!latest.valid[d])
+				continue;
+			const LSM9DS0Attitude & att = latest.attitude[d];
+			float yaw, pitch, roll;
+			quaternionToEuler(att.q, yaw, pitch, roll);
+			printf("%.3f dev %d #%u  yaw %7.2f  pitch %7.2f  roll %7.2f  latency %.1f us\n",
+				   att.timestamp / 1e6, d, att.sequence, yaw, pitch, roll,
+				   att.latencyNs / 1e3);
+		}
+		fflush(stdout);
+	}
+	pipe.stop();
+	pipe.printStats(stdout);
+	return 0;
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+lsm9ds0_replay.h
+Recordings and filter updates shared by the replaying tools
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+lsm9ds0_ahrsbench and lsm9ds0_sweep both read recordings in lsm9ds0_cat's
+format ("-" is stdin):
+
+	time(s) G|A|M x y z		(DPS, g's, Gs)
+
+lsm9ds0_sweep's may also hold reference orientations, as quaternions:
+
+	time(s) Q w x y z
+
+and both turn them into the same filter updates: one per gyro sample, with
+the latest accel and mag.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+#ifndef __LSM9DS0_REPLAY_H__
+#define __LSM9DS0_REPLAY_H__
+
+#include <SFE_LSM9DS0.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Sample -- One line of a recording.
+struct Sample
+{
+	double t;
+	char sensor;	// G, A, M, or Q
+	float v[4];		// x, y, z; or w, x, y, z
+
+	bool operator<(const Sample & other) const { return t < other.t; }
+};
+
+// Update -- One filter step: a gyro sample with the latest accel and mag.
+struct Update
+{
+	float dt;
+	float g[3];		// rad/s
+	float a[3];		// g's
+	float m[3];		// Gs
+};
+
+// load() -- Append a recording's samples to out, skipping lines that aren't
+// samples.
+// Output: false if path can't be opened.
+inline bool load(const char * path, std::vector<Sample> & out)
+{
+	FILE * in = strcmp(path, "-") ? fopen(path, "r") : stdin;
+	if (!in)
+		return false;
+	char line[256];
+	while (fgets(line, sizeof(line), in))
+	{
+		Sample s;
+		int n = sscanf(line, "%lf %c %f %f %f %f", &s.t, &s.sensor, &s.v[0],
+					   &s.v[1], &s.v[2], &s.v[3]);
+		if ((s.sensor == 'Q') ? n == 6 : n >= 5)
+			out.push_back(s);
+	}
+	if (in != stdin)
+		fclose(in);
+	return true;
+}
+
+// toUpdates() -- One update per gyro sample, once there's been an accel
+// and a mag sample. samples must be in time order.
+// Input:
+//	- bias = Gyro bias to take off every sample, in DPS, or NULL.
+//	- source = If not NULL, gets the index in samples of each update's gyro
+//		sample.
+inline void toUpdates(const std::vector<Sample> & samples, std::vector<Update> & out,
+					  const double * bias = NULL, std::vector<size_t> * source = NULL)
+{
+	float a[3], m[3];
+	bool haveA = false, haveM = false;
+	double lastG = -1;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const Sample & s = samples[i];
+		if (s.sensor == 'A')
+		{
+			memcpy(a, s.v, sizeof(a));
+			haveA = true;
+		}
+		else if (s.sensor == 'M')
+		{
+			memcpy(m, s.v, sizeof(m));
+			haveM = true;
+		}
+		else if (s.sensor == 'G')
+		{
+			double dt = s.t - lastG;
+			bool first = lastG < 0;
+			lastG = s.t;
+			if (first || !haveA || !haveM || dt <= 0 || dt > 0.1)
+				continue;
+			Update u;
+			u.dt = dt;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				u.g[axis] = (s.v[axis] - (bias ? bias[axis] : 0)) * PI / 180;
+				u.a[axis] = a[axis];
+				u.m[axis] = m[axis];
+			}
+			out.push_back(u);
+			if (source)
+				source->push_back(i);
+		}
+	}
+}
+
+#endif // __LSM9DS0_REPLAY_H__ //
@@ -0,0 +1,141 @@
+/******************************************************************************
+lsm9ds0_spibench.cpp
+Benchmarks the SPI backend: samples/sec versus SPI clock
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_spibench [--clocks HZ,HZ,...] [--ms MS] [--drain US]
+					 [--cs NS] [--gap NS]
+
+For each clock, runs the driver over SPI against a simulated LSM9DS0 with
+the gyro at 760 Hz, the accel at 1600 Hz, and the mag at 100 Hz, draining
+both FIFOs with readFrame() every --drain microseconds for --ms
+milliseconds. The simulator counts chip selects and bytes; the time they
+would take on a real bus is modeled as
+
+	bytes * (8 / clock + gap) + chip selects * cs
+
+where --cs is the fixed cost of one transaction (SPI.beginTransaction(),
+both chip select edges, SPI.endTransaction()) and --gap the dead time
+between bytes of a block transfer. The defaults (1000 ns and 0 ns) are
+rough figures for a 16 MHz AVR; pass your own.
+
+Per clock, it prints the clock the driver asked for, the traffic per
+sample, the modeled bus time per sample, the samples/sec the bus could
+carry at that rate, and how busy these ODRs keep it.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include "SFE_LSM9DS0_Sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CLOCKS	16
+#define CS_G		10
+#define CS_XM		9
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: lsm9ds0_spibench [--clocks HZ,HZ,...] [--ms MS] [--drain US]\n"
+		"                        [--cs NS] [--gap NS]\n");
+}
+
+int main(int argc, char ** argv)
+{
+	uint32_t clocks[MAX_CLOCKS] = {1000000, 2000000, 4000000, 5000000,
+								   8000000, 10000000};
+	int clockCount = 6;
+	unsigned long ms = 500, drainUs = 5000;
+	double csNs = 1000, gapNs = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--clocks"))
+		{
+			char * end = (char *) val;
+			clockCount = 0;
+			while (*end && clockCount < MAX_CLOCKS)
+			{
+				clocks[clockCount++] = strtoul(end, &end, 0);
+				if (*end == ',')
+					end++;
+			}
+		}
+		else if (!strcmp(arg, "--ms"))
+			ms = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--drain"))
+			drainUs = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--cs"))
+			csNs = atof(val);
+		else if (!strcmp(arg, "--gap"))
+			gapNs = atof(val);
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	printf("%10s %10s %8s %8s %10s %14s %8s\n", "clock Hz", "applied Hz",
+		   "CS/smp", "B/smp", "us/sample", "max samples/s", "busy %");
+	for (int c = 0; c < clockCount; c++)
+	{
+		LSM9DS0Sim sim;
+		sim.setChipSelects(CS_G, CS_XM);
+		setHostBus(&sim);
+
+		LSM9DS0 dof(MODE_SPI, CS_G, CS_XM);
+		dof.setSPIClock(clocks[c]);
+		uint16_t whoAmI = dof.begin(LSM9DS0::G_SCALE_245DPS, LSM9DS0::A_SCALE_2G,
+									LSM9DS0::M_SCALE_2GS, LSM9DS0::G_ODR_760_BW_100,
+									LSM9DS0::A_ODR_1600, LSM9DS0::M_ODR_100);
+		if (whoAmI != LSM9DS0_WHO_AM_I)
+		{
+			fprintf(stderr, "lsm9ds0_spibench: bad WHO_AM_I 0x%04X\n", whoAmI);
+			return 1;
+		}
+		dof.setGyroFIFO(LSM9DS0::FIFO_STREAM);
+		dof.setAccelFIFO(LSM9DS0::FIFO_STREAM);
+
+		static LSM9DS0_frame frame;
+		dof.initFrame(frame);
+		dof.readFrame(frame); // Start from empty FIFOs
+		sim.transactions = sim.bytes = 0;
+
+		unsigned long samples = 0;
+		unsigned long start = micros();
+		while (micros() - start < ms * 1000)
+		{
+			delayMicroseconds(drainUs);
+			dof.readFrame(frame);
+			samples += frame.header.gCount + frame.header.aCount +
+					   frame.header.mCount;
+		}
+		double elapsedNs = (micros() - start) * 1e3;
+		setHostBus(NULL);
+
+		double clock = sim.spiClock ? sim.spiClock : clocks[c];
+		double busNs = sim.bytes * (8e9 / clock + gapNs) + sim.transactions * csNs;
+		double perSample = samples ? busNs / samples : 0;
+		printf("%10lu %10u %8.2f %8.2f %10.2f %14.0f %8.1f\n",
+			   (unsigned long) clocks[c], sim.spiClock,
+			   samples ? (double) sim.transactions / samples : 0,
+			   samples ? (double) sim.bytes / samples : 0,
+			   perSample / 1e3, perSample ? 1e9 / perSample : 0,
+			   100 * busNs / elapsedNs);
+	}
+	return 0;
+}
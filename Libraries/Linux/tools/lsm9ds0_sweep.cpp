@@ -0,0 +1,743 @@
+/******************************************************************************
+lsm9ds0_sweep.cpp
+Replays captures through the orientation filters over a grid of gains
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+Usage:
+	lsm9ds0_sweep [--capture FILE]... [--synth N] [--seconds S] [--write PREFIX]
+				  [--beta LIST] [--zeta LIST] [--kp LIST] [--ki LIST]
+				  [--cal S] [--settle S] [--threads N] [--top N]
+
+Tuning beta and zeta (LSM9DS0Madgwick) or Kp and Ki (LSM9DS0Mahony) on the
+board means reflashing and re-recording for every guess. This runs every
+combination over a set of recordings instead, on every core, and ranks the
+combinations by orientation error.
+
+Each --capture is a recording in lsm9ds0_cat's format ("-" is stdin):
+
+	time(s) G|A|M x y z		(DPS, g's, Gs)
+
+optionally with reference orientations, e.g. from a motion capture rig, as
+quaternions in the filters' convention (sensor to an x-north, z-up frame):
+
+	time(s) Q w x y z
+
+Without --capture, --synth N (8 by default) captures of --seconds S (60 by
+default) are made up: a board at rest for 3 s, then turning about all three
+axes at up to 100 DPS and shaken by up to 0.15 g, with the gyro at 760 Hz
+(with a bias of up to 1 DPS), the accel at 200 Hz, the mag at 100 Hz, and
+the true orientation at 100 Hz. --write PREFIX saves them as PREFIX0.txt,
+PREFIX1.txt, ..., to replay later or elsewhere.
+
+Each capture is turned into one update per gyro sample, with the latest
+accel and mag; with --cal S, the mean gyro over its first S seconds is
+taken as the bias and removed first (as calLSM9DS0() does on the board).
+The error is the angle between the filter's quaternion and the reference,
+at each reference after the first --settle S seconds (5 by default). A
+capture without Q lines is scored against the orientation its accel and
+mag give (TRIAD), at the accel samples where the board is still.
+
+LIST is values and ranges, comma-separated: 0.1,0.2 or 0.05:0.5:0.05 (from
+0.05 to 0.5 in steps of 0.05). Every beta is run with every zeta, and
+every kp with every ki; an empty list (e.g. --kp "") skips that filter.
+
+Each (combination, capture) pair is one work item. --threads (by default,
+one per CPU this process may run on) threads, each pinned to its own CPU,
+take items from a shared counter until none are left, so they stay busy to
+the end; the captures are shared, read-only, and each item writes only its
+own result, once, when it's done.
+
+Per combination it prints the RMS and worst error and the filter's updates
+per second on one core (including the scoring, which runs only at
+references); last, the total rate, and how close to N times one thread's
+the threads got.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_AHRS.h>
+#include "lsm9ds0_replay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#define STILL_DPS	5.0f	// TRIAD references only below this rate...
+#define STILL_G		0.02f	// ...and with |a| this close to 1 g
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: lsm9ds0_sweep [--capture FILE]... [--synth N] [--seconds S] [--write PREFIX]\n"
+		"                     [--beta LIST] [--zeta LIST] [--kp LIST] [--ki LIST]\n"
+		"                     [--cal S] [--settle S] [--threads N] [--top N]\n");
+}
+
+// Reference -- The orientation to score against after an update.
+struct Reference
+{
+	uint32_t update;	// Index of the update it follows
+	float q[4];
+};
+
+struct Capture
+{
+	std::string name;
+	std::vector<Update> updates;
+	std::vector<Reference> refs;
+	bool truth;			// refs are Q lines, not TRIAD
+};
+
+// Config -- One combination of gains.
+struct Config
+{
+	bool mahony;
+	float gain[2];		// beta and zeta, or kp and ki
+};
+
+// Result -- One work item's, or summed over a config's items.
+struct Result
+{
+	double sumSq;		// Squared errors, in degrees^2
+	double worst;		// Degrees
+	uint64_t scored;
+	uint64_t updates;
+	double ns;
+};
+
+// nowNs() -- Wall time, or with CLOCK_THREAD_CPUTIME_ID, the time this
+// thread has run, which sharing a CPU with other threads doesn't inflate.
+static double nowNs(clockid_t clock = CLOCK_MONOTONIC)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+///////////////////////////////
+// Quaternions and rotations //
+///////////////////////////////
+
+// mulQ() -- out = a b.
+static void mulQ(const double * a, const double * b, double * out)
+{
+	double w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+	double x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+	double y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+	double z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+	out[0] = w;
+	out[1] = x;
+	out[2] = y;
+	out[3] = z;
+}
+
+// toSensor() -- An earth-frame vector in the sensor frame: R(q)^T v.
+static void toSensor(const double * q, const double * v, double * out)
+{
+	double w = q[0], x = q[1], y = q[2], z = q[3];
+	double R[3][3] = {
+		{1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y)},
+		{2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x)},
+		{2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)}};
+	for (int i = 0; i < 3; i++)
+		out[i] = R[0][i] * v[0] + R[1][i] * v[1] + R[2][i] * v[2];
+}
+
+// triad() -- The orientation an accel and a mag reading give on their own:
+// the rows of R(q) are north, west, and up in the sensor frame.
+// Output: false if either is zero, or they're parallel.
+static bool triad(const float * a, const float * m, float * q)
+{
+	double up[3] = {a[0], a[1], a[2]};
+	double n = sqrt(up[0] * up[0] + up[1] * up[1] + up[2] * up[2]);
+	if (n == 0)
+		return false;
+	for (int i = 0; i < 3; i++)
+		up[i] /= n;
+	double d = m[0] * up[0] + m[1] * up[1] + m[2] * up[2];
+	double north[3] = {m[0] - d * up[0], m[1] - d * up[1], m[2] - d * up[2]};
+	n = sqrt(north[0] * north[0] + north[1] * north[1] + north[2] * north[2]);
+	if (n < 1e-6)
+		return false;
+	for (int i = 0; i < 3; i++)
+		north[i] /= n;
+	double west[3] = {up[1] * north[2] - up[2] * north[1],
+					  up[2] * north[0] - up[0] * north[2],
+					  up[0] * north[1] - up[1] * north[0]};
+	const double * R[3] = {north, west, up};
+
+	// Shepperd's method: start from the largest of w, x, y, z.
+	double tr = R[0][0] + R[1][1] + R[2][2], out[4];
+	if (tr > 0)
+	{
+		double s = 2 * sqrt(1 + tr);
+		out[0] = s / 4;
+		out[1] = (R[2][1] - R[1][2]) / s;
+		out[2] = (R[0][2] - R[2][0]) / s;
+		out[3] = (R[1][0] - R[0][1]) / s;
+	}
+	else if (R[0][0] > R[1][1] && R[0][0] > R[2][2])
+	{
+		double s = 2 * sqrt(1 + R[0][0] - R[1][1] - R[2][2]);
+		out[0] = (R[2][1] - R[1][2]) / s;
+		out[1] = s / 4;
+		out[2] = (R[0][1] + R[1][0]) / s;
+		out[3] = (R[0][2] + R[2][0]) / s;
+	}
+	else if (R[1][1] > R[2][2])
+	{
+		double s = 2 * sqrt(1 + R[1][1] - R[0][0] - R[2][2]);
+		out[0] = (R[0][2] - R[2][0]) / s;
+		out[1] = (R[0][1] + R[1][0]) / s;
+		out[2] = s / 4;
+		out[3] = (R[1][2] + R[2][1]) / s;
+	}
+	else
+	{
+		double s = 2 * sqrt(1 + R[2][2] - R[0][0] - R[1][1]);
+		out[0] = (R[1][0] - R[0][1]) / s;
+		out[1] = (R[0][2] + R[2][0]) / s;
+		out[2] = (R[1][2] + R[2][1]) / s;
+		out[3] = s / 4;
+	}
+	for (int i = 0; i < 4; i++)
+		q[i] = out[i];
+	return true;
+}
+
+// angle() -- The rotation between two unit quaternions, in degrees.
+static double angle(const float * a, const float * b)
+{
+	double d = fabs((double) a[0] * b[0] + (double) a[1] * b[1] +
+					(double) a[2] * b[2] + (double) a[3] * b[3]);
+	return 2 * acos(d > 1 ? 1 : d) * 180 / PI;
+}
+
+///////////////////////
+// Building captures //
+///////////////////////
+
+// Random -- A small generator of its own, so each synthetic capture depends
+// only on its seed.
+struct Random
+{
+	uint32_t state;
+
+	Random(uint32_t seed) : state(seed * 2654435761u + 1) {}
+
+	double uniform(double lo, double hi)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return lo + (hi - lo) * (state / 4294967296.0);
+	}
+
+	// gauss() -- Roughly normal: the sum of four uniforms.
+	double gauss(double sigma)
+	{
+		double s = 0;
+		for (int i = 0; i < 4; i++)
+			s += uniform(-1, 1);
+		return s * sigma * 0.866; // Each uniform's variance is 1/3
+	}
+};
+
+// synthesize() -- A made-up capture with its true orientation, as described
+// at the top. Everything is sampled on the gyro's 760 Hz grid.
+static void synthesize(uint32_t seed, double seconds, std::vector<Sample> & out)
+{
+	Random rng(seed);
+	const double gOdr = 760, aEvery = 760 / 200.0, mEvery = 760 / 100.0;
+	const double qEvery = 760 / 100.0, still = 3;
+	double amp[3][2], freq[3][2], phase[3][2], bias[3], lin[3], linF[3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int k = 0; k < 2; k++)
+		{
+			amp[i][k] = rng.uniform(5, 50);
+			freq[i][k] = rng.uniform(0.05, 0.6);
+			phase[i][k] = rng.uniform(0, 2 * PI);
+		}
+		bias[i] = rng.uniform(-1, 1);
+		lin[i] = rng.uniform(0.02, 0.15);
+		linF[i] = rng.uniform(0.5, 2.5);
+	}
+
+	// Start at a random heading and a small tilt: yaw about z, then pitch
+	// about y, then roll about x.
+	double yaw = rng.uniform(-PI, PI), pitch = rng.uniform(-0.3, 0.3);
+	double roll = rng.uniform(-0.3, 0.3);
+	double qz[4] = {cos(yaw / 2), 0, 0, sin(yaw / 2)};
+	double qy[4] = {cos(pitch / 2), 0, sin(pitch / 2), 0};
+	double qx[4] = {cos(roll / 2), sin(roll / 2), 0, 0};
+	double q[4], tmp[4];
+	mulQ(qz, qy, tmp);
+	mulQ(tmp, qx, q);
+
+	const double up[3] = {0, 0, 1}, field[3] = {0.25, 0, -0.4};
+	unsigned long steps = (unsigned long) (seconds * gOdr);
+	double nextA = 0, nextM = 0, nextQ = 0;
+	for (unsigned long k = 0; k <= steps; k++)
+	{
+		double t = k / gOdr;
+		// Rate (DPS) at t, eased in after the still start.
+		double env = (t < still) ? 0 : (t < still + 1) ? t - still : 1;
+		double w[3];
+		for (int i = 0; i < 3; i++)
+			w[i] = env * (amp[i][0] * sin(2 * PI * freq[i][0] * t + phase[i][0]) +
+						  amp[i][1] * sin(2 * PI * freq[i][1] * t + phase[i][1]));
+
+		Sample s;
+		s.t = t;
+		if (k >= nextQ)
+		{
+			nextQ += qEvery;
+			s.sensor = 'Q';
+			for (int i = 0; i < 4; i++)
+				s.v[i] = q[i];
+			out.push_back(s);
+		}
+		if (k >= nextA)
+		{
+			nextA += aEvery;
+			double a[3];
+			toSensor(q, up, a);
+			s.sensor = 'A';
+			for (int i = 0; i < 3; i++)
+				s.v[i] = a[i] + env * lin[i] * sin(2 * PI * linF[i] * t) +
+						 rng.gauss(0.002);
+			out.push_back(s);
+		}
+		if (k >= nextM)
+		{
+			nextM += mEvery;
+			double m[3];
+			toSensor(q, field, m);
+			s.sensor = 'M';
+			for (int i = 0; i < 3; i++)
+				s.v[i] = m[i] + rng.gauss(0.002);
+			out.push_back(s);
+		}
+		s.sensor = 'G';
+		for (int i = 0; i < 3; i++)
+			s.v[i] = w[i] + bias[i] + rng.gauss(0.1);
+		out.push_back(s);
+
+		// On to the next gyro sample: turn by the rate at the midpoint.
+		double tm = t + 0.5 / gOdr, r[3], n = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			r[i] = env * (amp[i][0] * sin(2 * PI * freq[i][0] * tm + phase[i][0]) +
+						  amp[i][1] * sin(2 * PI * freq[i][1] * tm + phase[i][1]));
+			r[i] *= PI / 180 / gOdr;
+			n += r[i] * r[i];
+		}
+		n = sqrt(n);
+		double dq[4] = {cos(n / 2), 0, 0, 0};
+		if (n > 0)
+			for (int i = 0; i < 3; i++)
+				dq[i + 1] = sin(n / 2) * r[i] / n;
+		mulQ(q, dq, tmp);
+		n = sqrt(tmp[0] * tmp[0] + tmp[1] * tmp[1] + tmp[2] * tmp[2] + tmp[3] * tmp[3]);
+		for (int i = 0; i < 4; i++)
+			q[i] = tmp[i] / n;
+	}
+}
+
+static bool save(const char * path, const std::vector<Sample> & samples)
+{
+	FILE * out = fopen(path, "w");
+	if (!out)
+		return false;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const Sample & s = samples[i];
+		fprintf(out, "%.6f %c %.6f %.6f %.6f", s.t, s.sensor, s.v[0], s.v[1], s.v[2]);
+		if (s.sensor == 'Q')
+			fprintf(out, " %.6f", s.v[3]);
+		fputc('\n', out);
+	}
+	return fclose(out) == 0;
+}
+
+// toCapture() -- A recording's updates (see toUpdates()), with the references
+// that follow each.
+static void toCapture(std::vector<Sample> & samples, double calSeconds,
+					  double settle, Capture & out)
+{
+	std::stable_sort(samples.begin(), samples.end());
+	out.truth = false;
+	for (size_t i = 0; i < samples.size() && !out.truth; i++)
+		out.truth = samples[i].sensor == 'Q';
+	if (samples.empty())
+		return;
+	double start = samples[0].t;
+
+	// Gyro bias: the mean over the first calSeconds.
+	double bias[3] = {0, 0, 0};
+	unsigned long n = 0;
+	for (size_t i = 0; i < samples.size() && samples[i].t - start < calSeconds; i++)
+		if (samples[i].sensor == 'G')
+		{
+			for (int axis = 0; axis < 3; axis++)
+				bias[axis] += samples[i].v[axis];
+			n++;
+		}
+	for (int axis = 0; axis < 3 && n; axis++)
+		bias[axis] /= n;
+
+	std::vector<size_t> source;
+	toUpdates(samples, out.updates, bias, &source);
+
+	// A Q line is scored after the next update. Without truth, so is a new
+	// accel sample while the board is still.
+	float ref[4];
+	bool newA = false, pending = false;
+	size_t i = 0;
+	for (size_t k = 0; k < out.updates.size(); k++)
+	{
+		for (; i <= source[k]; i++)
+		{
+			const Sample & s = samples[i];
+			if (s.sensor == 'A')
+				newA = true;
+			else if (s.sensor == 'Q' && s.t - start >= settle)
+			{
+				memcpy(ref, s.v, sizeof(ref));
+				pending = true;
+			}
+		}
+		const Update & u = out.updates[k];
+		if (!out.truth && newA && samples[source[k]].t - start >= settle)
+		{
+			float rate = sqrt(u.g[0] * u.g[0] + u.g[1] * u.g[1] + u.g[2] * u.g[2]) * 180 / PI;
+			float norm = sqrt(u.a[0] * u.a[0] + u.a[1] * u.a[1] + u.a[2] * u.a[2]);
+			pending = rate < STILL_DPS && fabs(norm - 1) < STILL_G &&
+					  triad(u.a, u.m, ref);
+		}
+		newA = false;
+		if (pending)
+		{
+			Reference r;
+			r.update = k;
+			memcpy(r.q, ref, sizeof(ref));
+			out.refs.push_back(r);
+			pending = false;
+		}
+	}
+}
+
+//////////////////
+// Running them //
+//////////////////
+
+// parseList() -- Values and lo:hi:step ranges, comma-separated.
+static bool parseList(const char * text, std::vector<float> & out)
+{
+	out.clear();
+	const char * p = text;
+	while (*p)
+	{
+		char * end;
+		double lo = strtod(p, &end);
+		if (end == p)
+			return false;
+		double hi = lo, step = 1;
+		if (*end == ':')
+		{
+			p = end + 1;
+			hi = strtod(p, &end);
+			if (end == p || *end != ':')
+				return false;
+			p = end + 1;
+			step = strtod(p, &end);
+			if (end == p || step <= 0)
+				return false;
+		}
+		// Count the steps, so rounding doesn't drop or add the last one.
+		long count = (long) floor((hi - lo) / step + 1e-6);
+		for (long k = 0; k <= count; k++)
+			out.push_back(lo + k * step);
+		p = end;
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return false;
+	}
+	return true;
+}
+
+// replay() -- Run a fresh filter over a capture, scoring it at each
+// reference.
+template <class F>
+static void replay(F & filter, const Capture & c, Result & out)
+{
+	// Accumulate on the stack: neighbouring items' results share cache
+	// lines, and other threads are writing those.
+	Result r;
+	memset(&r, 0, sizeof(r));
+	const Reference * ref = c.refs.empty() ? NULL : &c.refs[0];
+	const Reference * refEnd = ref + c.refs.size();
+	double start = nowNs(CLOCK_THREAD_CPUTIME_ID);
+	for (size_t i = 0; i < c.updates.size(); i++)
+	{
+		const Update & u = c.updates[i];
+		filter.update(u.a[0], u.a[1], u.a[2], u.g[0], u.g[1], u.g[2],
+					  u.m[0], u.m[1], u.m[2], u.dt);
+		for (; ref != refEnd && ref->update == i; ref++)
+		{
+			double e = angle(filter.q, ref->q);
+			r.sumSq += e * e;
+			if (e > r.worst)
+				r.worst = e;
+			r.scored++;
+		}
+	}
+	r.ns = nowNs(CLOCK_THREAD_CPUTIME_ID) - start;
+	r.updates = c.updates.size();
+	out = r;
+}
+
+// Sweep -- Everything the worker threads share.
+struct Sweep
+{
+	std::vector<Capture> captures;
+	std::vector<Config> configs;
+	std::vector<Result> results;	// Per item: config-major
+	std::atomic<size_t> next;
+};
+
+static void worker(Sweep * sweep, int cpu)
+{
+	if (cpu >= 0)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	}
+	size_t items = sweep->results.size(), captures = sweep->captures.size();
+	for (;;)
+	{
+		size_t i = sweep->next.fetch_add(1, std::memory_order_relaxed);
+		if (i >= items)
+			break;
+		const Config & cfg = sweep->configs[i / captures];
+		const Capture & c = sweep->captures[i % captures];
+		if (cfg.mahony)
+		{
+			LSM9DS0Mahony f(cfg.gain[0], cfg.gain[1]);
+			replay(f, c, sweep->results[i]);
+		}
+		else
+		{
+			LSM9DS0Madgwick f(cfg.gain[0], cfg.gain[1]);
+			replay(f, c, sweep->results[i]);
+		}
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	std::vector<const char *> files;
+	unsigned long synth = 8;
+	double seconds = 60, calSeconds = 0, settle = 5;
+	const char * prefix = NULL;
+	int threads = 0;
+	unsigned long top = 0;
+	std::vector<float> beta, zeta, kp, ki;
+	parseList("0.041,0.1,0.2,0.4,0.6046", beta);
+	parseList("0,0.005,0.015", zeta);
+	parseList("0.5,1,2,5,10", kp);
+	parseList("0,0.05,0.2", ki);
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		bool ok = true;
+		if (!strcmp(arg, "--capture"))
+			files.push_back(val);
+		else if (!strcmp(arg, "--synth"))
+			synth = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--seconds"))
+			seconds = atof(val);
+		else if (!strcmp(arg, "--write"))
+			prefix = val;
+		else if (!strcmp(arg, "--beta"))
+			ok = parseList(val, beta);
+		else if (!strcmp(arg, "--zeta"))
+			ok = parseList(val, zeta);
+		else if (!strcmp(arg, "--kp"))
+			ok = parseList(val, kp);
+		else if (!strcmp(arg, "--ki"))
+			ok = parseList(val, ki);
+		else if (!strcmp(arg, "--cal"))
+			calSeconds = atof(val);
+		else if (!strcmp(arg, "--settle"))
+			settle = atof(val);
+		else if (!strcmp(arg, "--threads"))
+			threads = atoi(val);
+		else if (!strcmp(arg, "--top"))
+			top = strtoul(val, NULL, 0);
+		else
+			ok = false;
+		if (!ok)
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	// The CPUs this process may use, one thread on each.
+	cpu_set_t allowed;
+	std::vector<int> cpus;
+	if (!sched_getaffinity(0, sizeof(allowed), &allowed))
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			if (CPU_ISSET(cpu, &allowed))
+				cpus.push_back(cpu);
+	if (threads < 1)
+		threads = cpus.empty() ? 1 : cpus.size();
+
+	Sweep sweep;
+	if (files.empty())
+		for (unsigned long n = 0; n < synth; n++)
+		{
+			std::vector<Sample> samples;
+			synthesize(n + 1, seconds, samples);
+			char name[32];
+			snprintf(name, sizeof(name), "synth%lu", n);
+			if (prefix)
+			{
+				std::string path = std::string(prefix) + (name + 5) + ".txt";
+				if (!save(path.c_str(), samples))
+				{
+					perror(path.c_str());
+					return 1;
+				}
+			}
+			sweep.captures.push_back(Capture());
+			sweep.captures.back().name = name;
+			toCapture(samples, calSeconds, settle, sweep.captures.back());
+		}
+	for (size_t n = 0; n < files.size(); n++)
+	{
+		std::vector<Sample> samples;
+		if (!load(files[n], samples))
+		{
+			perror(files[n]);
+			return 1;
+		}
+		sweep.captures.push_back(Capture());
+		sweep.captures.back().name = files[n];
+		toCapture(samples, calSeconds, settle, sweep.captures.back());
+	}
+
+	uint64_t updates = 0, refs = 0;
+	for (size_t n = 0; n < sweep.captures.size(); n++)
+	{
+		const Capture & c = sweep.captures[n];
+		if (c.updates.empty())
+		{
+			fprintf(stderr, "lsm9ds0_sweep: %s: no gyro samples with an accel and mag\n",
+					c.name.c_str());
+			return 1;
+		}
+		if (c.refs.empty())
+			fprintf(stderr, "lsm9ds0_sweep: %s: nothing to score against after %.1f s\n",
+					c.name.c_str(), settle);
+		updates += c.updates.size();
+		refs += c.refs.size();
+	}
+	if (sweep.captures.empty())
+	{
+		usage();
+		return 2;
+	}
+
+	for (size_t b = 0; b < beta.size(); b++)
+		for (size_t z = 0; z < zeta.size(); z++)
+			sweep.configs.push_back(Config{false, {beta[b], zeta[z]}});
+	for (size_t p = 0; p < kp.size(); p++)
+		for (size_t k = 0; k < ki.size(); k++)
+			sweep.configs.push_back(Config{true, {kp[p], ki[k]}});
+	if (sweep.configs.empty())
+	{
+		fprintf(stderr, "lsm9ds0_sweep: no gains to try\n");
+		return 2;
+	}
+	sweep.results.resize(sweep.configs.size() * sweep.captures.size());
+	sweep.next = 0;
+
+	printf("%lu captures, %llu updates, %llu references; %lu combinations on %d threads\n",
+		   (unsigned long) sweep.captures.size(), (unsigned long long) updates,
+		   (unsigned long long) refs, (unsigned long) sweep.configs.size(), threads);
+	double start = nowNs();
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++)
+		pool.push_back(std::thread(worker, &sweep,
+								   cpus.empty() ? -1 : cpus[t % cpus.size()]));
+	for (size_t t = 0; t < pool.size(); t++)
+		pool[t].join();
+	double wallNs = nowNs() - start;
+
+	// Sum each combination's items, then rank by RMS error.
+	size_t captures = sweep.captures.size();
+	std::vector<Result> totals(sweep.configs.size());
+	std::vector<size_t> order(sweep.configs.size());
+	double busyNs = 0;
+	for (size_t c = 0; c < sweep.configs.size(); c++)
+	{
+		Result & t = totals[c];
+		memset(&t, 0, sizeof(t));
+		for (size_t n = 0; n < captures; n++)
+		{
+			const Result & r = sweep.results[c * captures + n];
+			t.sumSq += r.sumSq;
+			t.worst = std::max(t.worst, r.worst);
+			t.scored += r.scored;
+			t.updates += r.updates;
+			t.ns += r.ns;
+		}
+		busyNs += t.ns;
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return totals[a].sumSq * totals[b].scored < totals[b].sumSq * totals[a].scored;
+	});
+
+	printf("%-9s %8s %8s %10s %10s %10s %12s\n", "filter", "gain", "gain2",
+		   "rms err", "max err", "ns/update", "updates/s");
+	for (size_t i = 0; i < order.size() && (!top || i < top); i++)
+	{
+		const Config & cfg = sweep.configs[order[i]];
+		const Result & t = totals[order[i]];
+		double ns = t.ns / t.updates;
+		printf("%-9s %8.4f %8.4f %10.3f %10.3f %10.1f %12.0f\n",
+			   cfg.mahony ? "mahony" : "madgwick", cfg.gain[0], cfg.gain[1],
+			   t.scored ? sqrt(t.sumSq / t.scored) : 0.0, t.worst, ns, 1e9 / ns);
+	}
+
+	uint64_t total = updates * sweep.configs.size();
+	printf("%.2f s wall, %.0f updates/s over %d threads: %.1fx one thread's rate "
+		   "(%.0f%% of %d)\n", wallNs / 1e9, total / (wallNs / 1e9), threads,
+		   busyNs / wallNs, 100 * busyNs / wallNs / threads, threads);
+	return 0;
+}
@@ -0,0 +1,225 @@
+/******************************************************************************
+lsm9ds0d.cpp
+LSM9DS0 daemon: owns the device and publishes its samples to shared memory
+https://github.com/sparkfun/LSM9DS0_Breakout
+
+lsm9ds0d configures the LSM9DS0, runs the gyro and accel FIFOs in stream
+mode, and drains them in bursts, so the bus sees a handful of transactions
+per batch instead of several per sample. Each drain is read straight into
+an LSM9DS0_frame in a shared-memory frame ring (/lsm9ds0.frames), where
+consumers use it in place. The same samples are also published one by one,
+time-stamped, to a sample ring (/lsm9ds0), for consumers that would rather
+copy. Neither needs a system call per sample (see SFE_LSM9DS0_Shm.h).
+
+Usage:
+	lsm9ds0d [--i2c /dev/i2c-1 | --sim] [--gaddr 0x6B] [--xmaddr 0x1D]
+			 [--shm /lsm9ds0] [--slots 4096] [--frames 64] [--profile file]
+
+The frame ring is named after the sample ring, plus ".frames".
+
+With --profile, the device is set up from a saved profile if there is a
+valid one. Otherwise it's calibrated (keep it still and flat) and the
+result saved there for next time.
+
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include <SFE_LSM9DS0.h>
+#include <SFE_LSM9DS0_Storage.h>
+#include "SFE_LSM9DS0_I2CDev.h"
+#include "SFE_LSM9DS0_Shm.h"
+#include "SFE_LSM9DS0_Sim.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+
+// Output data rates. The FIFOs are drained every DRAIN_SAMPLES samples of
+// the faster sensor (accel), comfortably inside their 32 levels. That is
+// also the mag's period, so checking it once per drain keeps up.
+#define GYRO_ODR		LSM9DS0::G_ODR_190_BW_50
+#define ACCEL_ODR		LSM9DS0::A_ODR_200
+#define ACCEL_HZ		200
+#define MAG_ODR			LSM9DS0::M_ODR_50
+#define DRAIN_SAMPLES	4
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+	running = 0;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: lsm9ds0d [--i2c DEV | --sim] [--gaddr ADDR] [--xmaddr ADDR]\n"
+		"                [--shm NAME] [--slots N] [--frames N] [--profile FILE]\n");
+}
+
+// stamp() -- Convert one sensor's samples in a frame to ring samples.
+// The last one was read at the frame's timestamp, less the samples left in
+// the FIFO after it (later); the others are back-dated one period apiece.
+static uint32_t stamp(LSM9DS0ShmSample * out, const LSM9DS0_frame & frame,
+					  const int16_t * x, const int16_t * y, const int16_t * z,
+					  uint8_t n, uint8_t later, float odr, uint8_t sensor)
+{
+	uint64_t t = frame.header.timestamp * 1000;
+	uint64_t periodNs = (odr > 0) ? 1e9 / odr : 0;
+	for (uint8_t i = 0; i < n; i++)
+	{
+		out[i].timestamp = t - (uint64_t) (n - 1 - i + later) * periodNs;
+		out[i].data[0] = x[i];
+		out[i].data[1] = y[i];
+		out[i].data[2] = z[i];
+		out[i].sensor = sensor;
+		out[i].reserved = 0;
+	}
+	return n;
+}
+
+int main(int argc, char ** argv)
+{
+	const char * device = "/dev/i2c-1";
+	const char * shmName = LSM9DS0_SHM_NAME;
+	const char * profilePath = NULL;
+	bool sim = false;
+	uint8_t gAddr = 0x6B, xmAddr = 0x1D;
+	uint32_t slots = 4096;
+	uint32_t frameCount = 64;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char * arg = argv[i];
+		const char * val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!strcmp(arg, "--sim"))
+		{
+			sim = true;
+			continue;
+		}
+		if (!val)
+		{
+			usage();
+			return 2;
+		}
+		i++;
+		if (!strcmp(arg, "--i2c"))
+			device = val;
+		else if (!strcmp(arg, "--gaddr"))
+			gAddr = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--xmaddr"))
+			xmAddr = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--shm"))
+			shmName = val;
+		else if (!strcmp(arg, "--slots"))
+			slots = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--frames"))
+			frameCount = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--profile"))
+			profilePath = val;
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	LSM9DS0Sim simBus(gAddr, xmAddr);
+	LSM9DS0I2CDev i2cBus;
+	if (sim)
+		setHostBus(&simBus);
+	else
+	{
+		if (!i2cBus.open(device))
+		{
+			perror(device);
+			return 1;
+		}
+		setHostBus(&i2cBus);
+	}
+
+	LSM9DS0 dof(MODE_I2C, gAddr, xmAddr);
+	LSM9DS0_profile profile;
+	uint16_t whoAmI = 0;
+	if (profilePath && loadLSM9DS0Profile(profile, profilePath))
+		whoAmI = dof.begin(profile);
+	if (!whoAmI)
+	{
+		whoAmI = dof.begin(LSM9DS0::G_SCALE_245DPS, LSM9DS0::A_SCALE_2G,
+						   LSM9DS0::M_SCALE_2GS, GYRO_ODR, ACCEL_ODR, MAG_ODR);
+		if (whoAmI == LSM9DS0_WHO_AM_I && profilePath)
+		{
+			fprintf(stderr, "lsm9ds0d: calibrating, keep the sensor still\n");
+			dof.calLSM9DS0(dof.gbias, dof.abias);
+			dof.getProfile(profile);
+			if (!saveLSM9DS0Profile(profile, profilePath))
+				perror(profilePath);
+		}
+	}
+	if (whoAmI != LSM9DS0_WHO_AM_I)
+	{
+		fprintf(stderr, "lsm9ds0d: no LSM9DS0 found (WHO_AM_I 0x%04X)\n", whoAmI);
+		return 1;
+	}
+	// A profile may have been taken at other rates; these are what the
+	// timestamps assume.
+	dof.setGyroODR(GYRO_ODR);
+	dof.setAccelODR(ACCEL_ODR);
+	dof.setMagODR(MAG_ODR);
+	dof.setGyroFIFO(LSM9DS0::FIFO_STREAM);
+	dof.setAccelFIFO(LSM9DS0::FIFO_STREAM);
+
+	LSM9DS0ShmWriter ring;
+	if (!ring.create(shmName, slots))
+	{
+		perror(shmName);
+		return 1;
+	}
+	ring.setScales(dof.calcGyro(1), dof.calcAccel(1), dof.calcMag(1));
+
+	char framesName[256];
+	snprintf(framesName, sizeof(framesName), "%s.frames", shmName);
+	LSM9DS0ShmFrameWriter frames;
+	static LSM9DS0_frame init;
+	dof.initFrame(init);
+	if (!frames.create(framesName, frameCount, init))
+	{
+		perror(framesName);
+		return 1;
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = onSignal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	static LSM9DS0ShmSample batch[2 * LSM9DS0_FRAME_SAMPLES + LSM9DS0_FRAME_MAG_SAMPLES];
+	while (running)
+	{
+		LSM9DS0_frame * f = frames.next();
+		dof.readFrame(*f);
+		frames.publish();
+
+		// The frame is ours until the ring wraps, so the sample ring can be
+		// fed from it without another read.
+		const LSM9DS0_frame_header & h = f->header;
+		uint32_t n = 0;
+		n += stamp(batch + n, *f, f->g[0], f->g[1], f->g[2], h.gCount,
+				   h.gLater, h.gOdr, LSM9DS0_SENSOR_GYRO);
+		n += stamp(batch + n, *f, f->a[0], f->a[1], f->a[2], h.aCount,
+				   h.aLater, h.aOdr, LSM9DS0_SENSOR_ACCEL);
+		n += stamp(batch + n, *f, f->m[0], f->m[1], f->m[2], h.mCount, 0,
+				   h.mOdr, LSM9DS0_SENSOR_MAG);
+		ring.publish(batch, n);
+
+		struct timespec ts = {0, (long) (DRAIN_SAMPLES * 1000000000L / ACCEL_HZ)};
+		nanosleep(&ts, NULL); // A signal cuts it short, which is what we want
+	}
+
+	dof.setGyroFIFO(LSM9DS0::FIFO_BYPASS);
+	dof.setAccelFIFO(LSM9DS0::FIFO_BYPASS);
+	frames.close();
+	ring.close();
+	return 0;
+}